@@ -0,0 +1,678 @@
+#include "systems/memory/memory_system.hpp"
+#include "systems/memory/memory_allocators/c_allocator.hpp"
+#include "systems/memory/memory_allocators/free_list_allocator.hpp"
+#include "systems/memory/memory_allocators/gpu_free_list_allocator.hpp"
+#include "systems/memory/memory_allocators/linear_allocator.hpp"
+#include "systems/memory/memory_allocators/pool_allocator.hpp"
+#include "systems/memory/memory_allocators/stack_allocator.hpp"
+#include "systems/memory/memory_allocators/thread_cached_allocator.hpp"
+#include "benchmark_support.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+/**
+ * Allocator microbenchmark. Replays deterministic allocation traces modeled
+ * after engine workloads against each allocator directly, without the memory
+ * system in between. Reports throughput, per operation latency percentiles,
+ * peak usage and fragmentation as JSON on standard output.
+ *
+ * Thread cached allocators are also stress tested under random alloc/free
+ * churn from many threads (threaded_churn), for thread counts doubling up to
+ * the given maximum. Blocks are filled with a pattern that is checked on free,
+ * part of them is freed by a different thread than the one that allocated
+ * them, and usage has to return to zero once all threads exit.
+ *
+ * Usage: AllocatorBenchmark [--repetitions=N] [--seed=N] [--trace=NAME]
+ *                           [--threads=N]
+ */
+
+using namespace ENGINE_NAMESPACE;
+
+namespace {
+
+// ////// //
+// TRACES //
+// ////// //
+
+struct Operation {
+    enum Type : uint8 { Allocate, Free, Reset, Checkpoint };
+
+    Type   type;
+    uint32 slot;
+    uint64 size;
+    uint64 alignment;
+};
+
+struct Trace {
+    std::string            name;
+    std::vector<Operation> operations;
+    uint32                 slot_count = 0;
+    uint64                 max_size   = 0;
+    // Frees always release the most recent live allocation
+    bool                   lifo       = false;
+    // Live memory is dropped in bulk at Reset operations
+    bool                   resets     = false;
+};
+
+class TraceBuilder {
+  public:
+    TraceBuilder(Trace& trace) : _trace(trace) {}
+
+    uint32 allocate(const uint64 size, const uint64 alignment) {
+        uint32 slot;
+        if (_free_slots.empty()) slot = _trace.slot_count++;
+        else {
+            slot = _free_slots.back();
+            _free_slots.pop_back();
+        }
+        _trace.operations.push_back(
+            { Operation::Allocate, slot, size, alignment }
+        );
+        _trace.max_size = std::max(_trace.max_size, size);
+        return slot;
+    }
+    void free(const uint32 slot) {
+        _trace.operations.push_back({ Operation::Free, slot, 0, 0 });
+        _free_slots.push_back(slot);
+    }
+    void reset() { _trace.operations.push_back({ Operation::Reset, 0, 0, 0 }); }
+    void checkpoint() {
+        _trace.operations.push_back({ Operation::Checkpoint, 0, 0, 0 });
+    }
+
+  private:
+    Trace&              _trace;
+    std::vector<uint32> _free_slots;
+};
+
+// Dynamic arrays growing geometrically, reallocating on each growth, and
+// occasionally being destroyed. Frees happen in random order.
+Trace container_churn_trace(const uint64 seed) {
+    constexpr uint32 container_count = 512;
+    constexpr uint32 step_count      = 200000;
+    constexpr uint64 initial_size    = 64;
+    constexpr uint64 max_size        = 64 * 1024;
+
+    Trace trace { "container_churn" };
+    TraceBuilder builder { trace };
+    std::mt19937_64 rng { seed };
+
+    struct Container {
+        uint32 slot;
+        uint64 capacity = 0;
+    };
+    std::vector<Container> containers(container_count);
+    for (uint32 step = 0; step < step_count; step++) {
+        auto& container = containers[rng() % container_count];
+
+        if (container.capacity == 0) {
+            container.capacity = initial_size;
+            container.slot     = builder.allocate(container.capacity, 8);
+        } else if (rng() % 8 != 0 && container.capacity < max_size) {
+            // Grow: new storage is allocated before the old one is released
+            container.capacity *= 2;
+            const uint32 old_slot = container.slot;
+            container.slot        = builder.allocate(container.capacity, 8);
+            builder.free(old_slot);
+        } else {
+            builder.free(container.slot);
+            container.capacity = 0;
+        }
+
+        if (step % 4096 == 4095) builder.checkpoint();
+    }
+    for (const auto& container : containers)
+        if (container.capacity != 0) builder.free(container.slot);
+
+    return trace;
+}
+
+// Bursts of mesh loads (vertex & index buffers with some metadata), each
+// followed by unloading a random half of the loaded meshes.
+Trace mesh_load_trace(const uint64 seed) {
+    constexpr uint32 burst_count = 64;
+
+    Trace trace { "mesh_load" };
+    TraceBuilder builder { trace };
+    std::mt19937_64 rng { seed };
+
+    std::vector<std::vector<uint32>> meshes;
+    for (uint32 burst = 0; burst < burst_count; burst++) {
+        const uint32 load_count = 16 + rng() % 33;
+        for (uint32 i = 0; i < load_count; i++) {
+            std::vector<uint32> mesh;
+            const uint64 vertex_size = 16 * 1024 + rng() % (1024 * 1024);
+            mesh.push_back(builder.allocate(vertex_size, 16));
+            mesh.push_back(builder.allocate(vertex_size / 4, 16));
+            mesh.push_back(builder.allocate(32 + rng() % 97, 8));
+            const uint32 submesh_count = 1 + rng() % 4;
+            for (uint32 j = 0; j < submesh_count; j++)
+                mesh.push_back(builder.allocate(64, 8));
+            meshes.push_back(std::move(mesh));
+        }
+        builder.checkpoint();
+
+        std::shuffle(meshes.begin(), meshes.end(), rng);
+        const uint64 unload_count = meshes.size() / 2;
+        for (uint64 i = 0; i < unload_count; i++) {
+            for (const auto slot : meshes.back())
+                builder.free(slot);
+            meshes.pop_back();
+        }
+        builder.checkpoint();
+    }
+    for (const auto& mesh : meshes)
+        for (const auto slot : mesh)
+            builder.free(slot);
+
+    return trace;
+}
+
+// Small temporary per frame allocations, released in reverse order (or all at
+// once) at the end of each frame.
+Trace frame_temp_trace(const uint64 seed) {
+    constexpr uint32 frame_count = 600;
+
+    Trace trace { "frame_temp" };
+    TraceBuilder builder { trace };
+    std::mt19937_64 rng { seed };
+
+    trace.lifo   = true;
+    trace.resets = true;
+
+    std::vector<uint32> live;
+    for (uint32 frame = 0; frame < frame_count; frame++) {
+        const uint32 allocation_count = 200 + rng() % 401;
+        for (uint32 i = 0; i < allocation_count; i++)
+            live.push_back(builder.allocate(16 + rng() % 241, 16));
+        builder.checkpoint();
+
+        while (!live.empty()) {
+            builder.free(live.back());
+            live.pop_back();
+        }
+        builder.reset();
+    }
+
+    return trace;
+}
+
+// ////////// //
+// ALLOCATORS //
+// ////////// //
+
+struct Subject {
+    std::string                                  name;
+    std::function<std::unique_ptr<Allocator>()> create;
+    // Allocator releases memory only through reset()
+    bool                                         reset_only = false;
+    // Frees must happen in reverse order of allocations
+    bool                                         lifo_only  = false;
+    uint64                                       max_size   = uint64_max;
+
+    bool supports(const Trace& trace) const {
+        if (trace.max_size > max_size) return false;
+        if (reset_only) return trace.resets;
+        return !lifo_only || trace.lifo;
+    }
+};
+
+constexpr uint64 general_size = 512 * 1024 * 1024;
+constexpr uint64 frame_size   = 16 * 1024 * 1024;
+constexpr uint64 chunk_size   = 256;
+
+std::vector<Subject> create_subjects() {
+    typedef FreeListAllocator    FLA;
+    typedef GPUFreeListAllocator GPUFLA;
+    return {
+        { "linear",
+          [] { return std::make_unique<LinearAllocator>(frame_size); },
+          true },
+        { "stack",
+          [] { return std::make_unique<StackAllocator>(frame_size); },
+          false,
+          true },
+        { "pool",
+          [] {
+              return std::make_unique<PoolAllocator>(frame_size, chunk_size);
+          },
+          false,
+          false,
+          chunk_size },
+        { "free_list_find_first",
+          [] { return std::make_unique<FLA>(general_size, FLA::FindFirst); } },
+        { "free_list_find_best",
+          [] { return std::make_unique<FLA>(general_size, FLA::FindBest); } },
+        { "free_list_segregated_fit",
+          [] {
+              return std::make_unique<FLA>(general_size, FLA::SegregatedFit);
+          } },
+        { "gpu_free_list",
+          [] { return std::make_unique<GPUFLA>(general_size, 0); } },
+        { "c_allocator", [] { return std::make_unique<CAllocator>(); } },
+    };
+}
+
+// /////////// //
+// MEASUREMENT //
+// /////////// //
+
+struct Statistics {
+    uint64 peak_used      = 0;
+    uint64 peak_requested = 0;
+    // Largest observed share of free memory unusable for a single allocation
+    double fragmentation  = 0.0;
+    bool   fragmentation_known = false;
+};
+
+struct Latencies {
+    std::vector<double> allocate;
+    std::vector<double> free;
+};
+
+template<bool Checkpoints, typename Timer>
+void replay(
+    const Subject&      subject,
+    Allocator&          allocator,
+    const Trace&        trace,
+    std::vector<void*>& slots,
+    Statistics&         statistics,
+    Timer&&             timer
+) {
+    std::vector<uint64> sizes;
+    uint64              requested = 0;
+    if (Checkpoints) sizes.resize(trace.slot_count);
+
+    for (const auto& operation : trace.operations) {
+        switch (operation.type) {
+        case Operation::Allocate:
+            timer(operation.type, [&] {
+                slots[operation.slot] =
+                    allocator.allocate(operation.size, operation.alignment);
+            });
+            if (Checkpoints) {
+                sizes[operation.slot] = operation.size;
+                requested += operation.size;
+                statistics.peak_requested =
+                    std::max(statistics.peak_requested, requested);
+            }
+            break;
+        case Operation::Free:
+            if (subject.reset_only) break;
+            timer(operation.type, [&] {
+                allocator.free(slots[operation.slot]);
+            });
+            if (Checkpoints) requested -= sizes[operation.slot];
+            break;
+        case Operation::Reset:
+            if (!subject.reset_only) break;
+            timer(operation.type, [&] { allocator.reset(); });
+            if (Checkpoints) requested = 0;
+            break;
+        case Operation::Checkpoint:
+            if (!Checkpoints) break;
+            // Peak is also sampled here since reset() clears it
+            statistics.peak_used =
+                std::max(statistics.peak_used, allocator.used());
+            const uint64 largest = allocator.largest_free_block();
+            const uint64 free    = allocator.total_size() - allocator.used();
+            if (largest == 0 || free == 0) break;
+            statistics.fragmentation_known = true;
+            statistics.fragmentation       = std::max(
+                statistics.fragmentation, 1.0 - (double) largest / free
+            );
+            break;
+        }
+    }
+    statistics.peak_used = std::max(statistics.peak_used, allocator.peak());
+}
+
+std::unique_ptr<Allocator> create_allocator(const Subject& subject) {
+    auto allocator = subject.create();
+    allocator->init();
+    return allocator;
+}
+
+// Cost of reading the clock twice, subtracted from every timed operation
+double timer_overhead() {
+    std::vector<double> samples(100000);
+    for (auto& sample : samples) {
+        const auto start = Clock::now();
+        const auto end   = Clock::now();
+        sample           = std::chrono::duration<double, std::nano>(end - start)
+                     .count();
+    }
+    return median(samples);
+}
+
+nlohmann::json benchmark(
+    const Subject& subject,
+    const Trace&   trace,
+    const uint32   repetitions,
+    const double   overhead
+) {
+    std::vector<void*> slots(trace.slot_count);
+    Statistics         statistics {};
+    const auto         no_timer = [](Operation::Type, auto&& operation) {
+        operation();
+    };
+
+    // Usage & fragmentation
+    {
+        auto allocator = create_allocator(subject);
+        replay<true>(subject, *allocator, trace, slots, statistics, no_timer);
+    }
+
+    // Throughput, median over repetitions
+    uint64 operation_count = 0;
+    for (const auto& operation : trace.operations)
+        if (operation.type == Operation::Allocate ||
+            (operation.type == Operation::Free && !subject.reset_only) ||
+            (operation.type == Operation::Reset && subject.reset_only))
+            operation_count++;
+
+    std::vector<double> durations;
+    for (uint32 i = 0; i < repetitions; i++) {
+        auto       allocator = create_allocator(subject);
+        const auto start     = Clock::now();
+        replay<false>(subject, *allocator, trace, slots, statistics, no_timer);
+        durations.push_back(elapsed_ns(start));
+    }
+    const double ns_per_op = median(durations) / operation_count;
+
+    // Latency distribution, each operation timed separately
+    Latencies latencies;
+    {
+        auto allocator = create_allocator(subject);
+        replay<false>(
+            subject,
+            *allocator,
+            trace,
+            slots,
+            statistics,
+            [&](Operation::Type type, auto&& operation) {
+                const auto start = Clock::now();
+                operation();
+                const auto   end = Clock::now();
+                const double ns =
+                    std::chrono::duration<double, std::nano>(end - start)
+                        .count();
+                auto& samples = (type == Operation::Allocate)
+                                    ? latencies.allocate
+                                    : latencies.free;
+                samples.push_back(std::max(ns - overhead, 0.0));
+            }
+        );
+    }
+
+    nlohmann::json result = {
+        { "allocator", subject.name },
+        { "trace", trace.name },
+        { "operations", operation_count },
+        { "ns_per_op", ns_per_op },
+        { "allocate_p50_ns", percentile(latencies.allocate, 0.5) },
+        { "allocate_p99_ns", percentile(latencies.allocate, 0.99) },
+        { "free_p50_ns", percentile(latencies.free, 0.5) },
+        { "free_p99_ns", percentile(latencies.free, 0.99) },
+        { "peak_used_bytes", statistics.peak_used },
+        { "peak_requested_bytes", statistics.peak_requested },
+        { "fragmentation", nullptr }
+    };
+    if (statistics.fragmentation_known)
+        result["fragmentation"] = statistics.fragmentation;
+    return result;
+}
+
+// /////////////////// //
+// THREADED ALLOCATORS //
+// /////////////////// //
+
+struct ThreadedSubject {
+    std::string name;
+    Allocator*  allocator;
+    uint64      min_size;
+    uint64      max_size;
+};
+
+// Thread cached allocators stay registered for the lifetime of the process,
+// so neither they nor their backing allocators are ever destroyed
+std::vector<ThreadedSubject> create_threaded_subjects() {
+    typedef FreeListAllocator     FLA;
+    typedef ThreadCachedAllocator TCA;
+
+    const auto size_class_backing = new FLA(general_size, FLA::SegregatedFit);
+    const auto pool_backing       = new PoolAllocator(frame_size, chunk_size);
+    const auto locked_backing     = new FLA(general_size, FLA::SegregatedFit);
+    size_class_backing->init();
+    pool_backing->init();
+    locked_backing->init();
+
+    // Some requests of size class subjects are too large to be cached
+    return {
+        { "thread_cached_size_classes",
+          new TCA(size_class_backing, TCA::CachePolicy::SizeClasses),
+          8,
+          2048 },
+        { "thread_cached_pool",
+          new TCA(pool_backing, TCA::CachePolicy::FixedSize, chunk_size),
+          8,
+          chunk_size },
+        { "locked_free_list",
+          new TCA(locked_backing, TCA::CachePolicy::Disabled),
+          8,
+          2048 },
+    };
+}
+
+struct ThreadedBlock {
+    void*  ptr  = nullptr;
+    uint64 size = 0;
+    uint8  fill = 0;
+};
+
+// Both ends of each block are filled with its own byte, so overlapping blocks
+// (handed out twice) are detected once either of them is freed. Only the ends
+// are filled to keep the allocator, not memset, dominant in timings
+constexpr uint64 fill_size = 32;
+
+void allocate_filled(
+    Allocator&     allocator,
+    ThreadedBlock& block,
+    const uint64   size,
+    const uint8    fill
+) {
+    block.ptr  = allocator.allocate(size, 8);
+    block.size = size;
+    block.fill = fill;
+    const uint64 end_size = std::min(size, fill_size);
+    std::memset(block.ptr, fill, end_size);
+    std::memset((uint8*) block.ptr + size - end_size, fill, end_size);
+}
+
+uint64 free_checked(Allocator& allocator, ThreadedBlock& block) {
+    const auto   bytes    = (const uint8*) block.ptr;
+    const uint64 end_size = std::min(block.size, fill_size);
+    uint64       errors   = 0;
+    for (uint64 i = 0; i < end_size; i++)
+        errors += (bytes[i] != block.fill) +
+                  (bytes[block.size - end_size + i] != block.fill);
+    allocator.free(block.ptr);
+    block.ptr = nullptr;
+    return errors;
+}
+
+struct ThreadedRun {
+    double wall_ns;
+    uint64 operations;
+    uint64 corrupted_bytes;
+};
+
+ThreadedRun run_threaded(
+    const ThreadedSubject& subject,
+    const uint32           thread_count,
+    const uint64           seed
+) {
+    constexpr uint32 slot_count = 1024;
+    constexpr uint32 step_count = 100000;
+
+    std::vector<std::vector<ThreadedBlock>> blocks(
+        thread_count, std::vector<ThreadedBlock>(slot_count)
+    );
+    std::vector<uint64> operations(thread_count, 0);
+    std::vector<uint64> errors(thread_count, 0);
+
+    // Random churn over own slots. Blocks left live are freed by the next
+    // thread, so part of each magazine holds blocks of other threads. Counters
+    // are written once per thread to avoid false sharing
+    const auto churn = [&](const uint32 index) {
+        auto&           own = blocks[index];
+        std::mt19937_64 rng { seed + index };
+        const uint64    range = subject.max_size - subject.min_size + 1;
+        uint64          error_count = 0;
+        for (uint32 step = 0; step < step_count; step++) {
+            auto& block = own[rng() % slot_count];
+            if (block.ptr == nullptr)
+                allocate_filled(
+                    *subject.allocator,
+                    block,
+                    subject.min_size + rng() % range,
+                    (uint8) (rng() | 1)
+                );
+            else error_count += free_checked(*subject.allocator, block);
+        }
+        operations[index] += step_count;
+        errors[index] += error_count;
+    };
+    const auto release = [&](const uint32 index) {
+        uint64 operation_count = 0, error_count = 0;
+        for (auto& block : blocks[(index + 1) % thread_count]) {
+            if (block.ptr == nullptr) continue;
+            error_count += free_checked(*subject.allocator, block);
+            operation_count++;
+        }
+        operations[index] += operation_count;
+        errors[index] += error_count;
+    };
+    const auto run_all = [&](auto&& body) {
+        std::vector<std::thread> threads;
+        for (uint32 i = 0; i < thread_count; i++)
+            threads.emplace_back(body, i);
+        for (auto& thread : threads)
+            thread.join();
+    };
+
+    // Thread exit flushes its caches, so both phases include their cost
+    const auto start = Clock::now();
+    run_all(churn);
+    run_all(release);
+    const double wall_ns = elapsed_ns(start);
+
+    ThreadedRun run { wall_ns, 0, 0 };
+    for (uint32 i = 0; i < thread_count; i++) {
+        run.operations += operations[i];
+        run.corrupted_bytes += errors[i];
+    }
+    return run;
+}
+
+nlohmann::json benchmark_threaded(
+    const ThreadedSubject& subject,
+    const uint32           thread_count,
+    const uint32           repetitions,
+    const uint64           seed
+) {
+    const uint64        used_before = subject.allocator->used();
+    std::vector<double> durations;
+    uint64              operations      = 0;
+    uint64              corrupted_bytes = 0;
+    for (uint32 i = 0; i < repetitions; i++) {
+        const auto run = run_threaded(subject, thread_count, seed);
+        durations.push_back(run.wall_ns);
+        operations = run.operations;
+        corrupted_bytes += run.corrupted_bytes;
+    }
+    const double wall_ns = median(durations);
+
+    return { { "allocator", subject.name },
+             { "trace", "threaded_churn" },
+             { "threads", thread_count },
+             { "operations", operations },
+             { "ns_per_op", wall_ns / operations },
+             { "mops_per_s", 1e3 * operations / wall_ns },
+             { "corrupted_bytes", corrupted_bytes },
+             { "leaked_bytes", subject.allocator->used() - used_before } };
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint32      repetitions = 5;
+    uint64      seed        = 0x5eed;
+    uint32      max_threads = std::max(std::thread::hardware_concurrency(), 1u);
+    std::string trace_filter;
+
+    for (int i = 1; i < argc; i++) {
+        std::string value;
+        if (parse_argument(argv[i], "repetitions", value))
+            repetitions = std::max(std::stoul(value), 1ul);
+        else if (parse_argument(argv[i], "seed", value))
+            seed = std::stoull(value);
+        else if (parse_argument(argv[i], "trace", value)) trace_filter = value;
+        else if (parse_argument(argv[i], "threads", value))
+            max_threads = std::max(std::stoul(value), 1ul);
+        else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--repetitions=N] [--seed=N] [--trace=NAME]"
+                         " [--threads=N]"
+                      << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    const std::vector<Trace> traces = { container_churn_trace(seed),
+                                        mesh_load_trace(seed),
+                                        frame_temp_trace(seed) };
+    const auto   subjects = create_subjects();
+    const double overhead = timer_overhead();
+
+    nlohmann::json results = nlohmann::json::array();
+    for (const auto& trace : traces) {
+        if (!trace_filter.empty() && trace.name != trace_filter) continue;
+        for (const auto& subject : subjects)
+            if (subject.supports(trace))
+                results.push_back(
+                    benchmark(subject, trace, repetitions, overhead)
+                );
+    }
+
+    // Thread count scaling
+    if (trace_filter.empty() || trace_filter == "threaded_churn") {
+        for (const auto& subject : create_threaded_subjects()) {
+            uint32 threads = 1;
+            while (true) {
+                results.push_back(
+                    benchmark_threaded(subject, threads, repetitions, seed)
+                );
+                if (threads == max_threads) break;
+                threads = std::min(threads * 2, max_threads);
+            }
+        }
+    }
+
+    const nlohmann::json output = { { "seed", seed },
+                                    { "repetitions", repetitions },
+                                    { "timer_overhead_ns", overhead },
+                                    { "results", results } };
+    std::cout << output.dump(4) << std::endl;
+    return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,27 @@
+#include "benchmark_support.hpp"
+
+#include <algorithm>
+
+double elapsed_ns(const Clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - start)
+        .count();
+}
+
+double percentile(std::vector<double>& samples, const double fraction) {
+    if (samples.empty()) return 0.0;
+    const auto index = (std::size_t) (fraction * (samples.size() - 1));
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index];
+}
+double median(std::vector<double>& samples) {
+    return percentile(samples, 0.5);
+}
+
+bool parse_argument(
+    const std::string& argument, const std::string& name, std::string& value
+) {
+    const std::string prefix = "--" + name + "=";
+    if (argument.compare(0, prefix.size(), prefix) != 0) return false;
+    value = argument.substr(prefix.size());
+    return true;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+/**
+ * Helpers shared by standalone benchmarks: timing, sample statistics and
+ * command line arguments.
+ */
+
+typedef std::chrono::steady_clock Clock;
+
+/// @brief Nanoseconds passed since @p start
+double elapsed_ns(const Clock::time_point start);
+
+/**
+ * @brief Sample at a given fraction of sorted samples (e.g. 0.5 for median).
+ * Samples are reordered.
+ * @param samples Measured samples
+ * @param fraction Position in sorted samples, from 0 to 1
+ * @return double Sample at that position, 0 if there are none
+ */
+double percentile(std::vector<double>& samples, const double fraction);
+/// @brief Median of samples (see percentile()). Samples are reordered
+double median(std::vector<double>& samples);
+
+/**
+ * @brief Parse argument of form "--<name>=<value>"
+ * @param argument Command line argument
+ * @param name Expected argument name
+ * @param value Set to argument value, if argument has the expected name
+ * @return true If argument has the expected name
+ */
+bool parse_argument(
+    const std::string& argument, const std::string& name, std::string& value
+);
@@ -0,0 +1,331 @@
+#include "component/bvh.hpp"
+#include "benchmark_support.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include <tiny_obj_loader.h>
+
+/**
+ * BVH microbenchmark. Builds a BVH over world space boxes of either a
+ * synthetic scene (randomly placed boxes) or of an OBJ scene (one box per OBJ
+ * shape, i.e. per geometry, placed as the demo application places the
+ * Luthadel scene), then measures rebuilds, refits and updates of moving boxes,
+ * and frustum culling, box queries and ray casts against it. Flat SIMD culling
+ * of all boxes is measured for reference. Results are reported as JSON on
+ * standard output.
+ *
+ * Usage: BVHBenchmark [--repetitions=N] [--boxes=N] [--queries=N]
+ *                     [--obj=PATH] [--scenario=NAME]
+ */
+
+using namespace ENGINE_NAMESPACE;
+
+namespace {
+
+typedef AxisAlignedBBox<3> BBox;
+
+// Fraction of boxes moved between BVH updates
+constexpr float32 moving_fraction = 0.1f;
+
+// ///// //
+// SCENE //
+// ///// //
+
+struct Scene {
+    BBoxArray           bounds;
+    glm::vec3           scene_min { Infinity32 };
+    glm::vec3           scene_max { -Infinity32 };
+    // Moving boxes and their per update offsets
+    std::vector<uint64> moving;
+    std::vector<float>  velocities;
+    // Queries
+    std::vector<BBox>   boxes;
+    std::vector<Ray<3>> rays;
+    std::vector<uint8>  visible;
+    Vector<uint32>      result;
+    BVH                 bvh;
+
+    void add(const BBox& bbox) {
+        const uint64 index = bounds.size();
+        bounds.resize(index + 1);
+        bounds.set(index, bbox);
+        scene_min = glm::min(scene_min, bbox.min);
+        scene_max = glm::max(scene_max, bbox.max);
+    }
+
+    // Random moving boxes, query boxes and rays within scene bounds
+    void finalize(const uint64 query_count) {
+        std::mt19937                            random { 0x5eed };
+        std::uniform_real_distribution<float32> unit { 0.0f, 1.0f };
+        std::uniform_real_distribution<float32> direction { -1.0f, 1.0f };
+
+        const auto extent   = scene_max - scene_min;
+        const auto position = [&] {
+            return scene_min +
+                   glm::vec3(unit(random), unit(random), unit(random)) * extent;
+        };
+
+        std::uniform_int_distribution<uint64> index { 0, bounds.size() - 1 };
+        const uint64 moving_count = bounds.size() * moving_fraction;
+        for (uint64 i = 0; i < moving_count; i++) {
+            moving.push_back(index(random));
+            velocities.push_back(direction(random) * extent.x * 1e-3f);
+        }
+
+        // Query boxes span 1% of the scene along each axis
+        for (uint64 i = 0; i < query_count; i++) {
+            const auto center = position();
+            const auto half   = extent * 0.005f;
+            boxes.push_back(BBox(center - half, center + half));
+            rays.push_back(Ray<3>(
+                position(),
+                { direction(random), direction(random), direction(random) }
+            ));
+        }
+        visible = std::vector<uint8>(bounds.size(), 0);
+        bvh.build(bounds);
+    }
+
+    // Moves boxes along the x axis, a bit further each update
+    void move() {
+        for (uint64 i = 0; i < moving.size(); i++)
+            bounds.center_x[moving[i]] += velocities[i];
+    }
+
+    // Perspective frustum at scene center looking along x, reaching its edges
+    Frustum frustum() const {
+        const auto extent = scene_max - scene_min;
+        return Frustum(
+            (scene_max + scene_min) * 0.5f,
+            { 1, 0, 0 },
+            { 0, -1, 0 },
+            { 0, 0, 1 },
+            16.0f / 9.0f,
+            glm::radians(60.0f),
+            0.1f,
+            glm::length(extent) * 0.5f
+        );
+    }
+};
+
+// Randomly placed boxes, as in the frustum culling benchmark
+void create_synthetic_scene(Scene& scene, const uint64 box_count) {
+    std::mt19937                            random { 0x5eed };
+    std::uniform_real_distribution<float32> position { -500.0f, 500.0f };
+    std::uniform_real_distribution<float32> size { 0.1f, 5.0f };
+
+    for (uint64 i = 0; i < box_count; i++) {
+        const glm::vec3 center { position(random),
+                                 position(random),
+                                 position(random) };
+        const glm::vec3 half { size(random), size(random), size(random) };
+        scene.add(BBox(center - half, center + half));
+    }
+}
+
+// One box per OBJ shape, transformed as the Luthadel scene is in the demo
+bool create_obj_scene(Scene& scene, const std::string& path) {
+    tinyobj::ObjReader reader;
+    if (!reader.ParseFromFile(path)) {
+        std::cerr << "TinyObjReader :: " << reader.Error() << std::endl;
+        return false;
+    }
+
+    auto transform =
+        glm::translate(glm::identity<glm::mat4>(), glm::vec3(0, -1, 0));
+    transform = glm::rotate(transform, glm::radians(90.0f), { 1, 0, 0 });
+
+    const auto& vertices = reader.GetAttrib().vertices;
+    for (const auto& shape : reader.GetShapes()) {
+        if (shape.mesh.indices.empty()) continue;
+
+        glm::vec3 min { Infinity32 };
+        glm::vec3 max { -Infinity32 };
+        for (const auto& index : shape.mesh.indices) {
+            const glm::vec3 position { vertices[3 * index.vertex_index + 0],
+                                       vertices[3 * index.vertex_index + 1],
+                                       vertices[3 * index.vertex_index + 2] };
+            min = glm::min(min, position);
+            max = glm::max(max, position);
+        }
+        scene.add(BBox(min, max).get_transformed(transform));
+    }
+    return scene.bounds.size() != 0;
+}
+
+// ///////// //
+// SCENARIOS //
+// ///////// //
+
+struct Scenario {
+    std::string                   name;
+    // Number of queries (or boxes, for tree construction) per run
+    std::function<uint64(Scene&)> query_count;
+    // Runs the workload once, returns number of found boxes (or rebuilds)
+    std::function<uint64(Scene&)> run;
+};
+
+uint64 box_count(Scene& scene) { return scene.bounds.size(); }
+uint64 query_count(Scene& scene) { return scene.boxes.size(); }
+uint64 single(Scene& scene) { return 1; }
+
+uint64 build(Scene& scene) {
+    scene.bvh.build(scene.bounds);
+    return scene.bvh.node_count();
+}
+
+uint64 refit(Scene& scene) {
+    scene.bvh.refit(scene.bounds);
+    return scene.bvh.node_count();
+}
+
+// Moving boxes between updates, counting rebuilds
+uint64 update(Scene& scene) {
+    scene.move();
+    return scene.bvh.update(scene.bounds);
+}
+
+uint64 cull_flat(Scene& scene) {
+    scene.frustum().cull(
+        scene.bounds, 0, scene.bounds.size(), scene.visible.data()
+    );
+    return std::count(scene.visible.begin(), scene.visible.end(), 1);
+}
+
+uint64 cull_bvh(Scene& scene) {
+    scene.result.clear();
+    scene.bvh.cull(scene.frustum(), scene.result);
+    return scene.result.size();
+}
+
+uint64 query_box(Scene& scene) {
+    uint64 found = 0;
+    for (const auto& bbox : scene.boxes) {
+        scene.result.clear();
+        scene.bvh.query_box(bbox, scene.result);
+        found += scene.result.size();
+    }
+    return found;
+}
+
+uint64 query_ray(Scene& scene) {
+    uint64 found = 0;
+    for (const auto& ray : scene.rays) {
+        scene.result.clear();
+        scene.bvh.query_ray(ray, scene.result);
+        found += scene.result.size();
+    }
+    return found;
+}
+
+uint64 ray_cast(Scene& scene) {
+    uint64  hits = 0;
+    uint32  index;
+    float32 t;
+    for (const auto& ray : scene.rays)
+        hits += scene.bvh.ray_cast(ray, index, t);
+    return hits;
+}
+
+std::vector<Scenario> create_scenarios() {
+    return {
+        { "build", box_count, build },
+        { "refit", box_count, refit },
+        { "update", box_count, update },
+        { "cull_flat", single, cull_flat },
+        { "cull_bvh", single, cull_bvh },
+        { "query_box", query_count, query_box },
+        { "query_ray", query_count, query_ray },
+        { "ray_cast", query_count, ray_cast },
+    };
+}
+
+// /////////// //
+// MEASUREMENT //
+// /////////// //
+
+nlohmann::json benchmark(
+    const Scenario& scenario, Scene& scene, const uint32 repetitions
+) {
+    // Warm up caches
+    scenario.run(scene);
+
+    std::vector<double> durations;
+    uint64              found = 0;
+    for (uint32 i = 0; i < repetitions; i++) {
+        const auto start = Clock::now();
+        found += scenario.run(scene);
+        durations.push_back(elapsed_ns(start));
+    }
+    const double min_ns =
+        *std::min_element(durations.begin(), durations.end());
+    const double median_ns = median(durations);
+    const uint64 count     = scenario.query_count(scene);
+
+    return { { "scenario", scenario.name },
+             { "count", count },
+             { "found", (double) found / repetitions },
+             { "total_ms", median_ns * 1e-6 },
+             { "ns_per_item", median_ns / count },
+             { "min_ms", min_ns * 1e-6 } };
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint32      repetitions = 9;
+    uint64      box_count   = 1000000;
+    uint64      query_count = 1000;
+    std::string obj_path;
+    std::string scenario_filter;
+
+    for (int i = 1; i < argc; i++) {
+        std::string value;
+        if (parse_argument(argv[i], "repetitions", value))
+            repetitions = std::max(std::stoul(value), 1ul);
+        else if (parse_argument(argv[i], "boxes", value))
+            box_count = std::max(std::stoul(value), 1ul);
+        else if (parse_argument(argv[i], "queries", value))
+            query_count = std::max(std::stoul(value), 1ul);
+        else if (parse_argument(argv[i], "obj", value)) obj_path = value;
+        else if (parse_argument(argv[i], "scenario", value))
+            scenario_filter = value;
+        else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--repetitions=N] [--boxes=N] [--queries=N]"
+                         " [--obj=PATH] [--scenario=NAME]"
+                      << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    Scene scene {};
+    if (obj_path.empty()) create_synthetic_scene(scene, box_count);
+    else if (!create_obj_scene(scene, obj_path)) return EXIT_FAILURE;
+    scene.finalize(query_count);
+
+    nlohmann::json results = nlohmann::json::array();
+    for (const auto& scenario : create_scenarios()) {
+        if (!scenario_filter.empty() && scenario.name != scenario_filter)
+            continue;
+        results.push_back(benchmark(scenario, scene, repetitions));
+    }
+
+    const nlohmann::json output = {
+        { "scene", obj_path.empty() ? "synthetic" : obj_path },
+        { "boxes", scene.bounds.size() },
+        { "nodes", scene.bvh.node_count() },
+        { "sah_cost", scene.bvh.cost() },
+        { "repetitions", repetitions },
+        { "results", results }
+    };
+    std::cout << output.dump(4) << std::endl;
+
+    return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,471 @@
+#include "component/frustum.hpp"
+#include "multithreading/parallel.hpp"
+#include "platform/platform.hpp"
+#include "benchmark_support.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+/**
+ * Frustum culling microbenchmark. Culls a scene of randomly placed and
+ * transformed boxes against a perspective frustum, once box by box through
+ * AxisAlignedBBox and Frustum::contains (as render views used to), and once
+ * with world space bounds kept in a BBoxArray and culled with Frustum::cull,
+ * serially and split across job system workers. Results are reported as JSON
+ * on standard output.
+ *
+ * Scene data is placed in a reserved address range, which is backed by huge
+ * pages or by regular pages (as engine allocators are with MEMORY_HUGE_PAGES
+ * on or off). The mesh_load scenario times allocating and filling vertex and
+ * index buffers in such a range, page faults included.
+ *
+ * Usage: FrustumCullingBenchmark [--repetitions=N] [--workers=N] [--boxes=N]
+ *                                [--meshes=N] [--scenario=NAME]
+ *                                [--huge-pages=on|off|both]
+ */
+
+using namespace ENGINE_NAMESPACE;
+
+namespace {
+
+typedef AxisAlignedBBox<3> BBox;
+
+// Minimal number of boxes culled by a single job (as in render views)
+constexpr uint64 cull_grain = 1024;
+
+// ////////////// //
+// BACKING MEMORY //
+// ////////////// //
+
+// Reserved address range, commited whole but faulted in lazily. Memory is
+// handed out linearly and never reused, frees of it are ignored.
+class PageBackedMemory {
+  public:
+    PageBackedMemory(const uint64 size, const bool huge_pages) {
+        // Over reserve, so that start can be huge page aligned
+        const uint64 alignment = std::max(
+            Platform::VirtualMemory::huge_page_size(),
+            Platform::VirtualMemory::page_size()
+        );
+        _reserved_size  = size + alignment;
+        _reserved_start = Platform::VirtualMemory::reserve(_reserved_size);
+        if (_reserved_start == nullptr ||
+            !Platform::VirtualMemory::commit(_reserved_start, _reserved_size)) {
+            std::cerr << "Memory reservation failed." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        _start = get_aligned((uint64) _reserved_start, alignment);
+        _size  = size;
+        if (huge_pages)
+            _huge_pages =
+                Platform::VirtualMemory::use_huge_pages((void*) _start, size);
+    }
+    ~PageBackedMemory() {
+        Platform::VirtualMemory::release(_reserved_start, _reserved_size);
+    }
+
+    void* allocate(const uint64 size) {
+        const uint64 offset = get_aligned(_offset, 16);
+        if (offset + size > _size) {
+            std::cerr << "Page backed memory is full." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        _offset = offset + size;
+        return (void*) (_start + offset);
+    }
+    bool owns(void* const ptr) const {
+        return (uint64) ptr >= _start && (uint64) ptr < _start + _size;
+    }
+    /// @brief Whether the system agreed to back this memory with huge pages
+    bool huge_pages() const { return _huge_pages; }
+
+  private:
+    void*  _reserved_start;
+    uint64 _reserved_size;
+    uint64 _start;
+    uint64 _size;
+    uint64 _offset     = 0;
+    bool   _huge_pages = false;
+};
+
+// Memory whose frees are ignored, and whether allocations of the current
+// thread are placed in it
+std::atomic<PageBackedMemory*> page_backed_memory { nullptr };
+thread_local bool              place_in_page_backed_memory = false;
+
+// Allocations of the current thread go to the given memory while in scope
+class PlacementScope {
+  public:
+    PlacementScope(PageBackedMemory& memory) {
+        page_backed_memory          = &memory;
+        place_in_page_backed_memory = true;
+    }
+    ~PlacementScope() { place_in_page_backed_memory = false; }
+};
+
+// ///// //
+// SCENE //
+// ///// //
+
+// Boxes in local space, each owned by one of the meshes (model matrices)
+struct Scene {
+    std::vector<BBox>      local_boxes;
+    std::vector<uint32>    mesh_indices;
+    std::vector<glm::mat4> model_matrices;
+    std::vector<BBox>      world_boxes;
+    BBoxArray              world_bounds;
+    std::vector<uint8>     visible;
+    Frustum                frustum;
+
+    Scene(const uint64 box_count, const uint32 mesh_count)
+        : frustum(
+              { 0, 0, 0 },
+              { 1, 0, 0 },
+              { 0, -1, 0 },
+              { 0, 0, 1 },
+              16.0f / 9.0f,
+              glm::radians(60.0f),
+              0.1f,
+              500.0f
+          ) {
+        std::mt19937                            random { 0x5eed };
+        std::uniform_real_distribution<float32> position { -500.0f, 500.0f };
+        std::uniform_real_distribution<float32> size { 0.1f, 5.0f };
+        std::uniform_real_distribution<float32> angle { 0.0f, 6.28f };
+        std::uniform_real_distribution<float32> scale { 0.5f, 2.0f };
+        std::uniform_real_distribution<float32> offset { -20.0f, 20.0f };
+
+        // Reserved up front, so page backed memory isn't spent on regrowth
+        model_matrices.reserve(mesh_count);
+        local_boxes.reserve(box_count);
+        mesh_indices.reserve(box_count);
+        world_boxes.reserve(box_count);
+
+        for (uint32 i = 0; i < mesh_count; i++) {
+            auto matrix = glm::translate(
+                glm::identity<glm::mat4>(),
+                { position(random), position(random), position(random) }
+            );
+            matrix = glm::rotate(matrix, angle(random), { 0, 0, 1 });
+            matrix = glm::rotate(matrix, angle(random), { 1, 0, 0 });
+            matrix = glm::scale(matrix, glm::vec3(scale(random)));
+            model_matrices.push_back(matrix);
+        }
+        for (uint64 i = 0; i < box_count; i++) {
+            const glm::vec3 center { offset(random),
+                                     offset(random),
+                                     offset(random) };
+            const glm::vec3 half { size(random), size(random), size(random) };
+            local_boxes.push_back(BBox(center - half, center + half));
+            mesh_indices.push_back(i % mesh_count);
+            world_boxes.push_back(
+                local_boxes[i].get_transformed(model_matrices[i % mesh_count])
+            );
+        }
+        world_bounds.resize(box_count);
+        for (uint64 i = 0; i < box_count; i++)
+            world_bounds.set(i, world_boxes[i]);
+        visible = std::vector<uint8>(box_count, 0);
+    }
+
+    uint64 visible_count() const {
+        return std::count(visible.begin(), visible.end(), 1);
+    }
+
+    // Upper bound on memory taken by a scene, with slack for alignment
+    static uint64 memory_size(const uint64 box_count, const uint32 mesh_count) {
+        const uint64 box_size = 2 * sizeof(BBox) + sizeof(uint32) +
+                                6 * sizeof(float32) + sizeof(uint8);
+        return box_count * box_size + mesh_count * sizeof(glm::mat4) +
+               sizeof(Scene) + 1024 * 1024;
+    }
+};
+
+// ///////// //
+// SCENARIOS //
+// ///////// //
+
+struct Scenario {
+    std::string                 name;
+    std::function<void(Scene&)> run;
+};
+
+// Former culling path, box by box through virtual bounding box methods
+void contains_transformed(Scene& scene) {
+    for (uint64 i = 0; i < scene.local_boxes.size(); i++) {
+        const auto& matrix = scene.model_matrices[scene.mesh_indices[i]];
+        const auto  aabb   = scene.local_boxes[i].get_transformed(matrix);
+        scene.visible[i]   = scene.frustum.contains(aabb);
+    }
+}
+
+// Same, with boxes already in world space
+void contains(Scene& scene) {
+    for (uint64 i = 0; i < scene.world_boxes.size(); i++)
+        scene.visible[i] = scene.frustum.contains(scene.world_boxes[i]);
+}
+
+// SIMD culling of boxes already in world space
+void cull(Scene& scene) {
+    scene.frustum.cull(
+        scene.world_bounds, 0, scene.world_bounds.size(), scene.visible.data()
+    );
+}
+
+// World space bounds computation followed by SIMD culling of a range
+void cull_transformed_range(Scene& scene, const Parallel::Range range) {
+    for (uint64 i = range.begin; i < range.end; i++)
+        scene.world_bounds.set_transformed(
+            i,
+            scene.local_boxes[i],
+            scene.model_matrices[scene.mesh_indices[i]]
+        );
+    scene.frustum.cull(
+        scene.world_bounds, range.begin, range.end, scene.visible.data()
+    );
+}
+
+void cull_transformed(Scene& scene) {
+    cull_transformed_range(scene, { 0, scene.local_boxes.size() });
+}
+
+// As render views cull, split into chunks across workers
+void cull_transformed_parallel(Scene& scene) {
+    Parallel::for_loop(
+        { 0, scene.local_boxes.size() },
+        cull_grain,
+        [&scene](const Parallel::Range chunk) {
+            cull_transformed_range(scene, chunk);
+        }
+    );
+}
+
+std::vector<Scenario> create_scenarios() {
+    return {
+        { "contains_transformed", contains_transformed },
+        { "contains", contains },
+        { "cull", cull },
+        { "cull_transformed", cull_transformed },
+        { "cull_transformed_parallel", cull_transformed_parallel },
+    };
+}
+
+// /////////// //
+// MEASUREMENT //
+// /////////// //
+
+nlohmann::json benchmark(
+    const Scenario& scenario,
+    Scene&          scene,
+    const uint32    repetitions,
+    const bool      huge_pages
+) {
+    // Warm up caches and worker threads
+    std::fill(scene.visible.begin(), scene.visible.end(), 0);
+    scenario.run(scene);
+
+    std::vector<double> durations;
+    for (uint32 i = 0; i < repetitions; i++) {
+        const auto start = Clock::now();
+        scenario.run(scene);
+        durations.push_back(elapsed_ns(start));
+    }
+    const double min_ns =
+        *std::min_element(durations.begin(), durations.end());
+    const double median_ns = median(durations);
+    const uint64 box_count = scene.local_boxes.size();
+
+    return { { "scenario", scenario.name },
+             { "huge_pages", huge_pages },
+             { "boxes", box_count },
+             { "visible", scene.visible_count() },
+             { "total_ms", median_ns * 1e-6 },
+             { "ns_per_box", median_ns / box_count },
+             { "min_ns_per_box", min_ns / box_count } };
+}
+
+// Vertex layout of loaded meshes
+struct Vertex {
+    glm::vec3 position;
+    glm::vec3 normal;
+    glm::vec2 texture_coord;
+    glm::vec4 tangent;
+};
+
+// Allocation and filling of vertex & index buffers of a burst of mesh loads,
+// each repetition in fresh memory, so page faults are included
+nlohmann::json benchmark_mesh_load(
+    const uint64 mesh_count, const uint32 repetitions, const bool huge_pages
+) {
+    std::mt19937_64     random { 0x5eed };
+    std::vector<uint64> vertex_counts(mesh_count);
+    uint64              total_size = 0;
+    for (auto& vertex_count : vertex_counts) {
+        vertex_count = 1024 + random() % (16 * 1024);
+        // Around two triangles per vertex
+        total_size += vertex_count * (sizeof(Vertex) + 6 * sizeof(uint32)) + 32;
+    }
+
+    std::vector<double> durations;
+    bool                used_huge_pages = false;
+    for (uint32 i = 0; i < repetitions; i++) {
+        PageBackedMemory memory { total_size, huge_pages };
+        used_huge_pages = memory.huge_pages();
+
+        const auto start = Clock::now();
+        for (const auto vertex_count : vertex_counts) {
+            const auto vertices = (Vertex*) memory.allocate(
+                vertex_count * sizeof(Vertex)
+            );
+            for (uint64 j = 0; j < vertex_count; j++)
+                vertices[j] = { glm::vec3(j),
+                                { 0, 0, 1 },
+                                glm::vec2(j),
+                                { 1, 0, 0, 1 } };
+
+            const uint64 index_count = 6 * vertex_count;
+            const auto   indices =
+                (uint32*) memory.allocate(index_count * sizeof(uint32));
+            for (uint64 j = 0; j < index_count; j++)
+                indices[j] = (uint32) ((j * 7) % vertex_count);
+        }
+        durations.push_back(elapsed_ns(start));
+    }
+    const double min_ns =
+        *std::min_element(durations.begin(), durations.end());
+    const double median_ns = median(durations);
+
+    return { { "scenario", "mesh_load" },
+             { "huge_pages", used_huge_pages },
+             { "meshes", mesh_count },
+             { "bytes", total_size },
+             { "total_ms", median_ns * 1e-6 },
+             { "mb_per_s", total_size / (median_ns * 1e-3) },
+             { "min_ms", min_ns * 1e-6 } };
+}
+
+} // namespace
+
+// Global new & delete, so that both standard and engine containers of the scene
+// can be placed in page backed memory
+void* operator new(std::size_t size) {
+    if (place_in_page_backed_memory)
+        return page_backed_memory.load()->allocate(size);
+    if (const auto ptr = std::malloc(size)) return ptr;
+    throw std::bad_alloc();
+}
+void operator delete(void* ptr) noexcept {
+    const auto memory = page_backed_memory.load();
+    if (memory != nullptr && memory->owns(ptr)) return;
+    std::free(ptr);
+}
+void operator delete(void* ptr, std::size_t) noexcept {
+    operator delete(ptr);
+}
+
+int main(int argc, char** argv) {
+    uint32      repetitions = 9;
+    uint32      workers     = 0;
+    uint64      box_count   = 100000;
+    uint64      mesh_count  = 256;
+    std::string scenario_filter;
+    std::string huge_pages  = "both";
+
+    for (int i = 1; i < argc; i++) {
+        std::string value;
+        if (parse_argument(argv[i], "repetitions", value))
+            repetitions = std::max(std::stoul(value), 1ul);
+        else if (parse_argument(argv[i], "workers", value))
+            workers = std::stoul(value);
+        else if (parse_argument(argv[i], "boxes", value))
+            box_count = std::max(std::stoul(value), 1ul);
+        else if (parse_argument(argv[i], "meshes", value))
+            mesh_count = std::max(std::stoul(value), 1ul);
+        else if (parse_argument(argv[i], "scenario", value))
+            scenario_filter = value;
+        else if (parse_argument(argv[i], "huge-pages", value) &&
+                 (value == "on" || value == "off" || value == "both"))
+            huge_pages = value;
+        else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--repetitions=N] [--workers=N] [--boxes=N]"
+                         " [--meshes=N] [--scenario=NAME]"
+                         " [--huge-pages=on|off|both]"
+                      << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    JobSystem::initialize(workers);
+
+    std::vector<bool> page_settings;
+    if (huge_pages != "off") page_settings.push_back(true);
+    if (huge_pages != "on") page_settings.push_back(false);
+
+    // Around 16 geometries per mesh
+    const uint32 scene_mesh_count =
+        (uint32) std::max(box_count / 16, (uint64) 1);
+    const auto scenarios = create_scenarios();
+    const auto selected  = [&](const std::string& name) {
+        return scenario_filter.empty() || name == scenario_filter;
+    };
+    const bool cull = std::any_of(
+        scenarios.begin(),
+        scenarios.end(),
+        [&](const Scenario& scenario) { return selected(scenario.name); }
+    );
+
+    nlohmann::json results = nlohmann::json::array();
+    for (const bool use_huge_pages : page_settings) {
+        if (cull) {
+            PageBackedMemory memory {
+                Scene::memory_size(box_count, scene_mesh_count), use_huge_pages
+            };
+            std::unique_ptr<Scene> scene;
+            {
+                PlacementScope placement { memory };
+                scene = std::make_unique<Scene>(box_count, scene_mesh_count);
+            }
+
+            for (const auto& scenario : scenarios)
+                if (selected(scenario.name))
+                    results.push_back(benchmark(
+                        scenario, *scene, repetitions, memory.huge_pages()
+                    ));
+
+            scene.reset();
+            page_backed_memory = nullptr;
+        }
+        if (selected("mesh_load"))
+            results.push_back(
+                benchmark_mesh_load(mesh_count, repetitions, use_huge_pages)
+            );
+    }
+
+#if defined(__AVX__)
+    const std::string simd = "AVX";
+#elif defined(__SSE__) || defined(_M_X64)
+    const std::string simd = "SSE";
+#else
+    const std::string simd = "none";
+#endif
+    const nlohmann::json output = {
+        { "workers", JobSystem::worker_count() },
+        { "simd", simd },
+        { "huge_page_size", Platform::VirtualMemory::huge_page_size() },
+        { "repetitions", repetitions },
+        { "results", results }
+    };
+    std::cout << output.dump(4) << std::endl;
+
+    JobSystem::shutdown();
+    return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,17 @@
+#include "systems/memory/memory_system.hpp"
+
+/**
+ * Tagged allocation for standalone benchmarks, which link only the engine
+ * parts they measure and not the memory system. Memory of tagged allocations
+ * (jobs, engine containers) comes directly from the global heap here, and is
+ * freed by the global delete.
+ */
+
+using namespace ENGINE_NAMESPACE;
+
+void* operator new(std::size_t size, [[maybe_unused]] const MemoryTag tag) {
+    return operator new(size);
+}
+void* operator new[](std::size_t size, [[maybe_unused]] const MemoryTag tag) {
+    return operator new(size);
+}
@@ -0,0 +1,285 @@
+#include "multithreading/parallel.hpp"
+#include "benchmark_support.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+/**
+ * Job system microbenchmark. Measures scheduling overhead of the job system on
+ * synthetic workloads with (close to) empty jobs, so that time spent is that
+ * of queueing, stealing, counters and continuations. Parallel loop is also run
+ * the way the former Parallel::for_loop did it (one std::function call per
+ * index on top of TBB) for reference, as is a culling sized workload, once
+ * that way and once with chunked Parallel::for_loop and Parallel::reduce.
+ * Results are reported as JSON on standard output.
+ *
+ * Usage: JobSystemBenchmark [--repetitions=N] [--workers=N] [--scenario=NAME]
+ */
+
+using namespace ENGINE_NAMESPACE;
+
+namespace {
+
+// Keeps the optimizer from removing benchmarked work
+std::atomic<uint64> sink { 0 };
+
+// ///////// //
+// SCENARIOS //
+// ///////// //
+
+struct Scenario {
+    std::string           name;
+    // Number of scheduled jobs (or loop iterations for the reference loop)
+    uint64                job_count;
+    // Runs the workload once
+    std::function<void()> run;
+};
+
+// Many independent empty jobs run from a single thread, tracked by one counter
+void spawn_wait(const uint64 job_count) {
+    JobSystem::Counter counter {};
+    for (uint64 i = 0; i < job_count; i++)
+        JobSystem::run([] {}, &counter);
+    JobSystem::wait(counter);
+}
+
+// Loop over a range split into chunks, one job per chunk
+void chunked_loop(const uint64 iteration_count, const uint64 chunk_count) {
+    JobSystem::Counter counter {};
+    const uint64       chunk_size = iteration_count / chunk_count;
+    for (uint64 chunk = 0; chunk < chunk_count; chunk++)
+        JobSystem::run(
+            [chunk, chunk_size] {
+                const uint64 end = (chunk + 1) * chunk_size;
+                uint64       sum = 0;
+                for (uint64 i = chunk * chunk_size; i < end; i++)
+                    sum += i;
+                sink.fetch_add(sum, std::memory_order_relaxed);
+            },
+            &counter
+        );
+    JobSystem::wait(counter);
+}
+
+// Same loop as Parallel::for_loop used to run it
+void per_index_loop(const uint64 iteration_count) {
+    const std::function<void(uint64)> body = [](uint64 i) {
+        sink.fetch_add(i, std::memory_order_relaxed);
+    };
+    tbb::parallel_for(
+        tbb::blocked_range<uint64>(0, iteration_count),
+        [&body](tbb::blocked_range<uint64> range) {
+            for (uint64 i = range.begin(); i != range.end(); i++)
+                body(i);
+        }
+    );
+}
+
+// Bounding spheres tested against 6 frustum planes, as in view culling
+struct CullingData {
+    struct Sphere {
+        float32 x, y, z, radius;
+    };
+    struct Plane {
+        float32 x, y, z, distance;
+    };
+
+    std::vector<Sphere> spheres;
+    std::vector<Plane>  planes;
+    std::vector<uint8>  visible;
+
+    CullingData(const uint64 sphere_count) {
+        std::mt19937                            random { 0x5eed };
+        std::uniform_real_distribution<float32> position { -100.0f, 100.0f };
+        std::uniform_real_distribution<float32> radius { 0.1f, 5.0f };
+        for (uint64 i = 0; i < sphere_count; i++)
+            spheres.push_back(
+                { position(random),
+                  position(random),
+                  position(random),
+                  radius(random) }
+            );
+        // Box of half size 50 around the origin, normals pointing inward
+        planes  = { { 1, 0, 0, 50 },  { -1, 0, 0, 50 }, { 0, 1, 0, 50 },
+                    { 0, -1, 0, 50 }, { 0, 0, 1, 50 },  { 0, 0, -1, 50 } };
+        visible = std::vector<uint8>(sphere_count, 0);
+    }
+
+    bool is_visible(const uint64 index) const {
+        const auto& sphere = spheres[index];
+        for (const auto& plane : planes)
+            if (plane.x * sphere.x + plane.y * sphere.y + plane.z * sphere.z +
+                    plane.distance <
+                -sphere.radius)
+                return false;
+        return true;
+    }
+};
+
+// Culling as with the former Parallel::for_loop
+void culling_per_index(CullingData& data) {
+    const std::function<void(uint64)> body = [&data](uint64 i) {
+        data.visible[i] = data.is_visible(i);
+    };
+    tbb::parallel_for(
+        tbb::blocked_range<uint64>(0, data.spheres.size()),
+        [&body](tbb::blocked_range<uint64> range) {
+            for (uint64 i = range.begin(); i != range.end(); i++)
+                body(i);
+        }
+    );
+}
+
+// Culling with chunked loop bodies
+void culling_chunked(CullingData& data) {
+    Parallel::for_loop(
+        { 0, data.spheres.size() },
+        1024,
+        [&data](const Parallel::Range chunk) {
+            for (uint64 i = chunk.begin; i < chunk.end; i++)
+                data.visible[i] = data.is_visible(i);
+        }
+    );
+}
+
+// Number of visible spheres only
+void culling_reduce(CullingData& data) {
+    const uint64 visible_count = Parallel::reduce(
+        { 0, data.spheres.size() },
+        1024,
+        (uint64) 0,
+        [&data](const Parallel::Range chunk) {
+            uint64 count = 0;
+            for (uint64 i = chunk.begin; i < chunk.end; i++)
+                count += data.is_visible(i);
+            return count;
+        },
+        std::plus<uint64>()
+    );
+    sink.fetch_add(visible_count, std::memory_order_relaxed);
+}
+
+// Chain of jobs, each one a continuation of the previous one
+void continuation_chain(const uint64 job_count) {
+    std::vector<JobSystem::Counter> counters(job_count);
+    JobSystem::run([] {}, &counters[0]);
+    for (uint64 i = 1; i < job_count; i++)
+        JobSystem::then(counters[i - 1], [] {}, &counters[i]);
+    JobSystem::wait(counters[job_count - 1]);
+    // Counters are destroyed only once all of them were waited on
+    for (auto& counter : counters)
+        JobSystem::wait(counter);
+}
+
+// Recursive binary split, each job waiting for its two children
+void fork_join(const uint32 depth) {
+    if (depth == 0) return;
+    JobSystem::Counter counter {};
+    JobSystem::run([depth] { fork_join(depth - 1); }, &counter);
+    JobSystem::run([depth] { fork_join(depth - 1); }, &counter);
+    JobSystem::wait(counter);
+}
+
+std::vector<Scenario> create_scenarios() {
+    constexpr uint64 loop_size    = 1 << 22;
+    constexpr uint32 tree_depth   = 15;
+    constexpr uint64 culling_size = 100000;
+    const uint64     chunks       = 8 * JobSystem::worker_count();
+    const auto culling_data = std::make_shared<CullingData>(culling_size);
+
+    return {
+        { "spawn_wait", 100000, [] { spawn_wait(100000); } },
+        { "chunked_loop",
+          chunks,
+          [chunks] { chunked_loop(loop_size, chunks); } },
+        { "per_index_function_loop",
+          loop_size,
+          [] { per_index_loop(loop_size); } },
+        { "continuation_chain", 10000, [] { continuation_chain(10000); } },
+        { "fork_join",
+          ((uint64) 2 << tree_depth) - 2,
+          [] { fork_join(tree_depth); } },
+        { "culling_per_index_function",
+          culling_size,
+          [culling_data] { culling_per_index(*culling_data); } },
+        { "culling_for_loop",
+          culling_size,
+          [culling_data] { culling_chunked(*culling_data); } },
+        { "culling_reduce",
+          culling_size,
+          [culling_data] { culling_reduce(*culling_data); } },
+    };
+}
+
+// /////////// //
+// MEASUREMENT //
+// /////////// //
+
+nlohmann::json benchmark(const Scenario& scenario, const uint32 repetitions) {
+    // Warm up job memory and worker threads
+    scenario.run();
+
+    std::vector<double> durations;
+    for (uint32 i = 0; i < repetitions; i++) {
+        const auto start = Clock::now();
+        scenario.run();
+        durations.push_back(elapsed_ns(start));
+    }
+    const double min_ns =
+        *std::min_element(durations.begin(), durations.end());
+    const double median_ns = median(durations);
+
+    return { { "scenario", scenario.name },
+             { "jobs", scenario.job_count },
+             { "total_ms", median_ns * 1e-6 },
+             { "ns_per_job", median_ns / scenario.job_count },
+             { "min_ns_per_job", min_ns / scenario.job_count } };
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint32      repetitions = 9;
+    uint32      workers     = 0;
+    std::string scenario_filter;
+
+    for (int i = 1; i < argc; i++) {
+        std::string value;
+        if (parse_argument(argv[i], "repetitions", value))
+            repetitions = std::max(std::stoul(value), 1ul);
+        else if (parse_argument(argv[i], "workers", value))
+            workers = std::stoul(value);
+        else if (parse_argument(argv[i], "scenario", value))
+            scenario_filter = value;
+        else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--repetitions=N] [--workers=N] [--scenario=NAME]"
+                      << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    JobSystem::initialize(workers);
+
+    nlohmann::json results = nlohmann::json::array();
+    for (const auto& scenario : create_scenarios()) {
+        if (!scenario_filter.empty() && scenario.name != scenario_filter)
+            continue;
+        results.push_back(benchmark(scenario, repetitions));
+    }
+
+    const nlohmann::json output = { { "workers", JobSystem::worker_count() },
+                                    { "repetitions", repetitions },
+                                    { "results", results } };
+    std::cout << output.dump(4) << std::endl;
+
+    JobSystem::shutdown();
+    return EXIT_SUCCESS;
+}
\ No newline at end of file
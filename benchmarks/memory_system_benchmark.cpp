@@ -0,0 +1,152 @@
+#include "systems/memory/memory_system.hpp"
+#include "benchmark_support.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+/**
+ * Memory system microbenchmark. Allocates with tagged operator new and frees
+ * with the global operator delete, so each free goes through the ownership
+ * lookup of the memory system, as all engine frees do. Patterns cover
+ * immediate new/delete pairs and batches freed in random order, over tags
+ * backed by different allocators. Lookup alone is timed separately. Reports
+ * throughput as JSON on standard output.
+ *
+ * Only memory system interface predating the address space based ownership
+ * lookup is used, so the benchmark can be run against both implementations.
+ *
+ * Usage: MemorySystemBenchmark [--repetitions=N] [--seed=N] [--count=N]
+ */
+
+using namespace ENGINE_NAMESPACE;
+
+namespace {
+
+// ///////// //
+// WORKLOADS //
+// ///////// //
+
+struct Subject {
+    std::string name;
+    MemoryTag   tag;
+    uint64      min_size;
+    uint64      max_size;
+};
+
+// Tags backed by a free list, a stack and the C allocator (outside of the
+// address space of the memory system)
+std::vector<Subject> create_subjects() {
+    return { { "array_64", MemoryTag::Array, 64, 64 },
+             { "array_mixed", MemoryTag::Array, 16, 1024 },
+             { "geometry_mixed", MemoryTag::Geometry, 256, 4096 },
+             { "temp_64", MemoryTag::Temp, 64, 64 },
+             { "unknown_64", MemoryTag::Unknown, 64, 64 } };
+}
+
+std::vector<uint64> create_sizes(
+    const Subject& subject, const uint64 count, const uint64 seed
+) {
+    std::mt19937_64     rng { seed };
+    std::vector<uint64> sizes(count);
+    for (auto& size : sizes)
+        size = subject.min_size +
+               rng() % (subject.max_size - subject.min_size + 1);
+    return sizes;
+}
+
+// /////////// //
+// MEASUREMENT //
+// /////////// //
+
+nlohmann::json benchmark(
+    const Subject& subject,
+    const uint64   count,
+    const uint32   repetitions,
+    const uint64   seed
+) {
+    const auto sizes = create_sizes(subject, count, seed);
+
+    // Free order of batches. Stack memory has to be freed in reverse
+    std::vector<uint64> order(count);
+    for (uint64 i = 0; i < count; i++)
+        order[i] = count - 1 - i;
+    if (subject.tag != MemoryTag::Temp)
+        std::shuffle(order.begin(), order.end(), std::mt19937_64 { seed });
+
+    std::vector<void*>  pointers(count);
+    std::vector<double> pairs, batch_new, batch_delete, lookups;
+    volatile uint64     sink = 0;
+    for (uint32 repetition = 0; repetition < repetitions; repetition++) {
+        // Pairs, memory is reused right away
+        auto start = Clock::now();
+        for (uint64 i = 0; i < count; i++) {
+            const auto pointer = operator new(sizes[i], subject.tag);
+            operator delete(pointer);
+        }
+        pairs.push_back(elapsed_ns(start) / count);
+
+        // Batch, all allocations are live before the first delete
+        start = Clock::now();
+        for (uint64 i = 0; i < count; i++)
+            pointers[i] = operator new(sizes[i], subject.tag);
+        batch_new.push_back(elapsed_ns(start) / count);
+
+        start = Clock::now();
+        for (uint64 i = 0; i < count; i++)
+            sink = sink + (uint64) MemorySystem::get_owner(pointers[order[i]]);
+        lookups.push_back(elapsed_ns(start) / count);
+
+        start = Clock::now();
+        for (uint64 i = 0; i < count; i++)
+            operator delete(pointers[order[i]]);
+        batch_delete.push_back(elapsed_ns(start) / count);
+    }
+
+    const double delete_ns = median(batch_delete);
+    return { { "subject", subject.name },
+             { "allocations", count },
+             { "pair_ns", median(pairs) },
+             { "batch_new_ns", median(batch_new) },
+             { "batch_delete_ns", delete_ns },
+             { "delete_mops_per_s", 1e3 / delete_ns },
+             { "owner_lookup_ns", median(lookups) } };
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint32 repetitions = 5;
+    uint64 seed        = 0x5eed;
+    uint64 count       = 100000;
+
+    for (int i = 1; i < argc; i++) {
+        std::string value;
+        if (parse_argument(argv[i], "repetitions", value))
+            repetitions = std::max(std::stoul(value), 1ul);
+        else if (parse_argument(argv[i], "seed", value))
+            seed = std::stoull(value);
+        else if (parse_argument(argv[i], "count", value))
+            count = std::max(std::stoull(value), 1ull);
+        else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--repetitions=N] [--seed=N] [--count=N]"
+                      << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    nlohmann::json results = nlohmann::json::array();
+    for (const auto& subject : create_subjects())
+        results.push_back(benchmark(subject, count, repetitions, seed));
+
+    const nlohmann::json output = { { "seed", seed },
+                                    { "repetitions", repetitions },
+                                    { "results", results } };
+    std::cout << output.dump(4) << std::endl;
+    return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,284 @@
+#include "component/mesh_simplifier.hpp"
+#include "benchmark_support.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include <tiny_obj_loader.h>
+
+/**
+ * Mesh simplification microbenchmark. Generates levels of detail as OBJ import
+ * does (each with about half the triangles of the previous one, and twice its
+ * allowed error) for synthetic meshes (a UV sphere with a texture seam, an
+ * open terrain grid and a torus) or for all shapes of an OBJ file. Reports
+ * generation time along with triangle count and error of each level. Results
+ * are reported as JSON on standard output.
+ *
+ * Usage: MeshSimplificationBenchmark [--repetitions=N] [--resolution=N]
+ *                                    [--obj=PATH]
+ */
+
+using namespace ENGINE_NAMESPACE;
+
+namespace {
+
+// Level of detail settings of mesh import
+constexpr uint32  lod_count              = 4;
+constexpr uint64  min_lod_triangle_count = 128;
+constexpr float32 lod_max_error          = 0.0025f;
+
+// ////// //
+// MESHES //
+// ////// //
+
+struct Mesh {
+    std::string       name;
+    Vector<glm::vec3> positions;
+    Vector<uint32>    indices;
+};
+
+// Sphere with a texture seam along one meridian. Seam and pole vertices are
+// duplicated, as texture coordinates differ
+Mesh create_sphere(const uint32 resolution) {
+    const uint32 segments = 2 * resolution;
+    const uint32 rings    = resolution;
+
+    Mesh mesh { "uv_sphere" };
+    for (uint32 ring = 0; ring <= rings; ring++) {
+        for (uint32 segment = 0; segment <= segments; segment++) {
+            const float32 theta = glm::pi<float32>() * ring / rings;
+            const float32 phi =
+                glm::two_pi<float32>() * (segment % segments) / segments;
+            mesh.positions.push_back(
+                { std::sin(theta) * std::cos(phi),
+                  std::sin(theta) * std::sin(phi),
+                  std::cos(theta) }
+            );
+        }
+    }
+    // Poles are shared by all segments
+    for (uint32 segment = 0; segment <= segments; segment++) {
+        mesh.positions[segment]                          = { 0, 0, 1 };
+        mesh.positions[rings * (segments + 1) + segment] = { 0, 0, -1 };
+    }
+
+    const auto vertex = [&](const uint32 ring, const uint32 segment) {
+        return ring * (segments + 1) + segment;
+    };
+    for (uint32 ring = 0; ring < rings; ring++) {
+        for (uint32 segment = 0; segment < segments; segment++) {
+            if (ring > 0)
+                for (const uint32 index : { vertex(ring, segment),
+                                            vertex(ring + 1, segment),
+                                            vertex(ring, segment + 1) })
+                    mesh.indices.push_back(index);
+            if (ring < rings - 1)
+                for (const uint32 index : { vertex(ring, segment + 1),
+                                            vertex(ring + 1, segment),
+                                            vertex(ring + 1, segment + 1) })
+                    mesh.indices.push_back(index);
+        }
+    }
+    return mesh;
+}
+
+// Open height field, with small noise on top of smooth hills
+Mesh create_terrain(const uint32 resolution) {
+    std::mt19937                            random { 0x5eed };
+    std::uniform_real_distribution<float32> noise { -0.002f, 0.002f };
+
+    Mesh mesh { "terrain" };
+    for (uint32 y = 0; y <= resolution; y++) {
+        for (uint32 x = 0; x <= resolution; x++) {
+            const float32 u = (float32) x / resolution;
+            const float32 v = (float32) y / resolution;
+            mesh.positions.push_back(
+                { u,
+                  v,
+                  0.1f * std::sin(6.0f * u) * std::cos(4.0f * v) +
+                      noise(random) }
+            );
+        }
+    }
+    for (uint32 y = 0; y < resolution; y++) {
+        for (uint32 x = 0; x < resolution; x++) {
+            const uint32 corner = y * (resolution + 1) + x;
+            const uint32 right  = corner + 1;
+            const uint32 top    = corner + resolution + 1;
+            for (const uint32 index :
+                 { corner, right, top, right, top + 1, top })
+                mesh.indices.push_back(index);
+        }
+    }
+    return mesh;
+}
+
+// Closed surface without seams
+Mesh create_torus(const uint32 resolution) {
+    const uint32 major = 3 * resolution;
+    const uint32 minor = resolution;
+
+    Mesh mesh { "torus" };
+    for (uint32 i = 0; i < major; i++) {
+        for (uint32 j = 0; j < minor; j++) {
+            const float32 u = glm::two_pi<float32>() * i / major;
+            const float32 v = glm::two_pi<float32>() * j / minor;
+            const float32 r = 1.0f + 0.3f * std::cos(v);
+            mesh.positions.push_back(
+                { r * std::cos(u), r * std::sin(u), 0.3f * std::sin(v) }
+            );
+        }
+    }
+    for (uint32 i = 0; i < major; i++) {
+        for (uint32 j = 0; j < minor; j++) {
+            const uint32 a = i * minor + j;
+            const uint32 b = ((i + 1) % major) * minor + j;
+            const uint32 c = i * minor + (j + 1) % minor;
+            const uint32 d = ((i + 1) % major) * minor + (j + 1) % minor;
+            for (const uint32 index : { a, b, c, c, b, d })
+                mesh.indices.push_back(index);
+        }
+    }
+    return mesh;
+}
+
+// One mesh per OBJ shape. Vertices are shared by corners with equal position,
+// normal and texture coordinate indices, as in mesh import
+bool create_obj_meshes(std::vector<Mesh>& meshes, const std::string& path) {
+    tinyobj::ObjReader reader;
+    if (!reader.ParseFromFile(path)) {
+        std::cerr << "TinyObjReader :: " << reader.Error() << std::endl;
+        return false;
+    }
+
+    const auto& vertices = reader.GetAttrib().vertices;
+    for (const auto& shape : reader.GetShapes()) {
+        if (shape.mesh.indices.empty()) continue;
+
+        Mesh mesh { shape.name };
+
+        std::map<std::tuple<int32, int32, int32>, uint32> unique {};
+        for (const auto& index : shape.mesh.indices) {
+            const auto key = std::make_tuple(
+                index.vertex_index, index.normal_index, index.texcoord_index
+            );
+            auto it = unique.find(key);
+            if (it == unique.end()) {
+                it = unique.insert({ key, mesh.positions.size() }).first;
+                mesh.positions.push_back(
+                    { vertices[3 * index.vertex_index + 0],
+                      vertices[3 * index.vertex_index + 1],
+                      vertices[3 * index.vertex_index + 2] }
+                );
+            }
+            mesh.indices.push_back(it->second);
+        }
+        meshes.push_back(mesh);
+    }
+    return !meshes.empty();
+}
+
+// /////////// //
+// MEASUREMENT //
+// /////////// //
+
+struct Level {
+    uint64  triangles;
+    float32 error;
+};
+
+// Levels of detail of a mesh, as generated by mesh import
+std::vector<Level> generate_lods(const Mesh& mesh) {
+    std::vector<Level> levels { { mesh.indices.size() / 3, 0.0f } };
+    MeshSimplifier     simplifier { mesh.positions, mesh.indices };
+    float32            max_error = lod_max_error;
+    while (levels.size() < lod_count) {
+        const uint64 index_count = simplifier.indices().size();
+        if (index_count / 3 < min_lod_triangle_count) break;
+
+        simplifier.simplify(index_count / 2, max_error);
+        if (simplifier.indices().size() > index_count * 3 / 4) break;
+
+        levels.push_back(
+            { simplifier.indices().size() / 3, simplifier.error() }
+        );
+        max_error *= 2.0f;
+    }
+    return levels;
+}
+
+nlohmann::json benchmark(const Mesh& mesh, const uint32 repetitions) {
+    std::vector<double> durations;
+    std::vector<Level>  levels;
+    for (uint32 i = 0; i < repetitions; i++) {
+        const auto start = Clock::now();
+        levels           = generate_lods(mesh);
+        durations.push_back(elapsed_ns(start));
+    }
+    const double min_ns =
+        *std::min_element(durations.begin(), durations.end());
+    const double median_ns = median(durations);
+    const uint64 triangles = mesh.indices.size() / 3;
+
+    nlohmann::json lods = nlohmann::json::array();
+    for (const auto& level : levels)
+        lods.push_back({ { "triangles", level.triangles },
+                         { "ratio", (double) level.triangles / triangles },
+                         { "error", level.error } });
+
+    return { { "mesh", mesh.name },
+             { "vertices", mesh.positions.size() },
+             { "triangles", triangles },
+             { "total_ms", median_ns * 1e-6 },
+             { "ns_per_triangle", median_ns / triangles },
+             { "min_ms", min_ns * 1e-6 },
+             { "lods", lods } };
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint32      repetitions = 5;
+    uint32      resolution  = 128;
+    std::string obj_path;
+
+    for (int i = 1; i < argc; i++) {
+        std::string value;
+        if (parse_argument(argv[i], "repetitions", value))
+            repetitions = std::max(std::stoul(value), 1ul);
+        else if (parse_argument(argv[i], "resolution", value))
+            resolution = std::max(std::stoul(value), 4ul);
+        else if (parse_argument(argv[i], "obj", value)) obj_path = value;
+        else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--repetitions=N] [--resolution=N] [--obj=PATH]"
+                      << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::vector<Mesh> meshes;
+    if (obj_path.empty())
+        meshes = { create_sphere(resolution),
+                   create_terrain(2 * resolution),
+                   create_torus(resolution) };
+    else if (!create_obj_meshes(meshes, obj_path)) return EXIT_FAILURE;
+
+    nlohmann::json results = nlohmann::json::array();
+    for (const auto& mesh : meshes)
+        results.push_back(benchmark(mesh, repetitions));
+
+    const nlohmann::json output = {
+        { "meshes", obj_path.empty() ? "synthetic" : obj_path },
+        { "repetitions", repetitions },
+        { "results", results }
+    };
+    std::cout << output.dump(4) << std::endl;
+
+    return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,291 @@
+#include "component/occlusion_buffer.hpp"
+#include "component/frustum.hpp"
+#include "multithreading/parallel.hpp"
+#include "benchmark_support.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+/**
+ * Occlusion culling microbenchmark. Builds a synthetic town (a grid of box
+ * buildings used as occluders, with many small props scattered in streets and
+ * behind buildings) viewed from street level, then measures occluder
+ * rasterization and box tests against the occlusion buffer, next to frustum
+ * culling alone. Numbers of boxes left visible by both are reported. Results
+ * are reported as JSON on standard output.
+ *
+ * Usage: OcclusionCullingBenchmark [--repetitions=N] [--workers=N]
+ *                                  [--boxes=N] [--width=N] [--height=N]
+ *                                  [--scenario=NAME]
+ */
+
+using namespace ENGINE_NAMESPACE;
+
+namespace {
+
+// Minimal number of boxes tested by a single job (as in render views)
+constexpr uint64  test_grain     = 1024;
+// Town layout, a grid of blocks with one building each
+constexpr uint32  block_count    = 16;
+constexpr float32 block_size     = 40.0f;
+constexpr float32 street_width   = 10.0f;
+constexpr uint32  occluder_count = 16;
+
+// ///// //
+// SCENE //
+// ///// //
+
+struct Scene {
+    // Unit cube, scaled and placed by building model matrices
+    Vector<glm::vec3>      cube_vertices;
+    Vector<uint32>         cube_indices;
+    std::vector<glm::mat4> buildings;
+    // Buildings closest to the camera
+    std::vector<glm::mat4> occluders;
+
+    BBoxArray          bounds;
+    std::vector<uint8> visible;
+    glm::mat4          view_projection;
+    Frustum            frustum;
+    OcclusionBuffer    buffer;
+
+    Scene(const uint64 box_count, const uint32 width, const uint32 height)
+        : view_projection(camera_view_projection()), frustum(view_projection),
+          buffer(width, height) {
+        for (uint32 i = 0; i < 8; i++)
+            cube_vertices.push_back(
+                { (i & 1) ? 0.5f : -0.5f,
+                  (i & 2) ? 0.5f : -0.5f,
+                  (i & 4) ? 0.5f : -0.5f }
+            );
+        // Two triangles per cube face, given by its 4 corners
+        const uint32 faces[6][4] { { 0, 1, 3, 2 }, { 4, 6, 7, 5 },
+                                   { 0, 4, 5, 1 }, { 2, 3, 7, 6 },
+                                   { 0, 2, 6, 4 }, { 1, 5, 7, 3 } };
+        for (const auto& face : faces)
+            for (const uint32 corner : { face[0], face[1], face[2],
+                                         face[0], face[2], face[3] })
+                cube_indices.push_back(corner);
+
+        std::mt19937                            random { 0x5eed };
+        std::uniform_real_distribution<float32> height_range { 10.0f, 60.0f };
+        std::uniform_real_distribution<float32> unit { 0.0f, 1.0f };
+        std::uniform_real_distribution<float32> size { 0.2f, 1.0f };
+
+        // Buildings fill their block, leaving streets in between
+        const float32 town_size = block_count * block_size;
+        for (uint32 y = 0; y < block_count; y++) {
+            for (uint32 x = 0; x < block_count; x++) {
+                const float32   building = block_size - street_width;
+                const float32   height   = height_range(random);
+                const glm::vec3 center { (x + 0.5f) * block_size,
+                                         (y + 0.5f) * block_size,
+                                         height * 0.5f };
+                auto            matrix =
+                    glm::translate(glm::identity<glm::mat4>(), center);
+                matrix = glm::scale(matrix, { building, building, height });
+                buildings.push_back(matrix);
+            }
+        }
+
+        // Props placed anywhere in town, on the ground
+        bounds.resize(box_count);
+        for (uint64 i = 0; i < box_count; i++) {
+            const glm::vec3 half { size(random), size(random), size(random) };
+            const glm::vec3 center { unit(random) * town_size,
+                                     unit(random) * town_size,
+                                     half.z };
+            bounds.set(i, AxisAlignedBBox<3>(center - half, center + half));
+        }
+        visible = std::vector<uint8>(box_count, 0);
+
+        // Occluders are the buildings closest to the camera
+        const auto                              position = camera_position();
+        std::vector<std::pair<float32, uint32>> distances;
+        for (uint32 i = 0; i < buildings.size(); i++) {
+            const glm::vec3 center { buildings[i][3] };
+            distances.push_back({ glm::distance(center, position), i });
+        }
+        std::sort(distances.begin(), distances.end());
+        for (uint32 i = 0; i < occluder_count; i++)
+            occluders.push_back(buildings[distances[i].second]);
+    }
+
+    // Camera stands in a street at eye height, looking along it
+    static glm::vec3 camera_position() {
+        return { block_size, block_count * block_size * 0.5f, 1.7f };
+    }
+    static glm::mat4 camera_view_projection() {
+        const auto position   = camera_position();
+        const auto projection = glm::perspective(
+            glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 1000.0f
+        );
+        const auto view       = glm::lookAt(
+            position, position + glm::vec3(1, 0, 0), glm::vec3(0, 0, 1)
+        );
+        return projection * view;
+    }
+
+    void cull_frustum() {
+        frustum.cull(bounds, 0, bounds.size(), visible.data());
+    }
+
+    void rasterize() {
+        buffer.begin(view_projection);
+        for (const auto& occluder : occluders)
+            buffer.add_occluder(cube_vertices, cube_indices, occluder);
+        buffer.rasterize();
+    }
+
+    // As render views test, split into chunks across workers
+    void test() {
+        Parallel::for_loop(
+            { 0, bounds.size() },
+            test_grain,
+            [this](const Parallel::Range chunk) {
+                buffer.test(bounds, chunk.begin, chunk.end, visible.data());
+            }
+        );
+    }
+
+    uint64 visible_count() const {
+        return std::count(visible.begin(), visible.end(), 1);
+    }
+};
+
+// ///////// //
+// SCENARIOS //
+// ///////// //
+
+struct Scenario {
+    std::string                   name;
+    // Number of processed items (triangles or boxes) per run
+    std::function<uint64(Scene&)> item_count;
+    std::function<void(Scene&)>   run;
+};
+
+uint64 box_count(Scene& scene) { return scene.bounds.size(); }
+uint64 triangle_count(Scene& scene) { return scene.buffer.triangle_count(); }
+
+// Frustum culling alone, as a reference
+void cull_frustum(Scene& scene) { scene.cull_frustum(); }
+
+// Occluder setup and rasterization, including depth hierarchy construction
+void rasterize(Scene& scene) { scene.rasterize(); }
+
+// Box tests against an already rasterized buffer
+void test(Scene& scene) {
+    scene.cull_frustum();
+    scene.test();
+}
+
+// Whole occlusion culling pass, as done by perspective render views
+void cull_occluded(Scene& scene) {
+    scene.cull_frustum();
+    scene.rasterize();
+    scene.test();
+}
+
+std::vector<Scenario> create_scenarios() {
+    return {
+        { "cull_frustum", box_count, cull_frustum },
+        { "rasterize", triangle_count, rasterize },
+        { "test", box_count, test },
+        { "cull_occluded", box_count, cull_occluded },
+    };
+}
+
+// /////////// //
+// MEASUREMENT //
+// /////////// //
+
+nlohmann::json benchmark(
+    const Scenario& scenario, Scene& scene, const uint32 repetitions
+) {
+    // Warm up caches and worker threads
+    scenario.run(scene);
+
+    std::vector<double> durations;
+    for (uint32 i = 0; i < repetitions; i++) {
+        const auto start = Clock::now();
+        scenario.run(scene);
+        durations.push_back(elapsed_ns(start));
+    }
+    const double min_ns =
+        *std::min_element(durations.begin(), durations.end());
+    const double median_ns = median(durations);
+    const uint64 count     = scenario.item_count(scene);
+
+    return { { "scenario", scenario.name },
+             { "count", count },
+             { "visible", scene.visible_count() },
+             { "total_ms", median_ns * 1e-6 },
+             { "ns_per_item", median_ns / count },
+             { "min_ms", min_ns * 1e-6 } };
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint32      repetitions = 9;
+    uint32      workers     = 0;
+    uint64      box_count   = 100000;
+    uint32      width       = 256;
+    uint32      height      = 128;
+    std::string scenario_filter;
+
+    for (int i = 1; i < argc; i++) {
+        std::string value;
+        if (parse_argument(argv[i], "repetitions", value))
+            repetitions = std::max(std::stoul(value), 1ul);
+        else if (parse_argument(argv[i], "workers", value))
+            workers = std::stoul(value);
+        else if (parse_argument(argv[i], "boxes", value))
+            box_count = std::max(std::stoul(value), 1ul);
+        else if (parse_argument(argv[i], "width", value))
+            width = std::max(std::stoul(value), 1ul);
+        else if (parse_argument(argv[i], "height", value))
+            height = std::max(std::stoul(value), 1ul);
+        else if (parse_argument(argv[i], "scenario", value))
+            scenario_filter = value;
+        else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--repetitions=N] [--workers=N] [--boxes=N]"
+                         " [--width=N] [--height=N] [--scenario=NAME]"
+                      << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    JobSystem::initialize(workers);
+
+    Scene scene { box_count, width, height };
+    // Buffer is rasterized once up front, for scenarios only testing boxes
+    scene.rasterize();
+
+    nlohmann::json results = nlohmann::json::array();
+    for (const auto& scenario : create_scenarios()) {
+        if (!scenario_filter.empty() && scenario.name != scenario_filter)
+            continue;
+        results.push_back(benchmark(scenario, scene, repetitions));
+    }
+
+    const nlohmann::json output = {
+        { "workers", JobSystem::worker_count() },
+        { "width", scene.buffer.width() },
+        { "height", scene.buffer.height() },
+        { "occluders", scene.occluders.size() },
+        { "repetitions", repetitions },
+        { "results", results }
+    };
+    std::cout << output.dump(4) << std::endl;
+
+    JobSystem::shutdown();
+    return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -11,6 +11,8 @@ class Delegate {
   public:
     std::size_t owner = 0;
 
+    virtual ~Delegate() {}
+
     virtual R call([[maybe_unused]] Args... arguments) { return {}; }
 
     template<typename R1, typename... Args1>
@@ -24,6 +26,8 @@ class Delegate<void, Args...> {
   public:
     std::size_t owner = 0;
 
+    virtual ~Delegate() {}
+
     virtual void call([[maybe_unused]] Args... arguments) {}
 
     template<typename R1, typename... Args1>
@@ -86,8 +90,12 @@ bool operator==(
     auto function1 = dynamic_cast<DelegateFunction<R, Args...>*>(&delegate1);
     auto function2 = dynamic_cast<DelegateFunction<R, Args...>*>(&delegate2);
 
-    if (function1->_callback == function2->_callback) return true;
-    return false;
+    // Function objects aren't comparable, only plain function pointers are
+    typedef R (*Function)(Args...);
+    const auto target1 = function1->_callback.template target<Function>();
+    const auto target2 = function2->_callback.template target<Function>();
+    if (target1 == nullptr || target2 == nullptr) return false;
+    return *target1 == *target2;
 }
 
 } // namespace ENGINE_NAMESPACE
\ No newline at end of file
@@ -1,7 +1,7 @@
 #pragma once
 
 #include "delegate.hpp"
-#include "vector.hpp"
+#include "small_vector.hpp"
 #include "outcome.hpp"
 
 namespace ENGINE_NAMESPACE {
@@ -19,11 +19,18 @@ class Event;
 template<typename R, typename... Args>
 class Event<R(Args...)> {
   private:
-    Vector<Delegate<R, Args...>*> _callbacks {};
+    SmallVector<Delegate<R, Args...>*, 4> _callbacks {};
 
   public:
     Event() {}
-    ~Event() {}
+    ~Event() {
+        for (auto callback : _callbacks)
+            del(callback);
+    }
+
+    // Delegates are owned, copies would free them twice
+    Event(const Event&)            = delete;
+    Event& operator=(const Event&) = delete;
 
     /**
      * @brief Subscribe to an event.
@@ -37,7 +44,8 @@ class Event<R(Args...)> {
      */
     template<typename T>
     void subscribe(T* caller, R (T::*callback)(Args...)) {
-        auto delegate = DelegateMethod<T, R, Args...>(caller, callback);
+        auto delegate = new (MemoryTag::Callback)
+            DelegateMethod<T, R, Args...>(caller, callback);
         _callbacks.emplace_back(delegate);
     }
     /**
@@ -64,8 +72,7 @@ class Event<R(Args...)> {
      */
     template<typename T>
     Outcome unsubscribe(T* caller, R (T::*callback)(Args...)) {
-        auto delegate = new (MemoryTag::Callback)
-            DelegateMethod<T, R, Args...>(caller, callback);
+        auto delegate = DelegateMethod<T, R, Args...>(caller, callback);
         return remove_delegate(_callbacks, delegate);
     }
 
@@ -78,8 +85,7 @@ class Event<R(Args...)> {
      * @return false - if no such function was found
      */
     Outcome unsubscribe(std::function<R(Args...)> callback) {
-        auto delegate =
-            new (MemoryTag::Callback) DelegateFunction<R, Args...>(callback);
+        auto delegate = DelegateFunction<R, Args...>(callback);
         return remove_delegate(_callbacks, delegate);
     }
 
@@ -116,11 +122,18 @@ class Event<R(Args...)> {
 template<typename... Args>
 class Event<void(Args...)> {
   private:
-    Vector<Delegate<void, Args...>*> _callbacks {};
+    SmallVector<Delegate<void, Args...>*, 4> _callbacks {};
 
   public:
     Event() {}
-    ~Event() {}
+    ~Event() {
+        for (auto callback : _callbacks)
+            del(callback);
+    }
+
+    // Delegates are owned, copies would free them twice
+    Event(const Event&)            = delete;
+    Event& operator=(const Event&) = delete;
 
     /**
      * @brief Subscribe to an event.
@@ -162,8 +175,7 @@ class Event<void(Args...)> {
      */
     template<typename T>
     Outcome unsubscribe(T* caller, void (T::*callback)(Args...)) {
-        auto delegate = new (MemoryTag::Callback)
-            DelegateMethod<T, void, Args...>(caller, callback);
+        auto delegate = DelegateMethod<T, void, Args...>(caller, callback);
         return remove_delegate(_callbacks, delegate);
     }
 
@@ -176,8 +188,7 @@ class Event<void(Args...)> {
      * @return false - if no such function was found
      */
     Outcome unsubscribe(std::function<void(Args...)> callback) {
-        auto delegate =
-            new (MemoryTag::Callback) DelegateFunction<void, Args...>(callback);
+        auto delegate = DelegateFunction<void, Args...>(callback);
         return remove_delegate(_callbacks, delegate);
     }
 
@@ -201,19 +212,20 @@ class Event<void(Args...)> {
     inline void operator()(Args... arguments) { return invoke(arguments...); }
 };
 
-template<typename R, typename... Args>
+template<typename R, typename... Args, uint64 N>
 Outcome remove_delegate(
-    Vector<Delegate<R, Args...>*> callbacks, Delegate<R, Args...>* delegate
+    SmallVector<Delegate<R, Args...>*, N>& callbacks,
+    Delegate<R, Args...>&                  delegate
 ) {
     auto iter = callbacks.begin();
     while (iter != callbacks.end()) {
-        if (**iter == *delegate) break;
+        if (**iter == delegate) break;
         iter++;
     }
     if (iter == callbacks.end()) return Outcome::Failed;
 
-    callbacks.erase(iter);
     del(*iter);
+    callbacks.erase(iter);
 
     return Outcome::Successful;
 }
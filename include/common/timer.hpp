@@ -14,6 +14,9 @@ class Timer {
     void reset();
     void time(const String& message);
 
+    /// @brief True if timings are currently logged
+    bool is_running() const { return _running; }
+
     // TODO: most likely temporary for now
     static Timer global_timer;
 
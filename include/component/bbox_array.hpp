@@ -0,0 +1,105 @@
+#pragma once
+
+#include "axis_aligned_bbox.hpp"
+#include "vector.hpp"
+
+namespace ENGINE_NAMESPACE {
+
+/**
+ * @brief List of 3D axis-aligned bounding boxes stored as a structure of
+ * arrays. Each box is kept as its center and half extent, with one array per
+ * component, so that consecutive boxes can be loaded together into SIMD
+ * registers (see @p Frustum::cull()).
+ */
+class BBoxArray {
+  public:
+    typedef AxisAlignedBBox<3> BBox;
+
+    // Box centers
+    Vector<float32> center_x {};
+    Vector<float32> center_y {};
+    Vector<float32> center_z {};
+    // Box half extents (half of box size along each axis)
+    Vector<float32> half_x {};
+    Vector<float32> half_y {};
+    Vector<float32> half_z {};
+
+    BBoxArray() {}
+    ~BBoxArray() {}
+
+    /// @brief Number of boxes
+    uint64 size() const { return center_x.size(); }
+
+    /// @brief Resize to @p size boxes. Memory is kept when shrinking
+    void resize(const uint64 size) {
+        center_x.resize(size);
+        center_y.resize(size);
+        center_z.resize(size);
+        half_x.resize(size);
+        half_y.resize(size);
+        half_z.resize(size);
+    }
+
+    /// @brief Get box at a given index
+    BBox get(const uint64 index) const {
+        const glm::vec3 center { center_x[index],
+                                 center_y[index],
+                                 center_z[index] };
+        const glm::vec3 half { half_x[index], half_y[index], half_z[index] };
+        return BBox(center - half, center + half);
+    }
+
+    /// @brief Set box at a given index
+    void set(const uint64 index, const BBox& bbox) {
+        const auto center = (bbox.max + bbox.min) * 0.5f;
+        const auto half   = (bbox.max - bbox.min) * 0.5f;
+        center_x[index]   = center.x;
+        center_y[index]   = center.y;
+        center_z[index]   = center.z;
+        half_x[index]     = half.x;
+        half_y[index]     = half.y;
+        half_z[index]     = half.z;
+    }
+
+    /// @brief Set box at a given index to a box of another array
+    void set(const uint64 index, const BBoxArray& other, const uint64 from) {
+        center_x[index] = other.center_x[from];
+        center_y[index] = other.center_y[from];
+        center_z[index] = other.center_z[from];
+        half_x[index]   = other.half_x[from];
+        half_y[index]   = other.half_y[from];
+        half_z[index]   = other.half_z[from];
+    }
+
+    /**
+     * @brief Set box at a given index to the smallest box containing
+     * @p bbox transformed by @p transform. Same box as the one computed by
+     * @p AxisAlignedBBox::get_transformed().
+     * @param index Index of the set box
+     * @param bbox Box in local space
+     * @param transform Transformation from local space (e.g. model matrix)
+     */
+    void set_transformed(
+        const uint64 index, const BBox& bbox, const glm::mat4& transform
+    ) {
+        const auto local_center = (bbox.max + bbox.min) * 0.5f;
+        const auto local_half   = (bbox.max - bbox.min) * 0.5f;
+
+        // Center is transformed as a point, while half extent is projected
+        // onto each axis through absolute values of the rotation & scale
+        const auto center =
+            glm::vec3(transform * glm::vec4(local_center, 1.0f));
+        const auto half = glm::abs(glm::vec3(transform[0])) * local_half.x +
+                          glm::abs(glm::vec3(transform[1])) * local_half.y +
+                          glm::abs(glm::vec3(transform[2])) * local_half.z;
+
+        center_x[index] = center.x;
+        center_y[index] = center.y;
+        center_z[index] = center.z;
+        half_x[index]   = half.x;
+        half_y[index]   = half.y;
+        half_z[index]   = half.z;
+    }
+};
+
+} // namespace ENGINE_NAMESPACE
\ No newline at end of file
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "frustum.hpp"
+#include "ray.hpp"
+
+namespace ENGINE_NAMESPACE {
+
+/**
+ * @brief Bounding volume hierarchy over a list of 3D boxes (e.g. world space
+ * bounds of geometries). Built top down, with splits chosen by binned surface
+ * area heuristic (SAH). Moving boxes are handled by refitting node bounds,
+ * while the tree is rebuilt once refitting degraded it too much (see
+ * @p update()). Queries report indices of boxes in the array the tree was
+ * built over.
+ */
+class BVH {
+  public:
+    typedef AxisAlignedBBox<3> BBox;
+
+    /// @brief Maximal number of boxes in a leaf
+    static constexpr uint32 max_leaf_size = 4;
+    /// @brief Number of bins per axis in which split candidates are evaluated
+    static constexpr uint32 bin_count     = 16;
+
+    /**
+     * @brief Tree node (32 bytes). Leaves reference @p count boxes starting
+     * at @p first in tree order, while inner nodes (count of 0) have their two
+     * children at indices @p first and @p first + 1. Children are always
+     * stored after their parent.
+     */
+    struct Node {
+        float32 min[3];
+        uint32  first;
+        float32 max[3];
+        uint32  count;
+
+        bool is_leaf() const { return count != 0; }
+    };
+
+    BVH() {}
+    ~BVH() {}
+
+    /// @brief Number of boxes in the tree
+    uint64 size() const { return _indices.size(); }
+    /// @brief Number of tree nodes
+    uint64 node_count() const { return _nodes.size(); }
+    /**
+     * @brief SAH cost of the tree, i.e. expected number of node and box tests
+     * performed by a query hitting the root box
+     */
+    float32 cost() const { return _cost; }
+
+    /**
+     * @brief Build tree from scratch
+     * @param bounds Bounds of all boxes in the tree
+     */
+    void build(const BBoxArray& bounds);
+    /**
+     * @brief Update node bounds for moved boxes, keeping tree structure. Tree
+     * quality degrades as boxes move away from their original position.
+     * @param bounds New bounds of all boxes. Box count can't change
+     */
+    void refit(const BBoxArray& bounds);
+    /**
+     * @brief Refit the tree, or rebuild it if box count changed or refitting
+     * increased its cost by more than a given factor since the last build.
+     * @param bounds New bounds of all boxes
+     * @param rebuild_threshold Allowed cost increase (def = 1.5)
+     * @return True if the tree was rebuilt
+     */
+    bool update(
+        const BBoxArray& bounds, const float32 rebuild_threshold = 1.5f
+    );
+
+    /**
+     * @brief Find boxes contained in or intersecting a given frustum. Subtrees
+     * fully within the frustum are reported without further testing.
+     * @param frustum Tested frustum
+     * @param result Indices of found boxes are appended to it
+     */
+    void cull(const Frustum& frustum, Vector<uint32>& result) const;
+    /**
+     * @brief Find boxes overlapping a given box
+     * @param bbox Tested box
+     * @param result Indices of found boxes are appended to it
+     */
+    void query_box(const BBox& bbox, Vector<uint32>& result) const;
+    /**
+     * @brief Find boxes hit by a given ray within [min_t, max_t]
+     * @param ray Tested ray
+     * @param result Indices of found boxes are appended to it
+     */
+    void query_ray(const Ray<3>& ray, Vector<uint32>& result) const;
+    /**
+     * @brief Find the box a given ray hits first within [min_t, max_t]
+     * @param ray Cast ray
+     * @param index Index of the hit box. Unchanged if nothing was hit
+     * @param t Ray param at which the box was hit. Unchanged if nothing was
+     * hit
+     * @return True if any box was hit
+     */
+    bool ray_cast(const Ray<3>& ray, uint32& index, float32& t) const;
+
+  private:
+    Vector<Node>   _nodes {};
+    // Box index for each tree position, leaves reference ranges of it
+    Vector<uint32> _indices {};
+    // Box bounds in tree order, so leaf boxes are tested from continuous memory
+    BBoxArray      _bounds {};
+
+    float32 _cost       = 0.0f;
+    float32 _built_cost = 0.0f;
+};
+
+} // namespace ENGINE_NAMESPACE
\ No newline at end of file
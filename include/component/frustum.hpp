@@ -1,6 +1,6 @@
 #pragma once
 
-#include "axis_aligned_bbox.hpp"
+#include "bbox_array.hpp"
 
 namespace ENGINE_NAMESPACE {
 
@@ -47,8 +47,22 @@ class Frustum {
         const float32   near,
         const float32   far
     );
+    /**
+     * @brief Construct a new Frustum object bounding the clip volume of a given
+     * transformation (e.g. orthographic volume of a light). Clip space depth
+     * is expected in range [0, 1].
+     * @param view_projection Transformation from world to clip space
+     */
+    Frustum(const glm::mat4& view_projection);
     ~Frustum();
 
+    /**
+     * @brief Move near plane away from the far one, extending the frustum
+     * (e.g. towards a light, to keep casters in front of the shadow volume).
+     * @param distance Distance by which the plane moves. Can be infinite
+     */
+    void extend_near_plane(const float32 distance);
+
     /**
      * @brief Check whether this frustum contains or intersects a given
      * axis-aligned bounding box.
@@ -60,6 +74,36 @@ class Frustum {
         return true;
     }
 
+    /// @brief Position of a box relative to the frustum
+    enum class Containment { Outside, Intersects, Inside };
+
+    /**
+     * @brief Classify a box against this frustum. Unlike with @p contains(),
+     * boxes fully within the frustum are told apart from intersecting ones
+     * (e.g. for hierarchical culling).
+     * @param center Box center
+     * @param half Box half extent
+     */
+    Containment classify(const glm::vec3& center, const glm::vec3& half) const;
+
+    /**
+     * @brief Check which of the boxes [begin, end) of a given box array this
+     * frustum contains or intersects. Same test as @p contains(), performed
+     * for several boxes at once with SIMD instructions (8 with AVX, 4 with
+     * SSE). Disjoint ranges of the same array can be culled concurrently.
+     * @param boxes Tested boxes
+     * @param begin Index of the first tested box
+     * @param end Index one past the last tested box
+     * @param visible Output indexed by box index. Set to 1 for visible boxes,
+     * 0 for the others
+     */
+    void cull(
+        const BBoxArray& boxes,
+        const uint64     begin,
+        const uint64     end,
+        uint8* const     visible
+    ) const;
+
   private:
     std::array<Plane, 6> _sides {};
 };
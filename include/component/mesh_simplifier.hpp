@@ -0,0 +1,112 @@
+#pragma once
+
+#include "vector.hpp"
+
+namespace ENGINE_NAMESPACE {
+
+/**
+ * @brief Triangle mesh simplification by quadric error metrics (Garland and
+ * Heckbert). Edges are collapsed into one of their end points, cheapest first,
+ * so simplified meshes index the original vertices and all levels of detail of
+ * a mesh can share its vertex buffer. Vertices at the same position (split by
+ * texture or normal seams) collapse together and only along their seam, while
+ * open borders stay in place. Simplification is progressive, each call
+ * continues from the result of the previous one.
+ */
+class MeshSimplifier {
+  public:
+    /**
+     * @brief Construct a new Mesh Simplifier object
+     * @param positions Vertex positions
+     * @param indices Triangle list indices into @p positions
+     */
+    MeshSimplifier(
+        const Vector<glm::vec3>& positions, const Vector<uint32>& indices
+    );
+    ~MeshSimplifier();
+
+    /// @brief Triangle list indices of the simplified mesh, into the original
+    /// vertices
+    const Vector<uint32>& indices() const { return _indices; }
+    /// @brief Largest distance of a collapsed vertex from the original surface
+    /// (as estimated by its quadric), relative to mesh size
+    float32 error() const { return _error; }
+
+    /**
+     * @brief Collapse edges until the mesh has at most a given number of
+     * indices left. Each pass collapses a set of edges not sharing any
+     * triangle, so that each collapse is validated against the current mesh.
+     * Collapses which would flip a triangle or change mesh topology aren't
+     * done.
+     * @param target_index_count Number of indices to reach
+     * @param max_error Largest error allowed, relative to mesh size (diagonal
+     * of its bounding box)
+     * @return Whether the target was reached. Otherwise, no edge could be
+     * collapsed within @p max_error
+     */
+    bool simplify(const uint64 target_index_count, const float32 max_error);
+
+  private:
+    // Sum of squared distances to a set of planes, weighted by their area, as
+    // a symmetric 4x4 matrix
+    struct Quadric {
+        float64 a00 = 0.0, a11 = 0.0, a22 = 0.0;
+        float64 a01 = 0.0, a02 = 0.0, a12 = 0.0;
+        float64 b0 = 0.0, b1 = 0.0, b2 = 0.0;
+        float64 c      = 0.0;
+        float64 weight = 0.0;
+
+        void add(const Quadric& other);
+        void add_plane(
+            const glm::dvec3& normal,
+            const float64     distance,
+            const float64     weight
+        );
+        // Mean squared distance of a point to the planes
+        float64 error(const glm::dvec3& point) const;
+    };
+    struct Collapse {
+        float64 cost;
+        uint32  from;
+        uint32  to;
+    };
+
+    float64 _size  = 1.0;
+    float32 _error = 0.0f;
+
+    Vector<glm::vec3> _positions {};
+    Vector<uint32>    _indices {};
+    // Vertices at the same position form a circular list, the first of them
+    // stands for all of them (as a welded vertex)
+    Vector<uint32>    _welded {};
+    Vector<uint32>    _next_twin {};
+    // Indexed by welded vertex
+    Vector<Quadric>   _quadrics {};
+
+    // State of a single pass. Triangles around each welded vertex are listed
+    // from its offset on, edges between welded vertices are sorted
+    Vector<uint32>                    _remap {};
+    Vector<uint32>                    _triangle_offsets {};
+    Vector<uint32>                    _triangles {};
+    Vector<uint64>                    _edges {};
+    Vector<uint8>                     _flags {};
+    Vector<Collapse>                  _collapses {};
+    Vector<uint32>                    _ring {};
+    Vector<uint32>                    _other_ring {};
+    Vector<std::pair<uint32, uint32>> _twin_targets {};
+
+    void   build_adjacency();
+    void   collect_edges();
+    void   add_border_quadrics();
+    void   add_collapse(const uint32 from, const uint32 to, const float64 max);
+    uint64 collapse(const uint32 from, const uint32 to);
+    void   compact_indices();
+
+    bool   has_edge(const uint32 from, const uint32 to) const;
+    bool   has_vertex(const uint32 triangle, const uint32 vertex) const;
+    void   get_ring(
+        const uint32 vertex, const uint32 other, Vector<uint32>& ring
+    ) const;
+};
+
+} // namespace ENGINE_NAMESPACE
\ No newline at end of file
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "bbox_array.hpp"
+
+namespace ENGINE_NAMESPACE {
+
+/**
+ * @brief Low resolution depth buffer for occlusion culling on the CPU.
+ * Triangles of a few large occluders are rasterized into it (in horizontal
+ * bands, spread across job system workers, 4 pixels at a time with SSE),
+ * after which a hierarchy of its maximal depths is built. Boxes are then
+ * tested against this hierarchy, with the smallest of its levels covering a
+ * box in at most 3x3 texels. Tests are conservative, boxes are only ever
+ * culled if they are fully behind rasterized occluders.
+ */
+class OcclusionBuffer {
+  public:
+    /**
+     * @brief Construct a new Occlusion Buffer object
+     * @param width Width in pixels. Rounded up to a multiple of 4
+     * @param height Height in pixels
+     */
+    OcclusionBuffer(const uint32 width = 256, const uint32 height = 128);
+    ~OcclusionBuffer();
+
+    /// @brief Buffer width in pixels
+    uint32 width() const { return _width; }
+    /// @brief Buffer height in pixels
+    uint32 height() const { return _height; }
+    /// @brief Number of triangles added since the last @p begin()
+    uint64 triangle_count() const { return _triangles.size(); }
+
+    /**
+     * @brief Clear the buffer and start a new set of occluders
+     * @param view_projection Transformation from world to clip space
+     */
+    void begin(const glm::mat4& view_projection);
+    /**
+     * @brief Add an occluder mesh. Triangles are transformed to screen space
+     * and clipped by the near plane, but are only rasterized by
+     * @p rasterize().
+     * @param vertices Vertex positions in model space
+     * @param indices Triangle list indices into @p vertices
+     * @param model Transformation from model to world space
+     */
+    void add_occluder(
+        const Vector<glm::vec3>& vertices,
+        const Vector<uint32>&    indices,
+        const glm::mat4&         model
+    );
+    /**
+     * @brief Rasterize all added occluders and build the depth hierarchy.
+     * Bands of the buffer are rasterized concurrently by job system workers.
+     */
+    void rasterize();
+
+    /**
+     * @brief Check whether a world space box could be visible, i.e. isn't
+     * fully hidden behind the rasterized occluders
+     * @param center Box center
+     * @param half Box half extent
+     */
+    bool is_visible(const glm::vec3& center, const glm::vec3& half) const;
+    /**
+     * @brief Test boxes [begin, end) of a given box array still marked as
+     * visible, clearing the mark of those hidden behind the occluders.
+     * Disjoint ranges can be tested concurrently.
+     * @param boxes Tested boxes
+     * @param begin Index of the first tested box
+     * @param end Index one past the last tested box
+     * @param visible Visibility indexed by box index, e.g. computed by
+     * @p Frustum::cull()
+     */
+    void test(
+        const BBoxArray& boxes,
+        const uint64     begin,
+        const uint64     end,
+        uint8* const     visible
+    ) const;
+
+    /// @brief Rasterized depth of a given pixel (infinity if not covered)
+    float32 depth(const uint32 x, const uint32 y) const {
+        return _levels[0][(uint64) y * _width + x];
+    }
+
+  private:
+    // Triangle set up for rasterization, in pixel coordinates
+    struct Triangle {
+        // Edge functions a * x + b * y + c, positive inside
+        float32 edge_a[3];
+        float32 edge_b[3];
+        float32 edge_c[3];
+        // Depth plane a * x + b * y + c
+        float32 depth_a;
+        float32 depth_b;
+        float32 depth_c;
+        // Covered pixel bounds, max exclusive
+        int32   min_x;
+        int32   min_y;
+        int32   max_x;
+        int32   max_y;
+    };
+
+    uint32    _width;
+    uint32    _height;
+    glm::mat4 _view_projection;
+
+    Vector<Triangle>        _triangles {};
+    // Clip space vertices of the occluder being added
+    Vector<glm::vec4>       _clip_vertices {};
+    // Depth buffer, followed by levels of maximal depths of 2x2 texels
+    Vector<Vector<float32>> _levels {};
+    Vector<glm::uvec2>      _level_sizes {};
+
+    void add_triangle(
+        const glm::vec4& a, const glm::vec4& b, const glm::vec4& c
+    );
+    void rasterize_band(const int32 begin_row, const int32 end_row);
+    void build_hierarchy();
+};
+
+} // namespace ENGINE_NAMESPACE
\ No newline at end of file
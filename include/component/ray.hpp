@@ -27,6 +27,19 @@ struct Ray {
     float32 max_t;
 
     Ray();
+    /**
+     * @brief Construct a new Ray object
+     * @param origin Origin location
+     * @param direction Direction of the ray (need not be normalized)
+     * @param min_t Minimal param position (def = 0)
+     * @param max_t Maximal param position (def = infinity)
+     */
+    Ray(
+        const Vector& origin,
+        const Vector& direction,
+        const float32 min_t = 0.0f,
+        const float32 max_t = Infinity32
+    );
     ~Ray();
 
     Vector operator()(const float32& t) { return origin + t * direction; }
@@ -35,4 +48,19 @@ struct Ray {
   private:
 };
 
+template<uint8 Dim>
+Ray<Dim>::Ray()
+    : origin(0.0f), direction(0.0f), min_t(0.0f), max_t(Infinity32) {}
+template<uint8 Dim>
+Ray<Dim>::Ray(
+    const Vector& origin,
+    const Vector& direction,
+    const float32 min_t,
+    const float32 max_t
+)
+    : origin(origin), direction(direction), min_t(min_t), max_t(max_t) {}
+
+template<uint8 Dim>
+Ray<Dim>::~Ray() {}
+
 } // namespace ENGINE_NAMESPACE
\ No newline at end of file
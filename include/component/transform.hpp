@@ -8,7 +8,9 @@ namespace ENGINE_NAMESPACE {
 /**
  * @brief Transform of objects in world. Holds data like position rotation and
  * scale. Can hold pointer to a parent whose transform this transform is
- * relative to.
+ * relative to. World matrix is cached, and invalidated together with world
+ * matrices of all children whenever this transform or one of its parents
+ * changes.
  */
 class Transform {
   public:
@@ -17,7 +19,7 @@ class Transform {
         GET { return _position; }
         SET {
             _position = value;
-            _is_dirty = true;
+            invalidate();
         }
     };
     /// @brief In world rotation
@@ -25,24 +27,21 @@ class Transform {
         GET { return _rotation; }
         SET {
             _rotation = value;
-            _is_dirty = true;
+            invalidate();
         }
     };
     /// @brief In world scale
     Property<glm::vec3> scale {
         GET { return _scale; }
         SET {
-            _scale    = value;
-            _is_dirty = true;
+            _scale = value;
+            invalidate();
         }
     };
     /// @brief Parent transform
     Property<Transform*> parent {
         GET { return _parent; }
-        SET {
-            _parent   = value;
-            _is_dirty = true;
-        }
+        SET { set_parent(value); }
     };
 
     /**
@@ -112,19 +111,38 @@ class Transform {
 
     /// @brief Get local transformation matrix of this transform
     glm::mat4 local();
-    /// @brief Get world transformation matrix of this transform
+    /// @brief Get world transformation matrix of this transform. Computed
+    /// only if this transform or any of its parents changed since last call
     glm::mat4 world();
 
+    /// @brief Number of changes in parent child relations of all transforms
+    /// so far. Lets structures built over transforms (see
+    /// @p TransformHierarchy) know when to rebuild
+    static uint64 structure_version() { return _structure_version; }
+
   private:
     glm::vec3 _position = {};
     glm::quat _rotation = glm::identity<glm::quat>();
     glm::vec3 _scale    = glm::vec3(1.0f);
 
-    bool _is_dirty = true;
+    bool _is_dirty       = true;
+    bool _is_world_dirty = true;
 
     glm::mat4 _local = glm::identity<glm::mat4>();
+    glm::mat4 _world = glm::identity<glm::mat4>();
 
+    // Children are kept in an intrusive list, so that dirtiness can propagate
     Transform* _parent {};
+    Transform* _first_child {};
+    Transform* _next_sibling {};
+
+    static uint64 _structure_version;
+
+    void set_parent(Transform* const parent);
+    void invalidate();
+    void invalidate_world();
+
+    friend class TransformHierarchy;
 };
 
 } // namespace ENGINE_NAMESPACE
\ No newline at end of file
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "transform.hpp"
+
+namespace ENGINE_NAMESPACE {
+
+/**
+ * @brief World matrices of a set of transforms (and of all their parents),
+ * kept contiguously in parent before child order. Each root transform is
+ * followed by all of its (relevant) descendants, so that subtrees occupy
+ * disjoint ranges and are updated concurrently by job system workers. Only
+ * outdated world matrices are recomputed, see @p Transform::world().
+ */
+class TransformHierarchy {
+  public:
+    TransformHierarchy() {}
+    ~TransformHierarchy() {}
+
+    /// @brief Number of transforms the hierarchy was built for
+    uint64 size() const { return _tree_positions.size(); }
+
+    /**
+     * @brief World matrix of a given transform as of the last @p update()
+     * @param index Index of the transform, in the list the hierarchy was
+     * built for
+     */
+    const glm::mat4& world(const uint64 index) const {
+        return _world_matrices[_tree_positions[index]];
+    }
+
+    /**
+     * @brief Build hierarchy for a given list of transforms and compute
+     * their world matrices. Rebuilt automatically by @p update() whenever
+     * parent of any transform changes.
+     * @param transforms Transforms whose world matrices are needed
+     */
+    void build(const Vector<Transform*>& transforms);
+    /**
+     * @brief Compute outdated world matrices of all transforms. Transforms
+     * shouldn't be accessed by other threads meanwhile.
+     */
+    void update();
+
+  private:
+    static constexpr uint32 no_parent = (uint32) -1;
+
+    // Transforms the hierarchy was built for
+    Vector<Transform*> _transforms {};
+    // Tree position of each of them
+    Vector<uint32>     _tree_positions {};
+
+    // Tree data, in parent before child order
+    Vector<Transform*> _nodes {};
+    Vector<uint32>     _parents {};
+    Vector<glm::mat4>  _world_matrices {};
+    // Tree position of each root, its subtree ends where the next one begins
+    Vector<uint32>     _roots {};
+
+    uint64 _structure_version = 0;
+};
+
+} // namespace ENGINE_NAMESPACE
\ No newline at end of file
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <algorithm>
+#include <new>
+#include <type_traits>
+
+#include "vector.hpp"
+
+namespace ENGINE_NAMESPACE {
+
+/**
+ * @brief Dynamic array whose storage memory compaction can move (see
+ * MemorySystem::compact()). Storage is allocated to the exact size and
+ * registered as relocatable, while the array updates its own pointer on each
+ * move. Meant for large data kept around unchanged after it's loaded (e.g.
+ * geometry data). Only trivially copyable elements are supported, as
+ * compaction moves raw bytes. Pointers and iterators into the array are
+ * invalidated by resizes and compaction.
+ *
+ * @tparam T Type of element
+ */
+template<typename T>
+class RelocatableArray {
+    static_assert(
+        std::is_trivially_copyable<T>::value,
+        "Only trivially copyable elements can be moved by compaction."
+    );
+
+  public:
+    typedef T        value_type;
+    typedef uint64   size_type;
+    typedef T&       reference;
+    typedef const T& const_reference;
+    typedef T*       iterator;
+    typedef const T* const_iterator;
+
+    /**
+     * @brief Construct a new empty Relocatable Array object
+     *
+     * @param tag Memory tag of the storage. Its allocator must support
+     * compaction
+     */
+    RelocatableArray(const MemoryTag tag = MemoryTag::Geometry)
+        : _allocator(tag) {}
+    RelocatableArray(
+        const Vector<T>& data, const MemoryTag tag = MemoryTag::Geometry
+    )
+        : _allocator(tag) {
+        assign(data.begin(), data.end());
+    }
+    RelocatableArray(const RelocatableArray& other)
+        : _allocator(other._allocator) {
+        assign(other.begin(), other.end());
+    }
+    RelocatableArray(RelocatableArray&& other) noexcept {
+        take(std::move(other));
+    }
+    ~RelocatableArray() { release(); }
+
+    RelocatableArray& operator=(const RelocatableArray& other) {
+        if (this == &other) return *this;
+        assign(other.begin(), other.end());
+        return *this;
+    }
+    RelocatableArray& operator=(RelocatableArray&& other) noexcept {
+        if (this == &other) return *this;
+        release();
+        take(std::move(other));
+        return *this;
+    }
+
+    // Access
+    T&       operator[](const uint64 index) { return _data[index]; }
+    const T& operator[](const uint64 index) const { return _data[index]; }
+    T*       data() { return _data; }
+    const T* data() const { return _data; }
+
+    // Iteration
+    iterator       begin() { return _data; }
+    iterator       end() { return _data + _size; }
+    const_iterator begin() const { return _data; }
+    const_iterator end() const { return _data + _size; }
+
+    // Capacity
+    uint64 size() const { return _size; }
+    bool   empty() const { return _size == 0; }
+
+    // Modifiers
+    /**
+     * @brief Resize to @p size elements, default constructing new ones.
+     * Storage is always reallocated to the exact size
+     */
+    void resize(const uint64 size) {
+        if (size == _size) return;
+        const auto kept = std::min(size, _size);
+        T* const   data = allocate(size);
+        std::copy(_data, _data + kept, data);
+        for (uint64 i = kept; i < size; i++)
+            new (data + i) T();
+        release();
+        adopt(data, size);
+    }
+
+    /// @brief Replace contents with elements in range [first, last)
+    template<typename Iterator>
+    void assign(const Iterator first, const Iterator last) {
+        const uint64 size = std::distance(first, last);
+        T* const     data = allocate(size);
+        std::copy(first, last, data);
+        release();
+        adopt(data, size);
+    }
+
+  private:
+    TAllocator<T> _allocator;
+    T*            _data = nullptr;
+    uint64        _size = 0;
+
+    T* allocate(const uint64 size) {
+        return (size == 0) ? nullptr : _allocator.allocate(size);
+    }
+    void release() {
+        if (_data != nullptr) _allocator.deallocate(_data, _size);
+        _data = nullptr;
+        _size = 0;
+    }
+    // Take ownership of storage, following it through compaction. Array has
+    // to stay at its address until storage is released or taken over
+    void adopt(T* const data, const uint64 size) {
+        _data = data;
+        _size = size;
+        if (_data == nullptr) return;
+        MemorySystem::set_relocatable(_data, [this](void* const ptr) {
+            _data = (T*) ptr;
+        });
+    }
+    void take(RelocatableArray&& other) {
+        _allocator = other._allocator;
+        adopt(other._data, other._size);
+        other._data = nullptr;
+        other._size = 0;
+    }
+};
+
+} // namespace ENGINE_NAMESPACE
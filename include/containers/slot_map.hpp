@@ -0,0 +1,206 @@
+#pragma once
+
+#include "vector.hpp"
+
+namespace ENGINE_NAMESPACE {
+
+/**
+ * @brief Typed generational handle referencing an item of a SlotMap. Consists
+ * of a slot index and the generation that slot had when the item was inserted.
+ * Slot generation changes once the item is removed, making all of its handles
+ * stale. Generation 0 is never used, so default handle is always invalid.
+ *
+ * @tparam T Type of the referenced resource
+ */
+template<typename T>
+struct Handle {
+    uint32 index      = 0;
+    uint32 generation = 0;
+
+    Handle() {}
+    Handle(const uint32 index, const uint32 generation)
+        : index(index), generation(generation) {}
+    /// @brief Unpack handle from its 64 bit form (see @p packed())
+    explicit Handle(const uint64 packed)
+        : index((uint32) packed), generation((uint32) (packed >> 32)) {}
+
+    /// @brief Handle packed into a single 64 bit value, usable as a resource id
+    uint64 packed() const { return ((uint64) generation << 32) | index; }
+    /// @brief False if handle can't reference any item
+    bool   is_valid() const { return generation != 0; }
+
+    bool operator==(const Handle& other) const {
+        return index == other.index && generation == other.generation;
+    }
+    bool operator!=(const Handle& other) const { return !(*this == other); }
+};
+
+/**
+ * @brief Slot map container. Stores items densely packed in a single array for
+ * fast iteration, while handing out generational handles which stay valid
+ * until the referenced item is removed. Lookup by handle is a bounds checked
+ * array index followed by a generation check, so stale handles are detected
+ * instead of referencing a reused slot. Removal moves the last item into the
+ * freed place, so item addresses (and iteration order) aren't stable.
+ *
+ * @tparam T Type of stored items
+ * @tparam H Type handles are associated with (def = T)
+ */
+template<typename T, typename H = T>
+class SlotMap {
+  public:
+    typedef Handle<H>                          HandleType;
+    typedef typename Vector<T>::iterator       iterator;
+    typedef typename Vector<T>::const_iterator const_iterator;
+
+    /**
+     * @brief Construct a new Slot Map object
+     *
+     * @param tag Memory tag used for item and slot storage
+     */
+    SlotMap(const MemoryTag tag = MemoryTag::Array);
+
+    /// @brief Number of stored items
+    uint64 size() const { return _items.size(); }
+    /// @brief True if no items are stored
+    bool   empty() const { return _items.empty(); }
+
+    /// @brief Insert new item
+    /// @param item Item to insert
+    /// @returns Handle referencing the inserted item
+    HandleType insert(const T& item);
+    /// @brief Remove item referenced by the handle
+    /// @param handle Item handle
+    /// @returns true If item was removed
+    /// @returns false If handle was stale or invalid
+    bool       remove(const HandleType handle);
+    /// @brief Remove all items. All handles become stale.
+    void       clear();
+
+    /// @brief Get item referenced by the handle
+    /// @param handle Item handle
+    /// @returns Pointer to the item, or nullptr if handle is stale or invalid.
+    /// Pointer is valid only until the next insertion or removal.
+    T*         get(const HandleType handle);
+    /// @brief Get item referenced by the handle
+    /// @param handle Item handle
+    /// @returns Pointer to the item, or nullptr if handle is stale or invalid.
+    /// Pointer is valid only until the next insertion or removal.
+    const T*   get(const HandleType handle) const;
+    /// @brief Check whether handle references a stored item
+    bool       contains(const HandleType handle) const;
+
+    /// @brief Handle of the item at given position of the dense item array
+    /// @param position Position of the item (as during iteration)
+    HandleType handle_at(const uint64 position) const;
+
+    iterator       begin() { return _items.begin(); }
+    iterator       end() { return _items.end(); }
+    const_iterator begin() const { return _items.begin(); }
+    const_iterator end() const { return _items.end(); }
+
+  private:
+    struct Slot {
+        // Item position if occupied, next free slot otherwise
+        uint32 position;
+        uint32 generation;
+    };
+
+    static constexpr uint32 invalid_slot = (uint32) -1;
+
+    Vector<T>      _items;
+    Vector<uint32> _item_slots;
+    Vector<Slot>   _slots;
+    uint32         _free_slot = invalid_slot;
+
+    uint32 find_position(const HandleType handle) const;
+};
+
+template<typename T, typename H>
+SlotMap<T, H>::SlotMap(const MemoryTag tag)
+    : _items(TAllocator<T>(tag)), _item_slots(TAllocator<uint32>(tag)),
+      _slots(TAllocator<Slot>(tag)) {}
+
+template<typename T, typename H>
+typename SlotMap<T, H>::HandleType SlotMap<T, H>::insert(const T& item) {
+    // Reuse free slot if possible
+    uint32 slot = _free_slot;
+    if (slot != invalid_slot) _free_slot = _slots[slot].position;
+    else {
+        slot = _slots.size();
+        _slots.push_back({ 0, 1 });
+    }
+
+    _slots[slot].position = _items.size();
+    _items.push_back(item);
+    _item_slots.push_back(slot);
+
+    return { slot, _slots[slot].generation };
+}
+
+template<typename T, typename H>
+bool SlotMap<T, H>::remove(const HandleType handle) {
+    const uint32 position = find_position(handle);
+    if (position == invalid_slot) return false;
+
+    // Move last item into the freed position
+    const uint32 last = _items.size() - 1;
+    if (position != last) {
+        _items[position]                       = std::move(_items[last]);
+        _item_slots[position]                  = _item_slots[last];
+        _slots[_item_slots[position]].position = position;
+    }
+    _items.pop_back();
+    _item_slots.pop_back();
+
+    // Invalidate handles and free the slot
+    auto& slot = _slots[handle.index];
+    if (++slot.generation == 0) slot.generation = 1;
+    slot.position = _free_slot;
+    _free_slot    = handle.index;
+    return true;
+}
+
+template<typename T, typename H>
+void SlotMap<T, H>::clear() {
+    while (!_items.empty())
+        remove({ _item_slots.back(), _slots[_item_slots.back()].generation });
+}
+
+template<typename T, typename H>
+T* SlotMap<T, H>::get(const HandleType handle) {
+    const uint32 position = find_position(handle);
+    return (position != invalid_slot) ? &_items[position] : nullptr;
+}
+template<typename T, typename H>
+const T* SlotMap<T, H>::get(const HandleType handle) const {
+    const uint32 position = find_position(handle);
+    return (position != invalid_slot) ? &_items[position] : nullptr;
+}
+
+template<typename T, typename H>
+bool SlotMap<T, H>::contains(const HandleType handle) const {
+    return find_position(handle) != invalid_slot;
+}
+
+template<typename T, typename H>
+typename SlotMap<T, H>::HandleType SlotMap<T, H>::handle_at(
+    const uint64 position
+) const {
+    const uint32 slot = _item_slots[position];
+    return { slot, _slots[slot].generation };
+}
+
+template<typename T, typename H>
+uint32 SlotMap<T, H>::find_position(const HandleType handle) const {
+    if (handle.index >= _slots.size()) return invalid_slot;
+    const auto& slot = _slots[handle.index];
+    if (slot.generation != handle.generation) return invalid_slot;
+    // Free slots hold a free list link instead, so check it points back
+    if (slot.position >= _items.size() ||
+        _item_slots[slot.position] != handle.index)
+        return invalid_slot;
+    return slot.position;
+}
+
+} // namespace ENGINE_NAMESPACE
\ No newline at end of file
@@ -0,0 +1,198 @@
+#pragma once
+
+#include <algorithm>
+#include <initializer_list>
+#include <new>
+#include <utility>
+
+#include "systems/memory/memory_system.hpp"
+
+namespace ENGINE_NAMESPACE {
+
+/**
+ * @brief Dynamic array with inline storage for its first @p N elements. Until
+ * the size exceeds @p N no memory is allocated, which makes it suitable for
+ * short-lived and usually small lists (e.g. ones built every frame). Once it
+ * outgrows the inline buffer, elements move to memory allocated with a tagged
+ * allocator, exactly as with @p Vector. Iterators are plain pointers and are
+ * invalidated by any growth.
+ *
+ * @tparam T Type of element
+ * @tparam N Number of elements stored inline
+ */
+template<typename T, uint64 N>
+class SmallVector {
+    static_assert(N > 0, "Small vector requires inline capacity.");
+
+  public:
+    typedef T        value_type;
+    typedef uint64   size_type;
+    typedef T&       reference;
+    typedef const T& const_reference;
+    typedef T*       iterator;
+    typedef const T* const_iterator;
+
+    /**
+     * @brief Construct a new empty Small Vector object
+     *
+     * @param tag Memory tag used once inline storage runs out
+     */
+    SmallVector(const MemoryTag tag = MemoryTag::Array) : _allocator(tag) {}
+    SmallVector(
+        std::initializer_list<T> list, const MemoryTag tag = MemoryTag::Array
+    )
+        : _allocator(tag) {
+        reserve(list.size());
+        for (const auto& item : list)
+            emplace_back(item);
+    }
+    SmallVector(const SmallVector& other) : _allocator(other._allocator) {
+        reserve(other._size);
+        for (const auto& item : other)
+            emplace_back(item);
+    }
+    SmallVector(SmallVector&& other) noexcept : _allocator(other._allocator) {
+        take(std::move(other));
+    }
+    ~SmallVector() {
+        clear();
+        release();
+    }
+
+    SmallVector& operator=(const SmallVector& other) {
+        if (this == &other) return *this;
+        clear();
+        reserve(other._size);
+        for (const auto& item : other)
+            emplace_back(item);
+        return *this;
+    }
+    SmallVector& operator=(SmallVector&& other) noexcept {
+        if (this == &other) return *this;
+        clear();
+        release();
+        take(std::move(other));
+        return *this;
+    }
+
+    // Access
+    T&       operator[](const uint64 index) { return _data[index]; }
+    const T& operator[](const uint64 index) const { return _data[index]; }
+    T&       front() { return _data[0]; }
+    const T& front() const { return _data[0]; }
+    T&       back() { return _data[_size - 1]; }
+    const T& back() const { return _data[_size - 1]; }
+    T*       data() { return _data; }
+    const T* data() const { return _data; }
+
+    // Iteration
+    iterator       begin() { return _data; }
+    iterator       end() { return _data + _size; }
+    const_iterator begin() const { return _data; }
+    const_iterator end() const { return _data + _size; }
+
+    // Capacity
+    uint64 size() const { return _size; }
+    uint64 capacity() const { return _capacity; }
+    bool   empty() const { return _size == 0; }
+    /// @brief True if elements are still stored in the inline buffer
+    bool   is_inline() const { return _data == inline_data(); }
+
+    /**
+     * @brief Make sure at least @p capacity elements fit without further
+     * allocations.
+     */
+    void reserve(const uint64 capacity) {
+        if (capacity <= _capacity) return;
+
+        T* const data = _allocator.allocate(capacity);
+        for (uint64 i = 0; i < _size; i++) {
+            new (data + i) T(std::move(_data[i]));
+            _data[i].~T();
+        }
+        release();
+        _data     = data;
+        _capacity = capacity;
+    }
+
+    // Modifiers
+    void push_back(const T& item) { emplace_back(item); }
+    void push_back(T&& item) { emplace_back(std::move(item)); }
+    template<typename... Args>
+    T& emplace_back(Args&&... args) {
+        if (_size == _capacity) {
+            // Arguments might reference an element, so construct before growth
+            T item(std::forward<Args>(args)...);
+            grow(_size + 1);
+            return *new (_data + _size++) T(std::move(item));
+        }
+        return *new (_data + _size++) T(std::forward<Args>(args)...);
+    }
+    void pop_back() { _data[--_size].~T(); }
+
+    /**
+     * @brief Remove element at given position, shifting all following ones.
+     * @returns Iterator to the element after the removed one
+     */
+    iterator erase(const_iterator position) {
+        const auto index = position - _data;
+        std::move(_data + index + 1, _data + _size, _data + index);
+        pop_back();
+        return _data + index;
+    }
+
+    /// @brief Resize to @p size elements, default constructing new ones
+    void resize(const uint64 size) {
+        if (size > _capacity) grow(size);
+        while (_size > size)
+            pop_back();
+        while (_size < size)
+            emplace_back();
+    }
+
+    /// @brief Destroy all elements. Allocated memory is kept
+    void clear() {
+        for (uint64 i = 0; i < _size; i++)
+            _data[i].~T();
+        _size = 0;
+    }
+
+  private:
+    alignas(T) unsigned char _inline[N * sizeof(T)];
+
+    TAllocator<T> _allocator;
+    T*            _data     = inline_data();
+    uint64        _size     = 0;
+    uint64        _capacity = N;
+
+    T*       inline_data() { return reinterpret_cast<T*>(_inline); }
+    const T* inline_data() const {
+        return reinterpret_cast<const T*>(_inline);
+    }
+
+    void grow(const uint64 min_capacity) {
+        reserve(std::max(min_capacity, _capacity * 2));
+    }
+    void release() {
+        if (!is_inline()) _allocator.deallocate(_data, _capacity);
+        _data     = inline_data();
+        _capacity = N;
+    }
+    // Steal heap memory, or move inline elements one by one
+    void take(SmallVector&& other) {
+        if (other.is_inline()) {
+            for (auto& item : other)
+                emplace_back(std::move(item));
+            other.clear();
+            return;
+        }
+        _data           = other._data;
+        _size           = other._size;
+        _capacity       = other._capacity;
+        other._data     = other.inline_data();
+        other._size     = 0;
+        other._capacity = N;
+    }
+};
+
+} // namespace ENGINE_NAMESPACE
\ No newline at end of file
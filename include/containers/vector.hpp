@@ -42,10 +42,7 @@ class Vector : public std::vector<Tp, TAllocator<Tp>> {
      *  @param  __a  An allocator.
      */
     Vector(const TAllocator<Tp>& __a = t_allocator_type(MemoryTag::Array))
-        : _base_class(__a) {
-        // Reserve at least 16 bytes
-        reserve(15 / sizeof(Tp) + 1);
-    }
+        : _base_class(__a) {}
 
     /**
      *  @brief  Creates a %vector with default constructed elements.
@@ -0,0 +1,178 @@
+#pragma once
+
+#include "systems/memory/memory_system.hpp"
+
+#include <atomic>
+#include <type_traits>
+#include <tbb/spin_mutex.h>
+
+namespace ENGINE_NAMESPACE {
+
+#define JOB_SYSTEM_LOG "JobSystem :: "
+
+/**
+ * @brief Job system. Executes small units of work (jobs) on a fixed set of
+ * worker threads. Each worker keeps its own queue of jobs, pushing and popping
+ * from one end, while idle workers steal from the other end of queues of
+ * others. Completion of jobs is tracked with counters, which can be waited on
+ * or have continuations attached. Waiting thread doesn't block, it executes
+ * other jobs until the counter is done. Thread calling @p initialize() is
+ * worker 0 and executes jobs only while waiting. Collection of static methods,
+ * cant be instantiated.
+ */
+class JobSystem {
+  public:
+    JobSystem()  = delete;
+    ~JobSystem() = delete;
+
+    /// @brief Index of threads which aren't workers of the job system
+    static constexpr uint32 invalid_worker = (uint32) -1;
+
+    struct Job;
+
+    /**
+     * @brief Number of unfinished jobs associated with it. Jobs are
+     * associated with a counter when they are run. Counter can be reused once
+     * done, but must outlive all of its jobs and continuations, and must only
+     * be destroyed after @p JobSystem::wait() on it returned.
+     */
+    class Counter {
+      public:
+        Counter() {}
+        ~Counter() {}
+
+        // Prevent accidental copying
+        Counter(Counter const&)            = delete;
+        Counter& operator=(Counter const&) = delete;
+
+        /// @brief True once all associated jobs are done
+        bool is_done() const {
+            return _value.load(std::memory_order_acquire) == 0;
+        }
+
+      private:
+        std::atomic<uint32> _value { 0 };
+        // Guards continuations and the final decrement
+        tbb::spin_mutex     _lock {};
+        Job*                _continuations = nullptr;
+
+        friend class JobSystem;
+    };
+
+    /**
+     * @brief Queued unit of work. Function state is stored inline, so a job
+     * is a single fixed size allocation (see @p MemoryTag::Job).
+     */
+    struct Job {
+        /// @brief Bytes available for function state (e.g. lambda captures)
+        static constexpr uint64 storage_size = 96;
+
+        // Calls function stored in storage, then destroys it
+        void (*function)(void* const storage);
+        Counter* counter;
+        // Next job in an intrusive list (shared queue or continuations)
+        Job*     next;
+        alignas(16) ubyte storage[storage_size];
+    };
+
+    /**
+     * @brief Start worker threads. Must be called before jobs are run,
+     * otherwise they are executed immediately on the calling thread.
+     * @param worker_count Number of workers, calling thread included (def =
+     * 0, one per hardware thread)
+     */
+    static void   initialize(const uint32 worker_count = 0);
+    /**
+     * @brief Finish all queued jobs and stop worker threads. Called by the
+     * same thread as @p initialize()
+     */
+    static void   shutdown();
+    /// @brief Number of workers, thread which initialized the system included
+    static uint32 worker_count();
+    /// @brief Index of the calling worker, or @p invalid_worker for threads
+    /// which aren't workers
+    static uint32 worker_index();
+
+    /**
+     * @brief Queue function for execution on any worker
+     * @param function Callable without arguments. Its state must fit in
+     * @p Job::storage_size bytes
+     * @param counter Counter incremented now and decremented once the
+     * function returns (def = none)
+     */
+    template<typename F>
+    static void run(F&& function, Counter* const counter = nullptr);
+    /**
+     * @brief Queue function for execution once all jobs of a given counter
+     * are done. If they already are, function is queued immediately.
+     * @param dependency Counter the function waits for
+     * @param function Callable without arguments. Its state must fit in
+     * @p Job::storage_size bytes
+     * @param counter Counter incremented now and decremented once the
+     * function returns (def = none)
+     */
+    template<typename F>
+    static void then(
+        Counter& dependency, F&& function, Counter* const counter = nullptr
+    );
+    /**
+     * @brief Wait for all jobs of a given counter, executing queued jobs in
+     * the meantime. Can be called from within a job.
+     * @param counter Waited on counter
+     */
+    static void wait(Counter& counter);
+
+  private:
+    template<typename F>
+    static Job* create_job(F&& function, Counter* const counter);
+
+    static void submit(Job* const job);
+    static void add_continuation(Counter& dependency, Job* const job);
+    static void execute(Job* const job);
+    static void finish(Counter& counter);
+    static void worker_loop(const uint32 index);
+};
+
+// -----------------------------------------------------------------------------
+// Templated methods
+// -----------------------------------------------------------------------------
+
+template<typename F>
+void JobSystem::run(F&& function, Counter* const counter) {
+    submit(create_job(std::forward<F>(function), counter));
+}
+
+template<typename F>
+void JobSystem::then(
+    Counter& dependency, F&& function, Counter* const counter
+) {
+    Job* const job = create_job(std::forward<F>(function), counter);
+    add_continuation(dependency, job);
+}
+
+template<typename F>
+JobSystem::Job* JobSystem::create_job(F&& function, Counter* const counter) {
+    typedef std::decay_t<F> Function;
+    static_assert(
+        sizeof(Function) <= Job::storage_size,
+        "Job function state too large. Capture larger state by reference."
+    );
+    static_assert(
+        alignof(Function) <= 16, "Job function state over-aligned."
+    );
+
+    if (counter != nullptr) counter->_value.fetch_add(1);
+
+    const auto job = new (MemoryTag::Job) Job();
+    new (job->storage) Function(std::forward<F>(function));
+    job->function = [](void* const storage) {
+        auto& function = *(Function*) storage;
+        function();
+        function.~Function();
+    };
+    job->counter = counter;
+    job->next    = nullptr;
+    return job;
+}
+
+} // namespace ENGINE_NAMESPACE
\ No newline at end of file
@@ -1,24 +1,19 @@
 #pragma once
 
 #include "logger.hpp"
+#include "small_vector.hpp"
+#include "multithreading/job_system.hpp"
 #include <tbb/tbb.h>
 
 namespace ENGINE_NAMESPACE {
 
 /**
  * @brief Static class holding a list of functions for parallel multithreaded
- * execution of code.
+ * execution of code. Loops are split into chunks run as jobs of the
+ * @p JobSystem, while sorting is left to TBB.
  */
 class Parallel {
   private:
-    // Define a type trait to check for the existence of 'iterator' type
-    template<typename T, typename = std::void_t<>>
-    struct has_iterator //
-        : std::false_type {};
-    template<typename T>
-    struct has_iterator<T, std::void_t<typename T::iterator>> //
-        : std::true_type {};
-
     // Not initialize-able
     Parallel() {}
     ~Parallel() {}
@@ -34,9 +29,133 @@ class Parallel {
      */
     class Mutex : public tbb::spin_mutex {};
 
+    /// @brief Range of indices [begin, end)
+    struct Range {
+        uint64 begin;
+        uint64 end;
+
+        uint64 size() const { return end - begin; }
+    };
+
+    /**
+     * @brief Storage with a separate instance for each worker of the job
+     * system, e.g. for scratch buffers or partial results of parallel loops.
+     * Instances are kept on separate cache lines, so they can be used without
+     * synchronization. Threads which aren't workers share one additional
+     * instance. Worker count is that at the time of construction.
+     * @tparam T Type of stored instances
+     */
+    template<typename T>
+    class Scratch {
+      public:
+        /// @param value Initial value of each instance
+        Scratch(const T& value = T())
+            : _slots((uint64) JobSystem::worker_count() + 1, { value }) {}
+
+        /// @brief Instance of the calling worker
+        T& local() {
+            const uint32 worker = JobSystem::worker_index();
+            return (worker < _slots.size() - 1) ? _slots[worker].value
+                                                : _slots.back().value;
+        }
+
+        /// @brief Number of instances
+        uint64   size() const { return _slots.size(); }
+        T&       operator[](const uint64 index) { return _slots[index].value; }
+        const T& operator[](const uint64 index) const {
+            return _slots[index].value;
+        }
+
+      private:
+        struct Slot {
+            T     value;
+            // Keeps neighbouring values out of this value's cache lines
+            ubyte padding[64];
+        };
+        Vector<Slot> _slots;
+    };
+
   public:
     // Parallel algorithms
 
+    /**
+     * @brief Execute @p body for all indices of a range. Range is split into
+     * chunks of at least @p grain indices, each passed to a single call of
+     * @p body, so that the loop itself is inlined. Chunks are run as jobs,
+     * calling thread runs the first one and waits for the others. Without
+     * multiple workers, body is called once for the whole range.
+     * @tparam Body Callable as @p body(Range)
+     * @param range Range of indices
+     * @param grain Minimal number of indices per chunk
+     * @param body Function processing all indices of a given chunk
+     */
+    template<typename Body>
+    static void for_loop(const Range range, const uint64 grain, Body&& body) {
+        const uint64 chunk_count = get_chunk_count(range, grain);
+        if (chunk_count <= 1) {
+            if (range.size() != 0) body(range);
+            return;
+        }
+
+        JobSystem::Counter counter {};
+        for (uint64 i = 1; i < chunk_count; i++) {
+            const Range chunk = get_chunk(range, chunk_count, i);
+            JobSystem::run([&body, chunk] { body(chunk); }, &counter);
+        }
+        body(get_chunk(range, chunk_count, 0));
+        JobSystem::wait(counter);
+    }
+
+    /**
+     * @brief Reduce a range to a single value. Range is split into chunks as
+     * with @p for_loop(), each reduced by @p body. Results of chunks are then
+     * combined in order of the chunks, so that the result doesn't depend on
+     * scheduling.
+     * @tparam T Result type
+     * @tparam Body Callable as @p T body(Range)
+     * @tparam Combine Callable as @p T combine(T, T)
+     * @param range Range of indices
+     * @param grain Minimal number of indices per chunk
+     * @param identity Result of an empty range
+     * @param body Function reducing all indices of a given chunk
+     * @param combine Function combining results of two chunks
+     * @return T Combined results of all chunks
+     */
+    template<typename T, typename Body, typename Combine>
+    static T reduce(
+        const Range    range,
+        const uint64   grain,
+        const T&       identity,
+        Body&&         body,
+        const Combine& combine
+    ) {
+        const uint64 chunk_count = get_chunk_count(range, grain);
+        if (chunk_count <= 1)
+            return (range.size() != 0) ? combine(identity, body(range))
+                                       : identity;
+
+        SmallVector<T, 64> results {};
+        results.reserve(chunk_count);
+        for (uint64 i = 0; i < chunk_count; i++)
+            results.push_back(identity);
+
+        JobSystem::Counter counter {};
+        for (uint64 i = 1; i < chunk_count; i++) {
+            const Range chunk = get_chunk(range, chunk_count, i);
+            JobSystem::run(
+                [&body, &results, chunk, i] { results[i] = body(chunk); },
+                &counter
+            );
+        }
+        results[0] = body(get_chunk(range, chunk_count, 0));
+        JobSystem::wait(counter);
+
+        T result = identity;
+        for (const auto& chunk_result : results)
+            result = combine(result, chunk_result);
+        return result;
+    }
+
     /**
      * @brief Sort data from range [begin, end) in increasing order. Uses
      * default comparator (less than).
@@ -81,86 +200,28 @@ class Parallel {
     }
 
   private:
-    // Parallel for loop
-    typedef void* var;
-    typedef void* iterator_begin;
-    typedef void* iterator_end;
-    typedef int*  from;
-    typedef int*  to;
-    typedef void* collection;
-
-  public:
-    template<typename T>
-    struct __Loop__ {
-        __Loop__() {};
-
-        T from;
-        T to;
-
-        __Loop__& set_from(T from) {
-            this->from = from;
-            return *this;
-        }
-        __Loop__& set_to(T to) {
-            this->to = to;
-            return *this;
-        }
-
-        void operator=(std::function<void(T)> callback) {
-            tbb::parallel_for(
-                tbb::blocked_range<T>(from, to),
-                [&callback](tbb::blocked_range<T> range) {
-                    for (T i = range.begin(); i != range.end(); i++)
-                        callback(i);
-                }
-            );
-        }
-    };
-
-    template<typename T>
-    static __Loop__<T> __parallel_for_get__(T& type) {
-        return __Loop__<T>();
-    }
-    template<typename T>
-    static __Loop__<T> __parallel_for_get__(T&& type) {
-        return __Loop__<T>();
-    }
-
-    template<typename T>
-    static __Loop__<typename T::iterator> __parallel_for_get_it__(T& type) {
-        auto loop = __Loop__<typename T::iterator>();
-        loop.from = type.begin();
-        loop.to   = type.end();
-        return loop;
+    // Loops are split into at most this many chunks per worker, so that
+    // uneven chunks can be balanced by stealing
+    static constexpr uint64 chunks_per_worker = 4;
+
+    static uint64 get_chunk_count(const Range range, const uint64 grain) {
+        const uint64 worker_count = JobSystem::worker_count();
+        if (worker_count == 1) return 1;
+        return std::min(
+            range.size() / std::max(grain, (uint64) 1),
+            worker_count * chunks_per_worker
+        );
     }
-    template<typename T>
-    static __Loop__<typename T::iterator> __parallel_for_get_it__(T&& type) {
-        auto loop = __Loop__<typename T::iterator>();
-        loop.from = type.begin();
-        loop.to   = type.end();
-        return loop;
+    // Remainder is spread over the first chunks
+    static Range get_chunk(
+        const Range range, const uint64 chunk_count, const uint64 index
+    ) {
+        const uint64 size  = range.size() / chunk_count;
+        const uint64 extra = range.size() % chunk_count;
+        const uint64 begin =
+            range.begin + index * size + std::min(index, extra);
+        return { begin, begin + size + (index < extra ? 1 : 0) };
     }
-
-    static void for_loop(var, from, to);
-    static void for_loop(var, iterator_begin, iterator_end);
-    static void for_loop(var, collection);
-
-  public:
-  private:
 };
 
-#define for_loop_1(variable, begin, end)                                       \
-    __parallel_for_get__(begin).set_from(begin).set_to(end) =                  \
-        (std::function<void(variable)>) [&](variable)
-
-#define for_loop_2(variable, collection)                                       \
-    __parallel_for_get_it__(collection) =                                      \
-        (std::function<void(variable)>) [&](variable)
-
-#define GET_FOR_LOOP_MACRO(_1, _2, _3, NAME, ...) NAME
-
-#undef for_loop
-#define for_loop(...)                                                          \
-    GET_FOR_LOOP_MACRO(__VA_ARGS__, for_loop_1, for_loop_2)(__VA_ARGS__)
-
 } // namespace ENGINE_NAMESPACE
\ No newline at end of file
@@ -34,6 +34,27 @@ class Platform {
     /// @param ms Time to sleep in miliseconds
     static void    sleep(uint64 ms);
 
+    /**
+     * @brief Capture return addresses of the calling thread's call stack
+     * @param frames Array to be filled with captured addresses
+     * @param max_frames Maximum number of captured addresses
+     * @param skip Number of innermost frames to skip (this one excluded)
+     * @return uint32 Number of captured addresses
+     */
+    static uint32 capture_callstack(
+        void** const frames, const uint32 max_frames, const uint32 skip = 0
+    );
+    /**
+     * @brief Describe captured call stack, one frame per line. Frames are
+     * resolved to function names only if the platform supports it
+     * @param frames Captured return addresses
+     * @param frame_count Number of captured addresses
+     * @return std::string Call stack description
+     */
+    static std::string callstack_to_string(
+        void* const* const frames, const uint32 frame_count
+    );
+
     // TODO: Separate platform code from knowing about renderers
     static const Vector<const char*> get_required_vulkan_extensions();
 
@@ -70,6 +91,64 @@ class Platform {
         static std::string read();
     };
 
+    /**
+     * @brief A platform agnostic virtual memory interface. Allows for address
+     * space to be reserved up front and backed by physical memory only when
+     * needed.
+     */
+    class VirtualMemory {
+      public:
+        VirtualMemory()  = delete;
+        ~VirtualMemory() = delete;
+
+        /// @brief Size of a single virtual memory page in bytes
+        static uint64 page_size();
+        /// @brief Size of a single huge page in bytes, or 0 if huge pages
+        /// aren't supported
+        static uint64 huge_page_size();
+
+        /**
+         * @brief Reserve a range of virtual address space. Reserved memory
+         * can't be accessed before it is commited.
+         * @param size Range size in bytes
+         * @return void* Start of the reserved range, or nullptr on failure
+         */
+        static void* reserve(const uint64 size);
+        /**
+         * @brief Make a part of reserved range accessible for reading and
+         * writing
+         * @param address Start of the commited segment (page aligned)
+         * @param size Segment size in bytes (rounded up to page size)
+         * @return true If commit was successful
+         * @return false Otherwise
+         */
+        static bool  commit(void* const address, const uint64 size);
+        /**
+         * @brief Return physical memory of a commited segment to the system.
+         * Segment stays reserved.
+         * @param address Start of the segment (page aligned)
+         * @param size Segment size in bytes (rounded up to page size)
+         */
+        static void  decommit(void* const address, const uint64 size);
+        /**
+         * @brief Release whole reserved range back to the system
+         * @param address Start of the range, as returned by @p reserve
+         * @param size Range size in bytes, as passed to @p reserve
+         */
+        static void  release(void* const address, const uint64 size);
+        /**
+         * @brief Ask the system to back (a part of) reserved range with huge
+         * pages. Memory is still commited lazily, but is faulted in huge page
+         * sized chunks once touched. Reduces TLB misses for large, randomly
+         * accessed ranges.
+         * @param address Start of the range (huge page aligned)
+         * @param size Range size in bytes
+         * @return true If huge pages will be used
+         * @return false If huge pages aren't supported
+         */
+        static bool  use_huge_pages(void* const address, const uint64 size);
+    };
+
     /**
      * @brief A platform agnostic render-able surface. Can be a window or the
      * entire screen.
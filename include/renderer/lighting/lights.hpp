@@ -2,6 +2,7 @@
 
 #include "renderer/renderer_types.hpp"
 #include "containers/vector.hpp"
+#include "containers/small_vector.hpp"
 
 namespace ENGINE_NAMESPACE {
 
@@ -106,7 +107,7 @@ class DirectionalLight : public Light {
     DirectionalLightData data;
 
     glm::mat4 get_light_space_matrix(uint32 rp_index) const;
-    Vector<glm::mat4> get_light_space_matrices() const;
+    SmallVector<glm::mat4, 4> get_light_space_matrices() const;
     glm::vec4 get_light_camera_position() const;
     Vector<RenderViewDirectionalShadow*> get_render_views() const;
 
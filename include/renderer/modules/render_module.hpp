@@ -8,6 +8,8 @@
 
 namespace ENGINE_NAMESPACE {
 
+class RenderView;
+
 class RenderModule {
   public:
     enum class Update {};
@@ -52,6 +54,14 @@ class RenderModule {
      */
     ModulePacket* build_pocket();
 
+    /**
+     * @brief Add render views whose visible render data this module draws.
+     * They are prepared together with module packets, before the frame is
+     * recorded.
+     * @param views List of views to add to
+     */
+    virtual void add_render_views(Vector<RenderView*>& views) const {}
+
     /**
      * @brief Render provided render data
      *
@@ -83,7 +93,8 @@ class RenderModule {
     void setup_uniform_indices(String uniform);
 
     /**
-     * @brief Build render packet and update internal state.
+     * @brief Build render packet and update internal state. Packet should be
+     * allocated with frame memory (@p MemoryTag::Frame).
      * @return Packet* Resulting render packet
      */
     virtual ModulePacket* on_build_pocket();
@@ -103,6 +114,18 @@ class RenderModule {
 
     virtual void apply_globals(uint32 rp_index) const {}
 
+    /**
+     * @brief Draw consecutive render data sharing geometry, material and level
+     * of detail as instances of a single draw call. Their model matrices are
+     * passed to the shader as per instance attributes.
+     * @param render_data Render data, grouped by geometry and material
+     * @param begin Index of the first render data drawn
+     * @return Index of the first render data not drawn
+     */
+    uint64 draw_instances(
+        const Vector<GeometryRenderData>& render_data, const uint64 begin
+    );
+
     Texture::Map* create_texture_map(
         const String&          texture,
         const Texture::Use&    use,
@@ -118,7 +141,9 @@ class RenderModule {
   private:
     void apply_globals(uint64 frame_number, uint32 rp_index) const;
 
-    Vector<Texture*> _own_textures {};
+    Vector<Texture*>  _own_textures {};
+    // Model matrices of the instances being drawn
+    Vector<glm::mat4> _instance_models {};
 };
 
 /**
@@ -19,7 +19,6 @@ class RenderModuleGPrepass : public RenderModule {
 
         setup_uniform_indices(_u_names.projection);
         setup_uniform_indices(_u_names.view);
-        setup_uniform_indices(_u_names.model);
         setup_uniform_indices(_u_names.smoothness);
     }
 
@@ -36,6 +35,10 @@ class RenderModuleGPrepass : public RenderModule {
         }
     }
 
+    void add_render_views(Vector<RenderView*>& views) const override {
+        views.push_back(_perspective_view);
+    }
+
   protected:
     void on_render(const ModulePacket* const packet, const uint64 frame_number, uint32 rp_index)
         override {
@@ -43,25 +46,29 @@ class RenderModuleGPrepass : public RenderModule {
         auto shader = _renderpasses.at(rp_index).shader;
 
         // Get visible geometries
-        const auto geometry_data =
+        const auto& geometry_data =
             _perspective_view->get_visible_render_data(frame_number);
 
-        // Draw geometries
-        for (const auto& geo_data : geometry_data) {
+        // Draw geometries. Draws are grouped by material, so its instance is
+        // only applied when it changes, and by geometry, so that all copies of
+        // a geometry are drawn together as instances
+        const Material* applied_material = nullptr;
+        for (uint64 i = 0; i < geometry_data.size();) {
             // Apply instance
-            const auto material_id = geo_data.material->internal_id.value();
-            const auto g_pass_id   = _material_to_g_pass_id[material_id];
-            shader->bind_instance(g_pass_id);
-            shader->set_uniform(
-                UNIFORM_ID(smoothness), &geo_data.material->smoothness()
-            );
-            shader->apply_instance();
-
-            // Apply local
-            shader->set_uniform(UNIFORM_ID(model), &geo_data.model);
-
-            // Draw geometry
-            _renderer->draw_geometry(geo_data.geometry);
+            const auto material = geometry_data[i].material;
+            if (material != applied_material) {
+                const auto material_id = material->internal_id.value();
+                const auto g_pass_id   = _material_to_g_pass_id[material_id];
+                shader->bind_instance(g_pass_id);
+                shader->set_uniform(
+                    UNIFORM_ID(smoothness), &material->smoothness()
+                );
+                shader->apply_instance();
+                applied_material = material;
+            }
+
+            // Draw geometry instances
+            i = draw_instances(geometry_data, i);
         }
     }
 
@@ -82,7 +89,6 @@ class RenderModuleGPrepass : public RenderModule {
     struct Uniforms {
         UNIFORM_NAME(projection);
         UNIFORM_NAME(view);
-        UNIFORM_NAME(model);
         UNIFORM_NAME(smoothness);
     };
     Uniforms _u_names {};
@@ -18,6 +18,13 @@ class RenderModuleShadowmapDirectional : public RenderModule {
         setup_uniform_indices(_u_names.model);
     }
 
+    void add_render_views(Vector<RenderView*>& views) const override {
+        // First cascade prepares all the others
+        const auto light = _light_system->get_directional();
+        if (light == nullptr || light->get_render_views().empty()) return;
+        views.push_back(light->get_render_views().at(0));
+    }
+
   protected:
     void on_render(
         const ModulePacket* const packet,
@@ -28,10 +35,10 @@ class RenderModuleShadowmapDirectional : public RenderModule {
         auto shader = _renderpasses.at(rp_index).shader;
 
         // Get visible geometries
-        const auto geometry_data = _light_system->get_directional()
-                                       ->get_render_views()
-                                       .at(rp_index)
-                                       ->get_visible_render_data(frame_number);
+        const auto& geometry_data = _light_system->get_directional()
+                                        ->get_render_views()
+                                        .at(rp_index)
+                                        ->get_visible_render_data(frame_number);
 
         // Draw geometries
         for (const auto& geo_data : geometry_data) {
@@ -39,7 +46,7 @@ class RenderModuleShadowmapDirectional : public RenderModule {
             shader->set_uniform(UNIFORM_ID(model), &geo_data.model);
 
             // Draw geometry
-            _renderer->draw_geometry(geo_data.geometry);
+            _renderer->draw_geometry(geo_data.geometry, geo_data.lod);
         }
     }
 
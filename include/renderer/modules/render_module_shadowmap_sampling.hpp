@@ -74,7 +74,7 @@ class RenderModuleShadowmapSampling : public RenderModuleFullScreen {
         shader->set_uniform(UNIFORM_ID(view_inverse), &camera->view_inverse());
 
         // Directional light spaces (cascades)
-        Vector<glm::mat4> light_spaces_directional =
+        SmallVector<glm::mat4, 4> light_spaces_directional =
             _light_system->get_directional()->get_light_space_matrices();
         shader->set_uniform(
             UNIFORM_ID(light_spaces_directional), light_spaces_directional.data()
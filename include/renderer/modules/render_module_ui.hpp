@@ -22,12 +22,16 @@ class RenderModuleUI : public RenderModule {
         setup_uniform_indices(_u_names.model);
     }
 
+    void add_render_views(Vector<RenderView*>& views) const override {
+        views.push_back(_orthographic_view);
+    }
+
   protected:
     void on_render(const ModulePacket* const packet, const uint64 frame_number, uint32 rp_index)
         override {
         auto shader = _renderpasses.at(rp_index).shader;
         // Get visible geometries
-        const auto geometry_data =
+        const auto& geometry_data =
             _orthographic_view->get_visible_render_data(frame_number);
 
         // Draw geometries
@@ -108,7 +108,7 @@ class RenderModuleVolumetrics : public RenderModuleFullScreen {
             glm::vec4(_perspective_view->camera()->transform.position(), 1.0f);
         shader->set_uniform(UNIFORM_ID(camera_position), &camera_position);
 
-        Vector<glm::mat4> light_spaces_directional =
+        SmallVector<glm::mat4, 4> light_spaces_directional =
             _light_system->get_directional()->get_light_space_matrices();
         shader->set_uniform(
             UNIFORM_ID(light_spaces_directional), light_spaces_directional.data()
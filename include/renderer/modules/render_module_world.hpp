@@ -33,7 +33,6 @@ class RenderModuleWorld : public RenderModule {
         setup_uniform_indices(_u_names.ambient_color);
         setup_uniform_indices(_u_names.view_position);
         setup_uniform_indices(_u_names.mode);
-        setup_uniform_indices(_u_names.model);
         setup_uniform_indices(_u_names.directional_light);
         setup_uniform_indices(_u_names.num_point_lights);
         setup_uniform_indices(_u_names.point_lights);
@@ -44,24 +43,31 @@ class RenderModuleWorld : public RenderModule {
 
     void set_mode(const DebugViewMode& mode) { _render_mode = mode; }
 
+    void add_render_views(Vector<RenderView*>& views) const override {
+        views.push_back(_perspective_view);
+    }
+
   protected:
     void on_render(const ModulePacket* const packet, const uint64 frame_number, uint32 rp_index)
         override {
-        auto shader = _renderpasses.at(rp_index).shader;
         // Get visible geometries
-        const auto geometry_data =
+        const auto& geometry_data =
             _perspective_view->get_visible_render_data(frame_number);
 
-        // Draw geometries
-        for (const auto& geo_data : geometry_data) {
+        // Draw geometries. Draws are grouped by material, so its instance is
+        // only applied when it changes, and by geometry, so that all copies of
+        // a geometry are drawn together as instances
+        const Material* applied_material = nullptr;
+        for (uint64 i = 0; i < geometry_data.size();) {
             // Update material instance
-            geo_data.material->apply_instance();
-
-            // Apply local
-            shader->set_uniform(UNIFORM_ID(model), &geo_data.model);
-
-            // Draw geometry
-            _renderer->draw_geometry(geo_data.geometry);
+            const auto material = geometry_data[i].material;
+            if (material != applied_material) {
+                material->apply_instance();
+                applied_material = material;
+            }
+
+            // Draw geometry instances
+            i = draw_instances(geometry_data, i);
         }
     }
 
@@ -112,7 +118,6 @@ class RenderModuleWorld : public RenderModule {
         UNIFORM_NAME(ambient_color);
         UNIFORM_NAME(view_position);
         UNIFORM_NAME(mode);
-        UNIFORM_NAME(model);
         UNIFORM_NAME(directional_light);
         UNIFORM_NAME(num_point_lights);
         UNIFORM_NAME(point_lights);
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "renderer_types.hpp"
+#include "resources/geometry.hpp"
+
+namespace ENGINE_NAMESPACE {
+
+/**
+ * @brief List of draws ordered by 64 bit sort keys, so that draws sharing
+ * shader, material and geometry end up next to each other and renderer state
+ * changes only when needed. Opaque draws are grouped by state (and level of
+ * detail), nearest first within a group, while transparent draws follow them
+ * ordered from the farthest. Key layout (from the most significant bit):
+ * - Opaque: layer (1) | pass (3) | shader (8) | material (16) | geometry (18)
+ *   | lod (2) | depth (16)
+ * - Transparent: layer (1) | pass (3) | inverted depth (16) | shader (8) |
+ *   material (16) | geometry (18) | lod (2)
+ */
+class RenderQueue {
+  public:
+    /// @brief Number of state changes required to draw the queue
+    struct Stats {
+        uint64 draws                = 0;
+        // In submission order
+        uint64 submitted_materials  = 0;
+        uint64 submitted_geometries = 0;
+        // In sorted order
+        uint64 materials            = 0;
+        uint64 geometries           = 0;
+
+        /// @brief Material binds saved by sorting
+        uint64 saved_materials() const {
+            return submitted_materials - materials;
+        }
+        /// @brief Vertex and index buffer binds saved by sorting
+        uint64 saved_geometries() const {
+            return submitted_geometries - geometries;
+        }
+    };
+
+    RenderQueue() {}
+    ~RenderQueue() {}
+
+    /// @brief Number of draws in queue
+    uint64 size() const { return _draws.size(); }
+    /// @brief State changes of the last sorted queue
+    const Stats& stats() const { return _stats; }
+
+    /**
+     * @brief Remove all draws and start a new queue
+     * @param max_depth Depth at which draw depths are clamped (e.g. far clip
+     * distance of the view)
+     */
+    void clear(const float32 max_depth);
+    /**
+     * @brief Add a draw to the queue
+     * @param data Render data of the draw
+     * @param depth Distance of the draw from the viewer
+     * @param transparent Whether the draw is blended with what's behind it
+     * @param pass Index of the pass drawing it, passes are drawn in order
+     * (up to 8)
+     */
+    void add(
+        const GeometryRenderData& data,
+        const float32             depth,
+        const bool                transparent,
+        const uint8               pass = 0
+    );
+    /// @brief Sort draws by their keys and compute @p stats()
+    void sort();
+
+    /**
+     * @brief Get draws in order. Valid only after @p sort()
+     * @param result Sorted draws are appended to it
+     */
+    void get_draws(Vector<GeometryRenderData>& result) const;
+
+  private:
+    struct Item {
+        uint64 key;
+        uint64 index;
+    };
+
+    float32 _depth_scale = 0.0f;
+    Stats   _stats {};
+
+    Vector<GeometryRenderData> _draws {};
+    Vector<Item>               _items {};
+    // Radix sort buffer, sorted items end up in either of the two
+    Vector<Item>               _sort_buffer {};
+    // Shaders seen so far, their index is their key
+    Vector<const Shader*>      _shaders {};
+
+    uint8 get_shader_key(const Shader* const shader);
+    void  compute_stats();
+};
+
+} // namespace ENGINE_NAMESPACE
\ No newline at end of file
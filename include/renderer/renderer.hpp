@@ -3,10 +3,12 @@
 #include "renderer/vulkan/vulkan_backend.hpp"
 #include "camera.hpp"
 #include "resources/geometry.hpp"
+#include "containers/small_vector.hpp"
 
 namespace ENGINE_NAMESPACE {
 
 class ModulePacket;
+class RenderModule;
 
 /**
  * @brief The renderer frontend. Interacts with the device using the backend, in
@@ -19,7 +21,8 @@ class Renderer {
      * rendering of one frame.
      */
     struct Packet {
-        Vector<ModulePacket*> module_data;
+        /// @brief Module packets, allocated with frame memory
+        SmallVector<ModulePacket*, 16> module_data;
     };
 
   public:
@@ -39,6 +42,28 @@ class Renderer {
     Renderer(Renderer const&)            = delete;
     Renderer& operator=(Renderer const&) = delete;
 
+    /**
+     * @brief Prepare for construction of the next frame. Waits until the GPU
+     * is done with the frame in flight about to be reused and releases its
+     * frame memory (@p MemoryTag::Frame). Must be called before anything is
+     * allocated with frame memory for the next frame (e.g. render packets).
+     * @throws RuntimeError If waiting on the frame fails
+     */
+    Result<void, RuntimeError> prepare_frame();
+
+    /**
+     * @brief Build render packet of the next frame. Module packets are built
+     * and render views used by modules are culled concurrently, as jobs of the
+     * job system. Must be called after @p prepare_frame(), while recording of
+     * the frame (@p draw_frame()) only consumes the prepared data.
+     *
+     * @param modules Render modules, in the order in which they are rendered
+     * @param packet Packet filled with module packets
+     */
+    void build_packet(
+        const Vector<RenderModule*>& modules, Packet* const packet
+    );
+
     /**
      * @brief Draw to the surface
      *
@@ -50,7 +75,24 @@ class Renderer {
         const Packet* const render_data, const float32 delta_time
     );
 
-    void draw_geometry(Geometry* const geometry);
+    void draw_geometry(Geometry* const geometry, const uint8 lod = 0);
+    /**
+     * @brief Draw multiple instances of a geometry with a single draw call
+     * @param geometry Geometry to draw
+     * @param models Model matrix of each instance, passed to the shader as
+     * per instance attributes
+     * @param lod Level of detail drawn (see Geometry::lods)
+     */
+    void draw_geometry(
+        Geometry* const          geometry,
+        const Vector<glm::mat4>& models,
+        const uint8              lod = 0
+    );
+
+    /// @brief Number of geometries drawn during the last drawn frame
+    uint64 get_draw_count() const { return _draw_count; }
+    /// @brief Number of draw calls issued during the last drawn frame
+    uint64 get_draw_call_count() const { return _draw_call_count; }
 
     /**
      * @brief Inform renderer of a surface resize event
@@ -189,7 +231,9 @@ class Renderer {
     }
 
   private:
-    RendererBackend* _backend = nullptr;
+    RendererBackend* _backend         = nullptr;
+    uint64           _draw_count      = 0;
+    uint64           _draw_call_count = 0;
 
     // System references
     TextureSystem* _texture_system = nullptr;
@@ -44,6 +44,14 @@ class RendererBackend {
      */
     uint64 get_current_frame() { return _frame_number; }
 
+    /**
+     * @brief Wait until the GPU is done with the frame in flight which will be
+     * rendered next, so that resources tied to it can be reused
+     * @return uint32 Index of the next frame in flight
+     * @throws RuntimeError If waiting on the frame fails
+     */
+    virtual Result<uint32, RuntimeError> wait_for_frame() = 0;
+
     /**
      * @brief Preform operations in preparation for frame rendering
      * @param delta_time Time in seconds since the last frame
@@ -143,18 +151,35 @@ class RendererBackend {
         Geometry* const         geometry,
         const Vector<Vertex2D>& vertices,
         const Vector<uint32>&   indices
-    )                                                    = 0;
+    )                                                                     = 0;
     /**
      * @brief Destroy geometry and free its corresponding GPU resources
      *
      * @param geometry Geometry to be destroyed
      */
-    virtual void destroy_geometry(Geometry* geometry)    = 0;
+    virtual void destroy_geometry(Geometry* geometry)                     = 0;
     /**
      * @brief Draw command for specified geometry
      * @param geometry Geometry to draw
+     * @param lod Level of detail to draw (see Geometry::lods)
+     */
+    virtual void draw_geometry(Geometry* const geometry, const uint8 lod) = 0;
+    /**
+     * @brief Instanced draw command for specified geometry
+     * @param geometry Geometry to draw
+     * @param lod Level of detail to draw (see Geometry::lods)
+     * @param instance_data Per instance attribute values of all instances,
+     * copied into this frame's instance buffer
+     * @param instance_size Size of a single instance's values in bytes
+     * @param instance_count Number of instances to draw
      */
-    virtual void draw_geometry(Geometry* const geometry) = 0;
+    virtual void draw_geometry(
+        Geometry* const   geometry,
+        const uint8       lod,
+        const void* const instance_data,
+        const uint32      instance_size,
+        const uint32      instance_count
+    )                                                                     = 0;
 
     /**
      * @brief Create a shader object and upload relevant data to the GPU
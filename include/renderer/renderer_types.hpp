@@ -50,7 +50,6 @@ struct Vertex<3> {
     )
         : position(position), normal(normal), tangent(tangent), color(color),
           texture_coord(texture_coord) {}
-    ~Vertex() {}
 
     bool operator==(const Vertex& other) const {
         const auto same_position =
@@ -181,6 +180,8 @@ struct GeometryRenderData {
     Geometry* geometry;
     Material* material;
     glm::mat4 model;
+    // Level of detail drawn, see Geometry::lods
+    uint8     lod = 0;
 };
 
 struct MeshRenderData {
@@ -1,6 +1,9 @@
 #pragma once
 
 #include "renderer/render_pass.hpp"
+#include "renderer/render_queue.hpp"
+#include "component/frustum.hpp"
+#include "component/transform_hierarchy.hpp"
 
 namespace ENGINE_NAMESPACE {
 
@@ -28,6 +31,10 @@ class RenderView {
     };
 
   public:
+    /// @brief Name of the view
+    Property<String> name {
+        GET { return _name; }
+    };
     /// @brief True if view was updated
     Property<bool> updated {
         GET { return _updated; }
@@ -48,6 +55,12 @@ class RenderView {
     Property<glm::mat4> proj_inv_matrix {
         GET { return _proj_inv_matrix; }
     };
+    /// @brief Scale of screen sizes at which levels of detail are switched.
+    /// Larger bias selects coarser levels of detail
+    Property<float32> lod_bias {
+        GET { return _lod_bias; }
+        SET { _lod_bias = value; }
+    };
 
     /// @brief Aspect ratio used
     float32 aspect_ratio() { return (float32) _width / _height; }
@@ -73,12 +86,7 @@ class RenderView {
      * view. All non-mentioned meshes will be invisible to it.
      * @param meshes List of potentially visible meshes
      */
-    void set_visible_meshes(const Vector<Mesh*>& meshes) {
-        // Copy references over
-        _potentially_visible_meshes.resize(meshes.size());
-        for (uint64 i = 0; i < meshes.size(); i++)
-            _potentially_visible_meshes[i] = meshes[i];
-    }
+    void set_visible_meshes(const Vector<Mesh*>& meshes);
 
     /**
      * @brief Get all render data of all geometries that could potentially be
@@ -87,16 +95,41 @@ class RenderView {
      */
     virtual Vector<GeometryRenderData>& get_all_render_data() = 0;
 
+    /**
+     * @brief Update world transforms of all potentially visible meshes, in
+     * parallel across independent transform subtrees. Meshes can be shared
+     * between views, so this is done for one view at a time before views are
+     * prepared concurrently, after which their transforms are only read.
+     */
+    void update_transforms();
+
+    /**
+     * @brief Compute render data of geometries that are currently within view.
+     * Computed at most once per frame. Different views can be prepared
+     * concurrently once their transforms are up to date.
+     * @param frame_number Index of the current frame
+     */
+    void prepare_render_data(const uint64 frame_number);
+
     /**
      * @brief Get render data of geometries that are currently within view.
      * Represents a subset of all potentially visible geometries.
-     * @param frame_number Index of the current frame. Internally values wont be
-     * recomputed if prompted twice on the same frame.
+     * @param frame_number Index of the current frame. Data is prepared first if
+     * it wasn't prepared for this frame yet.
      * @return Vector<GeometryRenderData>& Visible render data
      */
-    virtual Vector<GeometryRenderData>& get_visible_render_data(
-        const uint32 frame_number
-    ) = 0;
+    Vector<GeometryRenderData>& get_visible_render_data(
+        const uint64 frame_number
+    ) {
+        prepare_render_data(frame_number);
+        return _visible_render_data;
+    }
+
+    /// @brief State changes needed to draw visible render data, as of the last
+    /// prepared frame. Empty for views which don't sort their render data
+    const RenderQueue::Stats& get_queue_stats() const {
+        return _render_queue.stats();
+    }
 
   protected:
     String    _name;
@@ -106,12 +139,55 @@ class RenderView {
     glm::mat4 _proj_matrix;
     glm::mat4 _proj_inv_matrix;
     uint64    _last_frame = -1;
+    float32   _lod_bias   = 1.0f;
 
     Vector<Mesh*>              _potentially_visible_meshes {};
     Vector<GeometryRenderData> _visible_render_data {};
     Vector<GeometryRenderData> _all_render_data {};
 
     bool _updated;
+
+    // Geometry of a potentially visible mesh, as seen by the last culling
+    struct CullEntry {
+        Geometry* geometry;
+        uint32    mesh_index;
+    };
+
+    // World matrices of potentially visible meshes, indexed by mesh
+    TransformHierarchy _transforms {};
+    // Orders visible render data to minimize state changes
+    RenderQueue        _render_queue {};
+
+    // Culling state, indexed by geometry
+    Vector<CullEntry> _cull_entries {};
+    BBoxArray         _world_bounds {};
+    Vector<uint8>     _visibility {};
+
+    /// @brief Fill @p _visible_render_data with data of geometries currently
+    /// within view
+    virtual void compute_visible_render_data() = 0;
+
+    /**
+     * @brief Cull all geometries of potentially visible meshes against a
+     * given frustum. World space bounds of geometries are computed into
+     * @p _world_bounds and tested in chunks, spread across job system workers
+     * for larger scenes. Results are stored in @p _visibility, in the order of
+     * @p _cull_entries.
+     * @param frustum Frustum geometries are tested against
+     */
+    void cull_geometries(const Frustum& frustum);
+
+    /**
+     * @brief Select level of detail of a geometry from its size on screen.
+     * Full detail is drawn down to half of view height (times @p lod_bias),
+     * and each next level takes over at half the size of the previous one.
+     * Mesh import allows each level twice the error of the previous one, so
+     * that the error stays about the same on screen.
+     * @param geometry Drawn geometry
+     * @param screen_size Diameter of its bounds relative to view height
+     */
+    uint8 select_lod(const Geometry* const geometry, const float32 screen_size)
+        const;
 };
 
 } // namespace ENGINE_NAMESPACE
\ No newline at end of file
@@ -20,9 +20,39 @@ class RenderViewDirectionalShadow : public RenderViewOrthographic {
     glm::mat4 get_view_matrix(glm::vec3 light_dir) const;
     glm::vec3 get_light_camera_position(glm::vec3 light_dir) const;
 
-    Vector<GeometryRenderData>& get_visible_render_data(
-        const uint32 frame_number
-    ) override;
+    /**
+     * @brief Setup culling of shadow casters. Cascades of a light are culled
+     * together, by the first of them. World space bounds of geometries are
+     * computed once for all cascades, and a cascade contained in a larger one
+     * only tests geometries visible to the larger cascade. Preparing the first
+     * cascade prepares all of them, so only it needs to be prepared
+     * concurrently with other views. Without this setup, nothing is culled.
+     * @param light_direction Direction of the light casting the shadows
+     * @param cascades All cascade views of the light (this one included), all
+     * with the same potentially visible meshes
+     */
+    void set_cascades(
+        const glm::vec4* const                      light_direction,
+        const Vector<RenderViewDirectionalShadow*>& cascades
+    );
+
+  protected:
+    const glm::vec4*                     _light_direction = nullptr;
+    Vector<RenderViewDirectionalShadow*> _cascades {};
+
+    void compute_visible_render_data() override;
+
+  private:
+    // Culling state of the first cascade, shared by the others
+    Vector<uint32> _candidates {};
+    BBoxArray      _candidate_bounds {};
+    Vector<uint8>  _candidate_visibility {};
+
+    Frustum get_culling_volume() const;
+    bool    contains_volume(const RenderViewDirectionalShadow* const other
+    ) const;
+    void    cull_cascades();
+    void    add_candidates(RenderViewDirectionalShadow* const cascade) const;
 };
 
 } // namespace ENGINE_NAMESPACE
@@ -27,14 +27,12 @@ class RenderViewOrthographic : public RenderView {
         return get_all_render_data();
     }
 
-    Vector<GeometryRenderData>& get_visible_render_data(
-        const uint32 frame_number
-    ) override;
-
   protected:
     float32 _near_clip;
     float32 _far_clip;
     Camera* _camera;
+
+    void compute_visible_render_data() override;
 };
 
 } // namespace ENGINE_NAMESPACE
\ No newline at end of file
@@ -2,6 +2,8 @@
 
 #include "render_view.hpp"
 #include "renderer/camera.hpp"
+#include "component/occlusion_buffer.hpp"
+#include "component/bvh.hpp"
 
 namespace ENGINE_NAMESPACE {
 
@@ -18,6 +20,12 @@ class RenderViewPerspective : public RenderView {
     Property<Camera*> camera {
         GET { return _camera; }
     };
+    /// @brief If true, geometries hidden behind the largest visible
+    /// geometries aren't rendered (see @p OcclusionBuffer)
+    Property<bool> occlusion_culling {
+        GET { return _occlusion_culling; }
+        SET { _occlusion_culling = value; }
+    };
 
     RenderViewPerspective(const RenderView::Config& config);
     ~RenderViewPerspective();
@@ -25,15 +33,45 @@ class RenderViewPerspective : public RenderView {
     virtual void on_resize(const uint32 width, const uint32 height) override;
 
     Vector<GeometryRenderData>& get_all_render_data() override;
-    Vector<GeometryRenderData>& get_visible_render_data(
-        const uint32 frame_number
-    ) override;
+
+    /**
+     * @brief Find the potentially visible geometry a given ray hits first.
+     * Geometries are tested by their world space bounds, as of the last
+     * prepared frame.
+     * @param ray Cast ray, in world space
+     * @param t Ray param at which the geometry was hit. Unchanged if nothing
+     * was hit
+     * @return Geometry* Hit geometry, or nullptr if nothing was hit
+     */
+    Geometry* ray_cast(const Ray<3>& ray, float32& t) const;
+    /**
+     * @brief Find potentially visible geometries whose world space bounds, as
+     * of the last prepared frame, overlap a given box
+     * @param bbox Tested box, in world space
+     * @param result Found geometries are appended to it
+     */
+    void query_box(const BVH::BBox& bbox, Vector<Geometry*>& result) const;
 
   protected:
     float32 _fov;
     float32 _near_clip;
     float32 _far_clip;
     Camera* _camera;
+
+    // Occlusion culling state
+    bool                               _occlusion_culling = true;
+    OcclusionBuffer                    _occlusion_buffer {};
+    // Occluder candidates, as (size on screen, cull entry index)
+    Vector<std::pair<float32, uint32>> _occluders {};
+
+    // Hierarchy over world space bounds of cull entries, for queries. Updated
+    // after culling, while culling itself tests all bounds linearly
+    BVH _bvh {};
+
+    void compute_visible_render_data() override;
+
+  private:
+    void cull_occluded_geometries();
 };
 
 } // namespace ENGINE_NAMESPACE
\ No newline at end of file
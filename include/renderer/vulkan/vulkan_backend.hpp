@@ -20,8 +20,9 @@ class VulkanBackend : public RendererBackend {
     VulkanBackend(Platform::Surface* const surface);
     ~VulkanBackend() override;
 
-    Result<void, RuntimeError> begin_frame(const float32 delta_time) override;
-    Result<void, RuntimeError> end_frame(const float32 delta_time) override;
+    Result<uint32, RuntimeError> wait_for_frame() override;
+    Result<void, RuntimeError>   begin_frame(const float32 delta_time) override;
+    Result<void, RuntimeError>   end_frame(const float32 delta_time) override;
 
     void resized(const uint32 width, const uint32 height) override;
 
@@ -57,7 +58,14 @@ class VulkanBackend : public RendererBackend {
         const Vector<uint32>&   indices
     ) override;
     void destroy_geometry(Geometry* const geometry) override;
-    void draw_geometry(Geometry* const geometry) override;
+    void draw_geometry(Geometry* const geometry, const uint8 lod) override;
+    void draw_geometry(
+        Geometry* const   geometry,
+        const uint8       lod,
+        const void* const instance_data,
+        const uint32      instance_size,
+        const uint32      instance_count
+    ) override;
 
     // Shader
     Shader* create_shader(
@@ -113,6 +121,25 @@ class VulkanBackend : public RendererBackend {
     // GEOMETRY CODE
     Map<uint32, VulkanGeometryData> _geometries;
 
+    // Buffers bound by the command buffer being recorded, so that consecutive
+    // draws of the same geometry don't bind them again
+    vk::Buffer     _bound_vertex_buffer {};
+    vk::DeviceSize _bound_vertex_offset = 0;
+    vk::Buffer     _bound_index_buffer {};
+    vk::DeviceSize _bound_index_offset  = 0;
+
+    // Per instance attribute values of instanced draws, one persistently
+    // mapped buffer per frame in flight, filled from the start each frame
+    std::array<VulkanBuffer*, VulkanSettings::max_frames_in_flight>
+        _instance_buffers {};
+    std::array<byte*, VulkanSettings::max_frames_in_flight>
+        _instance_buffer_data {};
+    // Buffers outgrown during a frame, destroyed once that frame is done
+    std::array<Vector<VulkanBuffer*>, VulkanSettings::max_frames_in_flight>
+        _retired_instance_buffers {};
+
+    vk::DeviceSize _instance_buffer_offset = 0;
+
     // COMMAND CODE
     VulkanCommandPool*   _command_pool;
     VulkanCommandBuffer* _command_buffer;
@@ -133,6 +160,7 @@ class VulkanBackend : public RendererBackend {
 
     // Utility buffer methods
     void create_buffers();
+    void create_instance_buffer(const uint32 frame, const vk::DeviceSize size);
     void upload_data_to_buffer(
         const void*          data,
         vk::DeviceSize       size,
@@ -142,6 +170,11 @@ class VulkanBackend : public RendererBackend {
 
     // Utility geometry methods
     uint32 generate_geometry_id();
+    void   draw_geometry_instances(
+          Geometry* const geometry,
+          const uint8     lod,
+          const uint32    instance_count
+      );
     void   create_geometry_internal(
           Geometry* const   geometry,
           const uint32      vertex_size,
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "vulkan_image.hpp"
+#include "vulkan_command_pool.hpp"
 
 namespace ENGINE_NAMESPACE {
 
@@ -52,12 +53,15 @@ class VulkanBuffer {
     /// @param offset Offset at which the bind should start at
     virtual void bind(const vk::DeviceSize offset) const;
 
-    /// @brief Resize buffer. Only works for increased buffer the size.
-    /// @param command_buffer Command buffer to witch the resize command will be
-    /// submitted
+    /// @brief Resize buffer. Only works for increased buffer the size. Old
+    /// content is copied to the new buffer on the device, so the buffer must
+    /// be created with eTransferSrc usage. Waits for the queue to finish all
+    /// its work, as the old buffer may still be in use.
+    /// @param command_pool Command pool used for issuing the copy command
     /// @param new_size New buffer size in bytes
     virtual void resize(
-        const vk::CommandBuffer& command_buffer, const vk::DeviceSize new_size
+        const VulkanCommandPool* const command_pool,
+        const vk::DeviceSize           new_size
     );
 
     /// @brief Upload data to buffer
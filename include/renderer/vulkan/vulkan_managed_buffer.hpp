@@ -40,12 +40,13 @@ class VulkanManagedBuffer : public VulkanBuffer {
         const bool                    bind_on_create = true
     ) override;
 
-    /// @brief Resize buffer
-    /// @param command_buffer Command buffer to witch the resize command will be
-    /// submitted
+    /// @brief Resize buffer. Old content is copied over on the device, and all
+    /// previously allocated offsets stay valid.
+    /// @param command_pool Command pool used for issuing the copy command
     /// @param new_size New buffer size in bytes
     void resize(
-        const vk::CommandBuffer& command_buffer, const vk::DeviceSize new_size
+        const VulkanCommandPool* const command_pool,
+        const vk::DeviceSize           new_size
     ) override;
 
     /// @brief Upload data to buffer. If the region denoted by the offset and
@@ -63,6 +64,16 @@ class VulkanManagedBuffer : public VulkanBuffer {
     /// @param size Requested allocation size
     /// @returns In buffer offset at which the allocated region starts.
     vk::DeviceSize allocate(const uint64 size, const uint64 alignment = 8);
+    /// @brief Allocates buffer memory. If there isn't enough free space the
+    /// buffer is resized (at least doubled in size) first.
+    /// @param command_pool Command pool used for issuing the resize copy
+    /// @param size Requested allocation size
+    /// @returns In buffer offset at which the allocated region starts.
+    vk::DeviceSize allocate(
+        const VulkanCommandPool* const command_pool,
+        const uint64                   size,
+        const uint64                   alignment = 8
+    );
 
     /// @brief Deallocates part of the buffer memory.
     /// @param offset In buffer offset at which the allocated region starts.
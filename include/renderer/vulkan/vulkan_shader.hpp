@@ -99,6 +99,7 @@ class VulkanShader : public Shader {
         const Vector<vk::ShaderStageFlagBits>& shader_stages
     ) const;
     Vector<vk::VertexInputAttributeDescription> compute_attributes() const;
+    Vector<vk::VertexInputBindingDescription>   compute_bindings() const;
 
     // TODO: For now all used shader staged are passed to each binding. Some
     // bindings should only be available in a specific stage
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "component/axis_aligned_bbox.hpp"
+#include "containers/relocatable_array.hpp"
 #include "serialization/serializable.hpp"
 #include "renderer/renderer_types.hpp"
 #include "material.hpp"
@@ -22,9 +23,14 @@ class Geometry : public Resource {
       public:
         uint8 dim_count = Dim;
 
-        Vector<Vertex<Dim>>  vertices { { MemoryTag::Geometry } };
-        Vector<uint32>       indices { { MemoryTag::Geometry } };
-        AxisAlignedBBox<Dim> bbox;
+        // Vertex and index data can be moved by memory compaction
+        RelocatableArray<Vertex<Dim>>    vertices { MemoryTag::Geometry };
+        RelocatableArray<uint32>         indices { MemoryTag::Geometry };
+        /// @brief Indices of coarser levels of detail, from the most detailed.
+        /// They index the same vertices as full detail @p indices. Level
+        /// arrays themselves never move, so they are kept out of geometry heap
+        Vector<RelocatableArray<uint32>> lods { { MemoryTag::Resource } };
+        AxisAlignedBBox<Dim>             bbox;
 
         String name;
         String material_name;
@@ -32,21 +38,28 @@ class Geometry : public Resource {
 
         Config() {}
         Config(
-            const String                name,
-            const Vector<Vertex<Dim>>&  vertices,
-            const Vector<uint32>&       indices,
-            const AxisAlignedBBox<Dim>& bbox,
-            const String                material_name = "",
-            const bool                  auto_release  = true
+            const String                  name,
+            const Vector<Vertex<Dim>>&    vertices,
+            const Vector<uint32>&         indices,
+            const AxisAlignedBBox<Dim>&   bbox,
+            const String                  material_name = "",
+            const bool                    auto_release  = true,
+            const Vector<Vector<uint32>>& lods          = {}
         )
-            : name(name), vertices(vertices), indices(indices), bbox(bbox),
-              material_name(material_name), auto_release(auto_release) {}
+            : name(name), vertices(vertices, MemoryTag::Geometry),
+              indices(indices, MemoryTag::Geometry), bbox(bbox),
+              material_name(material_name), auto_release(auto_release) {
+            this->lods.reserve(lods.size());
+            for (const auto& lod : lods)
+                this->lods.emplace_back(lod, MemoryTag::Geometry);
+        }
         virtual ~Config() {}
 
         serializable_attributes(
             dim_count,
             vertices,
             indices,
+            lods,
             bbox,
             name,
             material_name,
@@ -63,6 +76,14 @@ class Geometry : public Resource {
      */
     typedef Config<3> Config3D;
 
+    /**
+     * @brief Range of the index buffer drawn at a single level of detail
+     */
+    struct LOD {
+        uint32 first_index;
+        uint32 index_count;
+    };
+
   public:
     /// @brief Id used by the Renderer
     std::optional<uint64> internal_id;
@@ -71,11 +92,19 @@ class Geometry : public Resource {
         GET { return _material; }
         SET { _material = value; }
     };
+    /// @brief Index ranges of all levels of detail, from full detail. Empty if
+    /// the whole index buffer is always drawn
+    Vector<LOD>           lods { { MemoryTag::Geometry } };
 
     Geometry(String name);
     ~Geometry();
 
+    /// @brief Number of levels of detail, full detail included
+    uint8 lod_count() const { return lods.empty() ? 1 : lods.size(); }
+
     const static uint32 max_name_length = 256;
+    /// @brief Levels of detail a geometry can have at most (see RenderQueue)
+    const static uint8  max_lod_count   = 4;
 
   private:
     Material* _material = nullptr;
@@ -96,9 +125,18 @@ class Geometry3D : public Geometry {
   public:
     typedef AxisAlignedBBox<3> BBox;
 
+    /// @brief Geometries with more triangles don't keep an occluder copy
+    const static uint32 max_occluder_triangle_count = 4096;
+
     /// @brief Axis aligned bounding box containing all of geometry.
     BBox bbox;
 
+    /// @brief Vertex positions kept on the CPU for occlusion culling. Empty
+    /// for geometries with too many triangles
+    Vector<glm::vec3> occluder_vertices { { MemoryTag::Geometry } };
+    /// @brief Triangle list indices into @p occluder_vertices
+    Vector<uint32>    occluder_indices { { MemoryTag::Geometry } };
+
     Geometry3D(const String& name, const BBox& bbox)
         : Geometry(name), bbox(bbox) {}
 
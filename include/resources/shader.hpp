@@ -87,11 +87,15 @@ class Shader {
     /// @brief Determines what face culling mode will be used during rendering
     enum class CullMode { None, Front, Back, Both };
 
+    /// @brief Rate at which attribute values advance
+    enum class AttributeRate : uint8 { Vertex, Instance };
+
     /// @brief Structure containing all attribute relevant data
     struct Attribute {
         String        name;
         uint32        size;
         AttributeType type;
+        AttributeRate rate = AttributeRate::Vertex;
     };
 
     /// @brief Structure containing all uniform relevant data
@@ -378,7 +382,9 @@ class Shader {
 
     // Attributes
     Vector<Attribute> _attributes {};
-    uint16            _attribute_stride = 0;
+    uint16            _attribute_stride          = 0;
+    // Per instance attributes are read from a separate buffer
+    uint16            _instance_attribute_stride = 0;
 
     // Named uniforms
     // This vector holds the actual uniform structs
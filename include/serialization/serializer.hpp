@@ -1,6 +1,7 @@
 #pragma once
 
 #include "serializable.hpp"
+#include "containers/relocatable_array.hpp"
 #include "logger.hpp"
 #include "math_libs.hpp"
 #include "outcome.hpp"
@@ -188,8 +189,32 @@ class Serializer {
   private:
     template<typename T>
     void serialize_type(String& out_str, const Vector<T>& data) const {
+        serialize_sequence(out_str, data);
+    }
+    template<typename T>
+    void serialize_type(String& out_str, const RelocatableArray<T>& data)
+        const {
+        serialize_sequence(out_str, data);
+    }
+
+    template<typename T>
+    Outcome deserialize_type(
+        const String& in_str, Vector<T>& data, uint32& position
+    ) const {
+        return deserialize_sequence(in_str, data, position);
+    }
+    template<typename T>
+    Outcome deserialize_type(
+        const String& in_str, RelocatableArray<T>& data, uint32& position
+    ) const {
+        return deserialize_sequence(in_str, data, position);
+    }
+
+    // Vector like containers
+    template<typename C>
+    void serialize_sequence(String& out_str, const C& data) const {
         const auto count = data.size();
-        const auto size  = sizeof(T);
+        const auto size  = sizeof(typename C::value_type);
         vector_add_beg(out_str, count, size);
         for (uint64 i = 0; i < count; i++) {
             if (i != 0) vector_add_sep(out_str, count, size, i);
@@ -198,12 +223,12 @@ class Serializer {
         vector_add_end(out_str, count, size);
     }
 
-    template<typename T>
-    Outcome deserialize_type(
-        const String& in_str, Vector<T>& data, uint32& position
+    template<typename C>
+    Outcome deserialize_sequence(
+        const String& in_str, C& data, uint32& position
     ) const {
         uint64     count = 0;
-        const auto size  = sizeof(T);
+        const auto size  = sizeof(typename C::value_type);
 
         // Deserialize beginning
         if (vector_remove_beg(in_str, count, size, position).failed())
@@ -26,10 +26,11 @@ class FileIn : public std::ifstream {
     using std::ifstream::ifstream;
 
     String read(const uint64 size) {
-        char* buffer = new (MemoryTag::Temp) char(size);
-        auto  n      = std::ifstream::readsome(buffer, size);
-        if (n) return String(std::string(buffer, n));
-        return "";
+        char* const buffer = new (MemoryTag::Temp) char[size];
+        const auto  n      = std::ifstream::readsome(buffer, size);
+        const auto  result = n ? String(buffer, n) : String();
+        del(buffer);
+        return result;
     }
 };
 /**
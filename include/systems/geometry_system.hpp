@@ -7,7 +7,9 @@ namespace ENGINE_NAMESPACE {
 
 /**
  * @brief Geometry system is responsible for the management of geometries, as
- * well as reference counting.
+ * well as reference counting. Auto released geometries stay cached once
+ * unreferenced, and are unloaded only once resource memory runs over its
+ * budget, least recently used first.
  */
 class GeometrySystem {
   public:
@@ -39,9 +41,10 @@ class GeometrySystem {
      * @brief Acquire already loaded geometry resource.
      *
      * @param id Requested geometry id
-     * @return Geometry*
+     * @return Geometry* Requested geometry, or default geometry if @p id is
+     * invalid or stale (geometry was already released)
      */
-    Geometry* acquire(const uint32 id);
+    Geometry* acquire(const uint64 id);
     /**
      * @brief Creates new geometry resource and load its material
      *
@@ -60,7 +63,8 @@ class GeometrySystem {
     /**
      * @brief Releases geometry resource. Geometry system will automatically
      * release this geometry from memory if no other references to it are
-     * detected and auto release flag is set to true.
+     * detected and auto release flag is set to true. Until then it stays
+     * cached and can be acquired again by its id.
      * @param geometry Geometry to release
      */
     void release(Geometry* geometry);
@@ -113,7 +117,11 @@ class GeometrySystem {
         Geometry* handle;
         uint64    reference_count;
         bool      auto_release;
+
+        // Position among unused geometries, valid only while unreferenced
+        List<Handle<Geometry>>::iterator unused_entry;
     };
+    typedef SlotMap<GeometryRef, Geometry>::HandleType GeometryHandle;
 
     Renderer*       _renderer;
     MaterialSystem* _material_system;
@@ -127,11 +135,16 @@ class GeometrySystem {
     Geometry* _default_geometry    = nullptr;
     Geometry* _default_2d_geometry = nullptr;
 
-    UnorderedMap<uint32, GeometryRef> _registered_geometries {};
+    SlotMap<GeometryRef, Geometry> _registered_geometries {};
+
+    // Unreferenced auto released geometries, least recently used first
+    List<GeometryHandle> _unused_geometries {};
+    uint64               _eviction_callback_ids[2] {};
 
     template<uint8 Dim>
     Geometry* acquire_internal(const Geometry::Config<Dim>& config);
     void      create_default_geometries();
+    bool      evict_geometry();
 };
 
 } // namespace ENGINE_NAMESPACE
\ No newline at end of file
@@ -2,12 +2,16 @@
 
 #include "shader_system.hpp"
 #include "resources/material.hpp"
+#include "slot_map.hpp"
+#include "list.hpp"
 
 namespace ENGINE_NAMESPACE {
 
 /**
  * @brief Material system is responsible for management of materials in the
- * engine, including reference counting an auto-unloading.
+ * engine, including reference counting an auto-unloading. Auto released
+ * materials stay cached once unreferenced, and are unloaded only once material
+ * memory runs over its budget, least recently used first.
  */
 class MaterialSystem {
   public:
@@ -58,13 +62,21 @@ class MaterialSystem {
     /// detected and auto release flag is set to true.
     /// @param name Name of the released material
     void      release(const String name);
+    /// @brief Releases material resource. Same as release by name, but the
+    /// material is found directly through its id (a generational handle).
+    /// @param material Released material
+    void      release(const Material* const material);
 
   private:
     struct MaterialRef {
         Material* handle;
         uint64    reference_count;
         bool      auto_release;
+
+        // Position among unused materials, valid only while unreferenced
+        List<Handle<Material>>::iterator unused_entry;
     };
+    typedef SlotMap<MaterialRef, Material>::HandleType MaterialHandle;
 
     Renderer*       _renderer;
     ResourceSystem* _resource_system;
@@ -74,11 +86,25 @@ class MaterialSystem {
     const uint64 _max_material_count    = 1024;
     const String _default_material_name = "default";
 
-    Material*                         _default_material = nullptr;
-    UnorderedMap<String, MaterialRef> _registered_materials {};
+    Material* _default_material = nullptr;
+
+    // Material references are densely stored and referenced by material id,
+    // names are only used to find the id
+    SlotMap<MaterialRef, Material>       _registered_materials {};
+    UnorderedMap<String, MaterialHandle> _material_lookup {};
+
+    // Unreferenced auto released materials, least recently used first
+    List<MaterialHandle> _unused_materials {};
+    uint64               _eviction_callback_id = 0;
 
     void create_default_material();
 
+    MaterialRef* find_material(const String& key);
+    Material*    register_material(const String& key, const MaterialRef& ref);
+    void         release_material(const MaterialHandle handle);
+    void         reference_material(MaterialRef* const ref);
+    bool         evict_material();
+
     Result<MaterialRef, RuntimeError> create_material(
         const Material::Config& config
     );
@@ -2,6 +2,8 @@
 
 #include "defines.hpp"
 
+#include <atomic>
+
 namespace ENGINE_NAMESPACE {
 
 #define ALLOCATOR_LOG "Allocator :: "
@@ -18,9 +20,11 @@ class Allocator {
     /// @brief Total size allocatable by this allocator
     uint64 total_size() { return _total_size; };
     /// @brief Memory currently used
-    uint64 used() { return _used; };
+    uint64 used() { return _used.load(std::memory_order_relaxed); };
     /// @brief Peek memory usage of this allocator
     uint64 peak() { return _peak; };
+    /// @brief Size of reserved address range this allocator can grow into
+    uint64 reserved_size() { return _reserved_size; };
 
     Allocator(const uint64 total_size)
         : _total_size { total_size }, _used { 0 }, _peak { 0 } {}
@@ -31,7 +35,29 @@ class Allocator {
      * operations.
      *
      */
-    virtual void  init();
+    virtual void   init();
+    /**
+     * @brief Initialize allocator over an already reserved memory segment of
+     * at least @p total_size bytes. Segment stays owned by the caller. Can be
+     * used instead of @p init().
+     *
+     * @param memory Start of the memory segment
+     * @param reserved_size Size of the reserved virtual address range starting
+     * at @p memory. Only first @p total_size bytes need to be commited, rest
+     * is commited on demand if growth is enabled (def = 0, no growth)
+     */
+    void           init_at(void* const memory, const uint64 reserved_size = 0);
+    /**
+     * @brief Allow allocator to grow once it runs out of memory. Growth is
+     * possible only for allocators initialized with @p init_at() over a
+     * reserved range.
+     *
+     * @param growth_step Minimal number of bytes added per growth
+     * @param size_limit Hard limit on total size. Capped to reserved size
+     */
+    virtual void   set_growth(
+        const uint64 growth_step, const uint64 size_limit
+    );
     /**
      * @brief Allocate memory segment
      *
@@ -39,19 +65,19 @@ class Allocator {
      * @param alignment Required memory alignment (by default disabled).
      * @return void* to the beginning of the allocated segment
      */
-    virtual void* allocate(const uint64 size, const uint64 alignment = 0);
+    virtual void*  allocate(const uint64 size, const uint64 alignment = 0);
     /**
      * @brief Free allocated memory
      *
      * @param ptr Pointer to an allocated segment (Behavior for invalid input is
      * determined by the specific allocator implementation)
      */
-    virtual void  free(void* ptr);
+    virtual void   free(void* ptr);
     /**
      * @brief Resets all allocations (Relevant only for some allocators)
      *
      */
-    virtual void  reset();
+    virtual void   reset();
     /**
      * @brief Checks if a memory location was allocated by this allocator
      *
@@ -59,13 +85,98 @@ class Allocator {
      * @returns true If relevant memory was allocated by this allocator
      * @returns false Otherwise
      */
-    virtual bool  owns(void* ptr);
+    virtual bool   owns(void* ptr);
+    /**
+     * @brief Usable size of an allocated memory segment (Relevant only for
+     * some allocators)
+     *
+     * @param ptr Pointer to an allocated segment
+     * @returns uint64 Number of bytes usable from @p ptr onward, or 0 if this
+     * allocator doesn't keep track of allocation sizes
+     */
+    virtual uint64 allocation_size(void* ptr);
+    /**
+     * @brief Size of the largest contiguous free memory segment (Relevant only
+     * for some allocators)
+     *
+     * @returns uint64 Segment size in bytes, or 0 if this allocator doesn't
+     * keep track of free segments
+     */
+    virtual uint64 largest_free_block();
+
+    /**
+     * @brief Receives allocation moves made during compaction
+     */
+    class Relocator {
+      public:
+        /// @brief Whether allocation starting at @p ptr can be moved
+        virtual bool can_relocate(void* const ptr)                       = 0;
+        /// @brief Called once allocation content was moved to @p new_ptr
+        virtual void relocated(void* const old_ptr, void* const new_ptr) = 0;
+    };
+
+    /**
+     * @brief Move relocatable allocations towards the beginning of owned
+     * memory, so that free segments merge together (Relevant only for some
+     * allocators). Work is done incrementally, each call continuing where the
+     * previous one stopped.
+     *
+     * @param relocator Decides which allocations can move, notified of moves
+     * @param max_bytes Number of moved bytes after which the call returns
+     * @returns true If there is work left
+     * @returns false If a whole pass over owned memory has been completed
+     */
+    virtual bool   compact(Relocator& relocator, const uint64 max_bytes);
+    /// @brief Whether @p compact() can move allocations of this allocator
+    virtual bool   supports_compaction();
 
   protected:
     void*  _start_ptr = nullptr;
     uint64 _total_size;
-    uint64 _used;
-    uint64 _peak;
+    // Read without the allocator's own synchronization (by memory budget
+    // checks), so kept atomic. Writers are serialized by the allocator, so
+    // updates need neither ordering nor read-modify-write operations
+    std::atomic<uint64> _used;
+    uint64              _peak;
+    uint64              _reserved_size = 0;
+    uint64              _growth_step   = 0;
+    uint64              _size_limit    = 0;
+    // Start pointer was obtained by init() and has to be freed
+    bool                _owns_memory   = false;
+
+    /// @brief Record @p size more bytes as used, updating peak usage
+    void increase_used(const uint64 size) {
+        set_used(_used.load(std::memory_order_relaxed) + size);
+    }
+    /// @brief Record @p size bytes as no longer used
+    void decrease_used(const uint64 size) {
+        _used.store(
+            _used.load(std::memory_order_relaxed) - size,
+            std::memory_order_relaxed
+        );
+    }
+    /// @brief Set memory usage, updating peak usage
+    void set_used(const uint64 used) {
+        _used.store(used, std::memory_order_relaxed);
+        if (used > _peak) _peak = used;
+    }
+
+    /**
+     * @brief Try to increase total size by commiting more of the reserved
+     * range. Used by allocators once they run out of memory.
+     *
+     * @param min_size Minimal number of additional bytes required
+     * @returns true If total size was increased by at least @p min_size
+     * @returns false If growth is disabled or the size limit would be exceeded
+     */
+    bool         grow(const uint64 min_size);
+    /**
+     * @brief Make memory gained by growth available for allocation. Called
+     * right after total size is increased.
+     *
+     * @param old_size Total size before the growth
+     */
+    virtual void on_grow([[maybe_unused]] const uint64 old_size) {}
 
     static const uint64 calculate_padding(
         const uint64 base_address, const uint64 alignment
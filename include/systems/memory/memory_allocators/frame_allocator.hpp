@@ -0,0 +1,56 @@
+#pragma once
+
+#include "allocator.hpp"
+
+#include <atomic>
+
+namespace ENGINE_NAMESPACE {
+
+/**
+ * @brief Frame allocator. Reserved memory is split into equally sized arenas,
+ * one per frame in flight. All allocations are made linearly from the arena of
+ * the current frame and are never freed individually. Instead, an arena is
+ * cleared in bulk once its frame comes around again. Allocation is lock free
+ * and safe to call from multiple threads.
+ */
+class FrameAllocator : public Allocator {
+  public:
+    /// @brief Maximum supported number of frames in flight
+    static constexpr uint32 max_frame_count = 8;
+
+    /**
+     * @brief Construct a new Frame Allocator object
+     *
+     * @param total_size Total size of all arenas combined
+     * @param frame_count Number of frames in flight (one arena per frame)
+     */
+    FrameAllocator(const uint64 total_size, const uint32 frame_count);
+
+    virtual void* allocate(const uint64 size, const uint64 alignment = 0)
+        override;
+    virtual void  free(void* ptr) override;
+    virtual void  reset() override;
+
+    /**
+     * @brief Make arena of a given frame the current one. All memory
+     * previously allocated in that arena is released, so this should only be
+     * called once the frame isn't in use anymore (e.g. its fence has been
+     * signaled). Usage statistics are also updated only here.
+     *
+     * @param frame_index Index of the frame in flight
+     */
+    void begin_frame(const uint32 frame_index);
+
+  private:
+    const uint32        _frame_count;
+    const uint64        _arena_size;
+    uint32              _current_frame = 0;
+    uint64              _arena_used[max_frame_count] {};
+    std::atomic<uint64> _offset { 0 };
+
+    FrameAllocator(FrameAllocator& frame_allocator);
+
+    uint64 arena_start(const uint32 frame_index) const;
+};
+
+} // namespace ENGINE_NAMESPACE
\ No newline at end of file
@@ -12,10 +12,19 @@ namespace ENGINE_NAMESPACE {
  * If a specific allocation is too small produces a warning. Owns method will
  * return true if given memory location is within the initial reserve.
  *
+ * With FindFirst and FindBest policies all free segments are kept in one
+ * address sorted list, so both (de)allocations take time linear in the number
+ * of free segments. SegregatedFit policy instead keeps free segments in a two
+ * level array of size segregated lists (TLSF), with neighbouring segments
+ * linked through their headers, for constant time (de)allocations. Only this
+ * policy supports compaction, which moves relocatable allocations into a
+ * fitting free segment at a lower address, or slides them down into the free
+ * segment right before them.
+ *
  */
 class FreeListAllocator : public Allocator {
   public:
-    enum PlacementPolicy { FindFirst, FindBest };
+    enum PlacementPolicy { FindFirst, FindBest, SegregatedFit };
 
     /**
      * @brief Construct a new Free List Allocator object
@@ -28,11 +37,19 @@ class FreeListAllocator : public Allocator {
     FreeListAllocator(
         const uint64 total_size, const PlacementPolicy placement_policy
     );
+    ~FreeListAllocator();
 
     virtual void* allocate(const uint64 size, const uint64 alignment = 0)
         override;
-    virtual void free(void* ptr) override;
-    virtual void reset() override;
+    virtual void   free(void* ptr) override;
+    virtual void   reset() override;
+    virtual uint64 allocation_size(void* ptr) override;
+    virtual uint64 largest_free_block() override;
+    virtual void   set_growth(const uint64 growth_step, const uint64 size_limit)
+        override;
+    virtual bool   compact(Relocator& relocator, const uint64 max_bytes)
+        override;
+    virtual bool   supports_compaction() override;
 
   private:
     struct FreeHeader {
@@ -50,6 +67,8 @@ class FreeListAllocator : public Allocator {
 
     FreeListAllocator(FreeListAllocator& free_list_allocator);
 
+    virtual void on_grow(const uint64 old_size) override;
+
     void find(
         const uint64 size,
         const uint64 alignment,
@@ -73,6 +92,62 @@ class FreeListAllocator : public Allocator {
     );
 
     void coalescence(Node* prev_block, Node* free_block);
+
+    // Segregated fit
+    struct Block {
+        Block* prev_physical;
+        uint64 size_and_flags;
+        // Valid only for free blocks
+        Block* next_free;
+        Block* prev_free;
+
+        uint64 size() const { return size_and_flags & ~free_flag; }
+        bool   is_free() const { return size_and_flags & free_flag; }
+
+        static constexpr uint64 free_flag = 1;
+    };
+
+    // Blocks are 16 byte aligned. Sizes below 256 are split into 16 linear
+    // classes, while each power of two above is split into 16 sub-classes
+    static constexpr uint64 block_header_size = 2 * sizeof(uint64);
+    static constexpr uint64 min_block_size    = sizeof(Block);
+    static constexpr uint64 block_alignment   = 16;
+    static constexpr uint32 sl_index_log2     = 4;
+    static constexpr uint32 sl_index_count    = 1 << sl_index_log2;
+    static constexpr uint32 fl_index_shift    = sl_index_log2 + 4;
+    static constexpr uint32 fl_index_max      = 32;
+    static constexpr uint32 fl_index_count = fl_index_max - fl_index_shift + 1;
+    static constexpr uint64 small_block_size  = 1 << fl_index_shift;
+
+    struct SegregatedLists {
+        uint32 fl_bitmap;
+        uint32 sl_bitmap[fl_index_count];
+        Block* heads[fl_index_count][sl_index_count];
+    };
+
+    // Compaction resumes from the cursor block, visiting a limited number of
+    // blocks per call
+    static constexpr uint32 compaction_scan_limit = 1024;
+
+    SegregatedLists* _segregated_lists  = nullptr;
+    Block*           _last_block        = nullptr;
+    Block*           _compaction_cursor = nullptr;
+
+    void*  allocate_segregated(const uint64 size, const uint64 alignment);
+    Block* free_segregated(void* ptr);
+    void   reset_segregated();
+    void   grow_segregated(const uint64 old_size);
+
+    void   mapping_insert(const uint64 size, uint32& fl, uint32& sl) const;
+    void   mapping_search(const uint64 size, uint32& fl, uint32& sl) const;
+    Block* find_suitable(uint32& fl, uint32& sl) const;
+    void   insert_free_block(Block* const block);
+    void   remove_free_block(Block* const block);
+    Block* next_physical(const Block* const block) const;
+    Block* split(Block* const block, const uint64 size);
+    Block* merge(Block* const left, Block* const right);
+    Block* slide(Block* const gap, Block* const block);
+    Block* move_block(Block* const target, Block* const block);
 };
 
 } // namespace ENGINE_NAMESPACE
\ No newline at end of file
@@ -1,7 +1,6 @@
 #pragma once
 
-#include "forward_list.hpp"
-#include "map.hpp"
+#include "allocator.hpp"
 
 namespace ENGINE_NAMESPACE {
 
@@ -10,13 +9,16 @@ namespace ENGINE_NAMESPACE {
  * mostly for management of GPU buffers from the host. Segment headers are saved
  * in host memory, while GPU local memory houses only the actual data.
  * Allocations will return only a relative address (compared to some initial in
- * buffer offset), rather then a full GPU memory specific address. Otherwise
- * this allocator is in function identical to Free list allocator.
+ * buffer offset), rather then a full GPU memory specific address.
+ *
+ * Free segments are kept in a two level array of size segregated lists (TLSF),
+ * so both (de)allocations take constant time. Segment headers are stored in a
+ * host side pool which only grows (geometrically) once it runs out, and
+ * allocated segments are found by their offset through an open addressing hash
+ * table. No host memory is allocated per (de)allocation.
  */
 class GPUFreeListAllocator : public Allocator {
   public:
-    enum PlacementPolicy { FindFirst, FindBest };
-
     /**
      * @brief Construct a new GPUFreeListAllocator object
      *
@@ -24,20 +26,40 @@ class GPUFreeListAllocator : public Allocator {
      * allocate
      * @param begin_offset Initial in-buffer offset. Allocations will return
      * addresses in relation to this offset.
-     * @param placement_policy Placement placement policy used when deciding
-     * which of the free segments will be used for allocation
      */
-    GPUFreeListAllocator(
-        const uint64          total_size,
-        const uint64          begin_offset,
-        const PlacementPolicy placement_policy
-    );
+    GPUFreeListAllocator(const uint64 total_size, const uint64 begin_offset);
+    ~GPUFreeListAllocator();
 
-    virtual void  init() override;
-    virtual void* allocate(const uint64 size, const uint64 alignment = 0)
+    virtual void   init() override;
+    virtual void*  allocate(const uint64 size, const uint64 alignment = 0)
         override;
-    virtual void free(void* ptr) override;
-    virtual void reset() override;
+    virtual void   free(void* ptr) override;
+    virtual void   reset() override;
+    virtual uint64 allocation_size(void* ptr) override;
+    virtual uint64 largest_free_block() override;
+
+    /**
+     * @brief Try to allocate a memory segment. Unlike @p allocate() doesn't
+     * raise an error once out of memory.
+     *
+     * @param size Size requirement in bytes
+     * @param alignment Required offset alignment
+     * @param offset Offset of the allocated segment, if successful
+     * @returns true If segment was allocated
+     * @returns false If no free segment is large enough
+     */
+    bool try_allocate(
+        const uint64 size, const uint64 alignment, uint64& offset
+    );
+
+    /**
+     * @brief Increase total size managed by this allocator. Added memory is
+     * appended after the current end. Should be called once the underlying
+     * buffer has been resized.
+     *
+     * @param new_size New total size, must be larger then the current one
+     */
+    void resize(const uint64 new_size);
 
     /**
      * @brief Check if a memory segment is allocated here by this allocator.
@@ -51,46 +73,71 @@ class GPUFreeListAllocator : public Allocator {
     bool allocated(const void* ptr, const uint64 size);
 
   private:
-    struct FreeHeader {
-        uint64 block_size;
+    // Blocks are referenced by their index in the block pool
+    struct Block {
         uint64 offset;
+        uint64 size;
+        uint32 prev_physical;
+        uint32 next_physical;
+        // Valid only for free blocks (next_free also links unused blocks)
+        uint32 prev_free;
+        uint32 next_free;
+        bool   is_free;
     };
-    struct AllocationHeader {
-        uint64 block_size;
-        uint8  padding;
+    struct AllocationEntry {
+        uint64 offset;
+        uint32 block;
     };
 
-    typedef ForwardList<FreeHeader>::iterator Node;
+    static constexpr uint32 invalid_index = (uint32) -1;
+
+    // Block sizes are multiples of 4. Sizes below 64 are split into 16 linear
+    // classes, while each power of two above is split into 16 sub-classes
+    static constexpr uint64 block_alignment  = 4;
+    static constexpr uint32 sl_index_log2    = 4;
+    static constexpr uint32 sl_index_count   = 1 << sl_index_log2;
+    static constexpr uint32 fl_index_shift   = sl_index_log2 + 2;
+    static constexpr uint32 fl_index_max     = 63;
+    static constexpr uint32 fl_index_count = fl_index_max - fl_index_shift + 1;
+    static constexpr uint64 small_block_size = 1 << fl_index_shift;
+    static constexpr uint32 initial_capacity = 64;
+
+    // Segregated lists
+    uint64 _fl_bitmap = 0;
+    uint32 _sl_bitmap[fl_index_count];
+    uint32 _heads[fl_index_count][sl_index_count];
 
-    PlacementPolicy               _placement_policy;
-    ForwardList<FreeHeader>       _free_list {};
-    Map<uint64, AllocationHeader> _allocated {};
+    // Block pool
+    Block* _blocks         = nullptr;
+    uint32 _block_capacity = 0;
+    uint32 _unused_head    = invalid_index;
+    uint32 _last_block     = invalid_index;
+
+    // Allocated blocks, by offset
+    AllocationEntry* _allocations      = nullptr;
+    uint32           _allocation_mask  = 0;
+    uint32           _allocation_count = 0;
 
     GPUFreeListAllocator(GPUFreeListAllocator& free_list_allocator);
 
-    void find(
-        const uint64 size,
-        const uint64 alignment,
-        uint64&      padding,
-        Node&        previous_node,
-        Node&        found_node
-    );
-    void find_best(
-        const uint64 size,
-        const uint64 alignment,
-        uint64&      padding,
-        Node&        previous_node,
-        Node&        found_node
-    );
-    void find_first(
-        const uint64 size,
-        const uint64 alignment,
-        uint64&      padding,
-        Node&        previous_node,
-        Node&        found_node
+    uint32 create_block(
+        const uint64 offset, const uint64 size, const uint32 prev_physical
     );
+    void   destroy_block(const uint32 block);
+    void   grow_block_pool();
+
+    void   mapping_insert(const uint64 size, uint32& fl, uint32& sl) const;
+    void   mapping_search(const uint64 size, uint32& fl, uint32& sl) const;
+    uint32 find_suitable(uint32& fl, uint32& sl) const;
+    void   insert_free_block(const uint32 block);
+    void   remove_free_block(const uint32 block);
+    uint32 split(const uint32 block, const uint64 size);
+    uint32 merge(const uint32 left, const uint32 right);
 
-    void coalescence(Node prev_block, Node free_block);
+    uint32 find_allocation(const uint64 offset) const;
+    void   insert_allocation(const uint64 offset, const uint32 block);
+    void   remove_allocation(const uint64 offset);
+    void   rehash_allocations(const uint32 table_size);
 };
 
 } // namespace ENGINE_NAMESPACE
\ No newline at end of file
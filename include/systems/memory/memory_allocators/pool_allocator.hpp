@@ -23,8 +23,9 @@ class PoolAllocator : public Allocator {
 
     virtual void* allocate(const uint64 size, const uint64 alignment = 0)
         override;
-    virtual void free(void* ptr) override;
-    virtual void reset() override;
+    virtual void   free(void* ptr) override;
+    virtual void   reset() override;
+    virtual uint64 allocation_size(void* ptr) override;
 
   private:
     struct FreeHeader {};
@@ -34,6 +35,10 @@ class PoolAllocator : public Allocator {
     uint64 _chunk_size;
 
     PoolAllocator(PoolAllocator& pool_allocator);
+
+    virtual void on_grow(const uint64 old_size) override;
+
+    void push_chunks(const uint64 first, const uint64 last);
 };
 
 } // namespace ENGINE_NAMESPACE
\ No newline at end of file
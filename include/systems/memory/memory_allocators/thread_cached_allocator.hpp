@@ -0,0 +1,111 @@
+#pragma once
+
+#include "allocator.hpp"
+
+#include <atomic>
+#include <tbb/spin_mutex.h>
+
+namespace ENGINE_NAMESPACE {
+
+/**
+ * @brief Thread safe front for another (backing) allocator. Backing allocator
+ * is shared by all threads and is accessed only under lock. If caching is
+ * enabled, each thread also keeps small per-thread caches (magazines) of free
+ * blocks, so most (de)allocations never touch the backing allocator. Lock is
+ * then taken only when a magazine needs to be refilled or flushed. Memory held
+ * by magazines counts as used by the backing allocator.
+ */
+class ThreadCachedAllocator : public Allocator {
+  public:
+    enum class CachePolicy {
+        /// @brief No caching, every operation locks backing allocator
+        Disabled,
+        /// @brief All blocks are of the same size (Used for pool allocators)
+        FixedSize,
+        /// @brief Blocks are cached by power of two size classes. Requires
+        /// backing allocator to implement @p allocation_size()
+        SizeClasses
+    };
+
+    /**
+     * @brief Construct a new Thread Cached Allocator object
+     *
+     * @param backing Already initialized allocator all memory is taken from
+     * @param policy Determines which blocks can be cached per thread
+     * @param block_size Block size of a fixed size backing allocator. Used
+     * only with @p CachePolicy::FixedSize
+     */
+    ThreadCachedAllocator(
+        Allocator* const  backing,
+        const CachePolicy policy,
+        const uint64      block_size = 0
+    );
+
+    virtual void   init() override;
+    virtual void*  allocate(const uint64 size, const uint64 alignment = 0)
+        override;
+    virtual void   free(void* ptr) override;
+    virtual void   reset() override;
+    virtual bool   owns(void* ptr) override;
+    virtual uint64 allocation_size(void* ptr) override;
+    virtual uint64 largest_free_block() override;
+    virtual void   set_growth(const uint64 growth_step, const uint64 size_limit)
+        override;
+    /// @brief Compacts backing allocator. Relocator is called under lock, so
+    /// it must not use this allocator. Blocks held by magazines can't move
+    virtual bool   compact(Relocator& relocator, const uint64 max_bytes)
+        override;
+    virtual bool   supports_compaction() override;
+
+    /**
+     * @brief Return all blocks cached by the calling thread to their backing
+     * allocators. Done automatically on thread exit.
+     */
+    static void flush_thread_caches();
+
+  private:
+    // Size classes are powers of two in range [16, 512]
+    static constexpr uint32 max_instances    = 16;
+    static constexpr uint32 size_class_count = 6;
+    static constexpr uint64 min_class_shift  = 4;
+    static constexpr uint64 min_class_size   = 16;
+    static constexpr uint64 max_cached_size  = 512;
+    static constexpr uint32 magazine_size    = 32;
+    // Size class blocks are cached only if they meet this alignment
+    static constexpr uint64 cache_alignment  = 16;
+
+    struct Magazine {
+        uint32 count;
+        void*  blocks[magazine_size];
+    };
+    struct ThreadCache {
+        Magazine magazines[max_instances][size_class_count];
+        uint64   epoch[max_instances];
+    };
+
+    Allocator* const       _backing;
+    const CachePolicy      _policy;
+    const uint64           _block_size;
+    uint32                 _instance_index;
+    std::atomic<uint64>    _epoch { 0 };
+    tbb::spin_mutex        _lock {};
+
+    static ThreadCachedAllocator* _instances[max_instances];
+    static std::atomic<uint32>    _instance_count;
+
+    ThreadCachedAllocator(ThreadCachedAllocator& thread_cached_allocator);
+
+    static ThreadCache* get_thread_cache();
+
+    Magazine* get_magazine(const uint32 size_class);
+    void*     allocate_shared(const uint64 size, const uint64 alignment);
+    void      free_shared(void* const ptr);
+    void      refill(Magazine* const magazine, const uint32 size_class);
+    void      flush(Magazine* const magazine, const uint32 count);
+    void      flush_all(Magazine* const magazines);
+    void      lock();
+    void      unlock();
+    void      synchronize_usage();
+};
+
+} // namespace ENGINE_NAMESPACE
\ No newline at end of file
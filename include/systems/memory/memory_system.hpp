@@ -5,17 +5,28 @@
 #include "memory_allocators/stack_allocator.hpp"
 #include "memory_allocators/pool_allocator.hpp"
 #include "memory_allocators/free_list_allocator.hpp"
+#include "memory_allocators/frame_allocator.hpp"
+#include "memory_allocators/thread_cached_allocator.hpp"
 
 #include <iostream>
-#include <map>
 #include <type_traits>
 #include <memory>
+#include <functional>
+#include <nlohmann/json_fwd.hpp>
 
 namespace ENGINE_NAMESPACE {
 
 typedef uint16 MemoryTagType;
 #define MEMORY_PADDING 8
 
+// Collect per tag allocation statistics (See MemorySystem::get_telemetry)
+#define MEMORY_TELEMETRY 1
+// Back large, randomly accessed allocators with transparent huge pages
+#define MEMORY_HUGE_PAGES 1
+// Record each live allocation together with its call stack, so that leaks can
+// be reported (See MemorySystem::report_leaks). Slow, meant for debugging only
+#define MEMORY_TRACKING 0
+
 // Size reference points
 #define KB 1024
 #define MB KB * 1024
@@ -31,6 +42,9 @@ enum class MemoryTag : MemoryTagType {
     // created.
     Unknown,
     Temp,
+    // Transient data valid only during a single frame. Never needs to be
+    // freed, see MemorySystem::begin_frame.
+    Frame,
     // Data types
     Array,
     List,
@@ -100,6 +114,117 @@ class MemorySystem {
      * @param tag Memory tag of targeted allocator
      */
     static void  print_usage(const MemoryTag tag);
+    /**
+     * @brief Output all live allocations, grouped by the call stack that made
+     * them. Allocations are recorded only if @p MEMORY_TRACKING is enabled,
+     * otherwise nothing is output. Any allocation still live at shutdown is a
+     * leak, but report can be requested at any time.
+     * @param tag Memory tag of reported allocations (def = all tags)
+     */
+    static void  report_leaks(const MemoryTag tag = MemoryTag::MAX_TAGS);
+    /**
+     * @brief Start allocating frame memory (@p MemoryTag::Frame) for a given
+     * frame in flight. Everything previously allocated for that frame is
+     * released at once, so it must only be called after the GPU is done with
+     * it.
+     * @param frame_index Index of the frame in flight
+     */
+    static void  begin_frame(const uint32 frame_index);
+    /**
+     * @brief Configure how allocator with a given tag grows once it runs out
+     * of memory. Tags sharing an allocator also share its growth settings.
+     * @param tag Memory tag of targeted allocator
+     * @param growth_step Minimal number of bytes added per growth
+     * @param size_limit Hard limit on allocator size. Can't exceed the address
+     * range reserved for the allocator at initialization
+     */
+    static void  set_growth(
+        const MemoryTag tag, const uint64 growth_step, const uint64 size_limit
+    );
+
+    /**
+     * @brief Callback releasing memory of a given tag, e.g. by evicting cached
+     * resources nobody references. Should release a single resource per call,
+     * as it is called repeatedly for as long as the memory pressure lasts.
+     * Returns false once there is nothing left to release.
+     */
+    typedef std::function<bool()> EvictionCallback;
+
+    /**
+     * @brief Configure memory budget of a given tag. Once usage exceeds the
+     * soft budget, eviction callbacks of the tag are called at the start of
+     * the next frame until it drops back under. Allocation which would exceed
+     * the hard budget calls them immediately instead, and fails only if they
+     * can't make enough room. Off the main thread, such allocation succeeds
+     * and callbacks are called at the start of the next frame. Usage is that
+     * of the allocator behind the tag, so tags sharing an allocator should
+     * share their budget too.
+     * @param tag Memory tag of targeted allocator
+     * @param soft_limit Usage in bytes above which cached memory is released
+     * at frame start (def = 0, no soft budget)
+     * @param hard_limit Usage in bytes which can't be exceeded (def = 0, size
+     * of the address range reserved for the allocator)
+     */
+    static void   set_budget(
+        const MemoryTag tag,
+        const uint64    soft_limit = 0,
+        const uint64    hard_limit = 0
+    );
+    /**
+     * @brief Register callback called when memory of a given tag runs over
+     * its budget. Callbacks of a tag are called in turns, and only on the main
+     * thread (which runs static initialization), so they need no
+     * synchronization with their system. Callback can be called from within
+     * an allocation of its tag, so it shouldn't allocate with that same tag.
+     * @param tag Memory tag of targeted allocator
+     * @param callback Called eviction callback
+     * @return uint64 Id of the registered callback
+     */
+    static uint64 add_eviction_callback(
+        const MemoryTag tag, const EvictionCallback& callback
+    );
+    /**
+     * @brief Unregister eviction callback
+     * @param callback_id Id returned by @p add_eviction_callback
+     */
+    static void   remove_eviction_callback(const uint64 callback_id);
+
+    /**
+     * @brief Callback updating all references to a relocatable allocation
+     * after it was moved. Receives the new address, where the allocation
+     * content already is.
+     */
+    typedef std::function<void(void* const)> RelocationCallback;
+
+    /// @brief Fragmentation (see @p Telemetry) above which compaction starts
+    static constexpr float32 compaction_threshold = 0.25f;
+
+    /**
+     * @brief Allow compaction to move an allocation. Registration lasts until
+     * the allocation is freed. Allocation's tag must be one whose allocator
+     * supports compaction, e.g. @p MemoryTag::Geometry. Callback is called
+     * during @p compact(), under the lock of the owning allocator, so it can't
+     * allocate with tags sharing that allocator.
+     * @param ptr Address of an allocation made by the memory system
+     * @param callback Called after each move of the allocation
+     */
+    static void set_relocatable(
+        void* const ptr, const RelocationCallback& callback
+    );
+    /**
+     * @brief Compact memory of a given tag by moving its relocatable
+     * allocations towards the start of the allocator, merging free memory
+     * together. Pass starts once fragmentation exceeds
+     * @p compaction_threshold, and is spread over as many calls as needed.
+     * Relocatable allocations can't be used by other threads meanwhile.
+     * Supported only by free list allocators, e.g. that of
+     * @p MemoryTag::Geometry.
+     * @param tag Memory tag of targeted allocator
+     * @param time_slice Time in seconds after which the call returns
+     * @returns true If no compaction pass is in progress anymore
+     * @returns false If the pass will continue with the next call
+     */
+    static bool compact(const MemoryTag tag, const float64 time_slice);
 
     /**
      * @brief Get owner of a given address
@@ -108,23 +233,107 @@ class MemorySystem {
      */
     static MemoryTag get_owner(void* ptr);
 
+    /// @brief Number of buckets in allocation size histograms
+    static constexpr uint32 histogram_size = 16;
+
+    /**
+     * @brief Memory usage statistics of a single tag. Allocation figures are
+     * exact for the tag. Usage figures (live count included) are those of the
+     * allocator behind the tag, which can be shared with other tags.
+     * Allocators without own memory (C allocator) never see deallocations, so
+     * they report allocation figures only.
+     */
+    struct Telemetry {
+        /// @brief Number of allocations made with this tag
+        uint64  allocation_count;
+        /// @brief Number of bytes requested with this tag
+        uint64  allocated_bytes;
+        /// @brief Number of allocations made during the last finished frame
+        uint64  frame_allocation_count;
+        /// @brief Allocation count per size. Bucket i counts sizes up to
+        /// 2^(i+4) bytes, while the last bucket also counts all larger sizes
+        uint64  size_histogram[histogram_size];
+        /// @brief Number of allocations not yet freed in allocator
+        uint64  live_allocation_count;
+        /// @brief Bytes currently used in allocator
+        uint64  used_bytes;
+        /// @brief Peak bytes used in allocator
+        uint64  peak_bytes;
+        /// @brief Current allocator size in bytes
+        uint64  total_bytes;
+        /// @brief Share of free memory not part of the largest free segment
+        /// (0 if not tracked by allocator, e.g. for non free list allocators)
+        float32 fragmentation;
+    };
+
+    /**
+     * @brief Get memory usage statistics of a given tag
+     * @param tag Memory tag
+     * @return Telemetry Statistics at the time of the call
+     */
+    static Telemetry      get_telemetry(const MemoryTag tag);
+    /**
+     * @brief Get memory usage statistics of all tags in JSON format. Tags are
+     * keyed by name, each with the same fields as @p Telemetry.
+     * @return nlohmann::json Statistics at the time of the call
+     */
+    static nlohmann::json get_telemetry_json();
+
   private:
-    class MemoryMap : public std::map<uint64, MemoryTag> {
-      public:
-        using std::map<uint64, MemoryTag>::map;
+    /**
+     * @brief Address space shared by all custom allocators. One large virtual
+     * range is reserved at startup and split into equally sized regions. Each
+     * allocator owns a chain of consecutive regions, large enough for its size
+     * limit, and commits memory from them as it grows. Owner of any address
+     * can then be computed directly from its offset in the range.
+     */
+    struct AddressSpace {
+        /// @brief Region size is 2^region_shift bytes (1 GB)
+        static constexpr uint64 region_shift = 30;
+        static constexpr uint64 region_size  = (uint64) 1 << region_shift;
+        static constexpr uint64 max_regions  = 32;
 
-        ~MemoryMap() { _dying = true; }
+        uint64    start = 0;
+        uint64    size  = 0;
+        uint64    used  = 0;
+        MemoryTag owner[max_regions] {};
 
-        MemoryTag get_first_before(const uint64 address);
+        /// @brief Reserve the whole address space. Start is huge page
+        /// aligned, so regions can be backed by huge pages
+        void  initialize();
+        /// @brief Get region chain for allocator of given initial and maximal
+        /// size. Only the initial size is commited
+        void* reserve_region(
+            const uint64 allocator_size, const uint64 reserved_size
+        );
+        /// @brief Mark region chain of given range as owned by tag
+        void  set_owner(
+            const uint64 address, const uint64 range_size, const MemoryTag tag
+        );
+    };
 
-      private:
-        bool _dying = false;
+    struct Budget {
+        uint64 soft_limit;
+        uint64 hard_limit;
     };
 
-    static MemoryMap   _memory_map;
-    static Allocator** _allocator_array;
+    // Number of bytes moved between checks of the compaction time slice
+    static constexpr uint64 compaction_step = 256 * KB;
+
+    static AddressSpace _address_space;
+    static Budget       _budgets[(MemoryTagType) MemoryTag::MAX_TAGS];
+    static Allocator**  _allocator_array;
+
+    static bool evict(const MemoryTag tag, const uint64 target_usage);
+
+    static void record_allocation(const MemoryTag tag, const uint64 size);
+    static void record_deallocation(const MemoryTag tag);
+    static void record_frame();
+    static void clear_live_allocations(const Allocator* const allocator);
+    static void clear_tracked_allocations(const Allocator* const allocator);
+    static void clear_relocatable_allocations(const Allocator* const allocator);
 
-    static Allocator** initialize_allocator_array(MemoryMap& memory_map);
+    static Allocator** initialize_allocator_array(AddressSpace& address_space);
 };
 
 } // namespace ENGINE_NAMESPACE
@@ -2,12 +2,16 @@
 
 #include "renderer/renderer.hpp"
 #include "resource_system.hpp"
+#include "slot_map.hpp"
+#include "list.hpp"
 
 namespace ENGINE_NAMESPACE {
 
 /**
  * @brief Texture system is responsible for management of textures in the
- * engine, including reference counting an auto-unloading.
+ * engine, including reference counting an auto-unloading. Auto released
+ * textures stay cached once unreferenced, and are unloaded only once texture
+ * memory runs over its budget, least recently used first.
  */
 class TextureSystem {
   public:
@@ -108,16 +112,25 @@ class TextureSystem {
 
     /// @brief Releases texture resource. Texture system will automatically
     /// release this texture from memory if no other references to it are
-    /// detected and auto release flag is set to true.
+    /// detected and auto release flag is set to true. Texture is kept cached
+    /// until texture memory runs over its budget.
     /// @param name Name of the released texture
     void release(const String name);
+    /// @brief Releases texture resource. Same as release by name, but the
+    /// texture is found directly through its id (a generational handle).
+    /// @param texture Released texture
+    void release(const Texture* const texture);
 
   private:
     struct TextureRef {
         Texture* handle;
         uint64   reference_count;
         bool     auto_release;
+
+        // Position among unused textures, valid only while unreferenced
+        List<Handle<Texture>>::iterator unused_entry;
     };
+    typedef SlotMap<TextureRef, Texture>::HandleType TextureHandle;
 
     Renderer*       _renderer;
     ResourceSystem* _resource_system;
@@ -134,11 +147,26 @@ class TextureSystem {
 
     Texture::Map* _default_map = nullptr;
 
-    UnorderedMap<String, TextureRef> _registered_textures {};
+    // Texture references are densely stored and referenced by texture id,
+    // names are only used to find the id
+    SlotMap<TextureRef, Texture>        _registered_textures {};
+    UnorderedMap<String, TextureHandle> _texture_lookup {};
+
+    // Unreferenced auto released textures, least recently used first
+    List<TextureHandle> _unused_textures {};
+    uint64              _eviction_callback_id = 0;
 
     void create_default_textures();
     void destroy_default_textures();
 
+    TextureRef* find_texture(const String& key);
+    void register_texture(
+        const String& key, Texture* const texture, const bool auto_release
+    );
+    void release_texture(const TextureHandle handle);
+    void reference_texture(TextureRef* const ref);
+    bool evict_texture();
+
     Result<void, Texture*> name_is_valid(
         const String& texture_name, Texture* const default_fallback = nullptr
     );
@@ -158,11 +158,16 @@ void TestApplication::run() {
 
         timer.time("Events processed in ");
 
-        // Construct render packet
+        // Release frame memory of the frame about to be built
+        auto prepare_result = _app_renderer.prepare_frame();
+        if (prepare_result.has_error()) {
+            // TODO: PROCESS ERROR
+            Logger::error(prepare_result.error().what());
+        }
+
+        // Construct render packet, preparing module render data in parallel
         Renderer::Packet packet {};
-        // Add module render data
-        for (const auto module : _modules)
-            packet.module_data.push_back(module->build_pocket());
+        _app_renderer.build_packet(_modules, &packet);
 
         timer.time("Packets packed in ");
 
@@ -173,6 +178,11 @@ void TestApplication::run() {
         }
 
         timer.time("Frame rendered in ");
+
+        // Defragment geometry memory in between frames (0.5 ms at most)
+        MemorySystem::compact(MemoryTag::Geometry, 0.0005);
+
+        timer.time("Memory compacted in ");
         timer.stop();
     }
 }
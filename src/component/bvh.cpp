@@ -0,0 +1,442 @@
+#include "component/bvh.hpp"
+
+#include "small_vector.hpp"
+
+#include <algorithm> // min, max, partition
+
+namespace ENGINE_NAMESPACE {
+
+typedef BVH::Node Node;
+
+namespace {
+// Relative costs of testing a node and testing a box, used by SAH
+constexpr float32 node_test_cost = 1.0f;
+constexpr float32 box_test_cost  = 1.0f;
+// Traversal stack size before it spills to the heap (only for deep trees)
+constexpr uint64  stack_size     = 64;
+
+// Box accumulating points, empty until extended
+struct Bounds {
+    glm::vec3 min { Infinity32 };
+    glm::vec3 max { -Infinity32 };
+
+    void extend(const glm::vec3& point) {
+        min = glm::min(min, point);
+        max = glm::max(max, point);
+    }
+    void extend(const glm::vec3& box_min, const glm::vec3& box_max) {
+        min = glm::min(min, box_min);
+        max = glm::max(max, box_max);
+    }
+    void extend(const Bounds& other) { extend(other.min, other.max); }
+    // Half of the surface area. Only ratios of areas are ever used
+    float32 half_area() const {
+        const auto extent = max - min;
+        return extent.x * extent.y + extent.y * extent.z + extent.z * extent.x;
+    }
+};
+
+glm::vec3 get_center(const BBoxArray& boxes, const uint64 index) {
+    return { boxes.center_x[index],
+             boxes.center_y[index],
+             boxes.center_z[index] };
+}
+glm::vec3 get_half(const BBoxArray& boxes, const uint64 index) {
+    return { boxes.half_x[index], boxes.half_y[index], boxes.half_z[index] };
+}
+
+glm::vec3 get_min(const Node& node) {
+    return { node.min[0], node.min[1], node.min[2] };
+}
+glm::vec3 get_max(const Node& node) {
+    return { node.max[0], node.max[1], node.max[2] };
+}
+
+// Box sorted into the tree, kept in one place so builds read memory in order
+struct Primitive {
+    glm::vec3 center;
+    uint32    index;
+    glm::vec3 half;
+};
+
+// Ray with reciprocal direction precomputed for slab tests
+struct RayData {
+    glm::vec3 origin;
+    glm::vec3 inverse_direction;
+    float32   min_t;
+    float32   max_t;
+
+    RayData(const Ray<3>& ray)
+        : origin(ray.origin), inverse_direction(1.0f / ray.direction),
+          min_t(ray.min_t), max_t(ray.max_t) {}
+
+    /**
+     * Slab test of a box within [min_t, max_t]. Rays parallel to an axis and
+     * starting within the plane of one of the slabs produce NaN params, which
+     * comparisons ignore.
+     */
+    bool intersect(
+        const glm::vec3& box_min, const glm::vec3& box_max, float32& near_t
+    ) const {
+        float32 near = min_t;
+        float32 far  = max_t;
+        for (uint32 axis = 0; axis < 3; axis++) {
+            const float32 t0 =
+                (box_min[axis] - origin[axis]) * inverse_direction[axis];
+            const float32 t1 =
+                (box_max[axis] - origin[axis]) * inverse_direction[axis];
+            near = std::max(near, std::min(t0, t1));
+            far  = std::min(far, std::max(t0, t1));
+        }
+        near_t = near;
+        return near <= far;
+    }
+    bool intersect(const Node& node, float32& near_t) const {
+        return intersect(get_min(node), get_max(node), near_t);
+    }
+};
+} // namespace
+
+// ///////// //
+// BVH BUILD //
+// ///////// //
+
+void BVH::build(const BBoxArray& bounds) {
+    const uint64 box_count = bounds.size();
+
+    _nodes.clear();
+    _indices.resize(box_count);
+    _bounds.resize(box_count);
+    if (box_count == 0) {
+        _cost       = 0.0f;
+        _built_cost = 0.0f;
+        return;
+    }
+
+    Vector<Primitive> primitives {};
+    primitives.resize(box_count);
+    for (uint64 i = 0; i < box_count; i++)
+        primitives[i] = {
+            get_center(bounds, i), (uint32) i, get_half(bounds, i)
+        };
+
+    // Leaves aren't empty, so there are at most 2n - 1 nodes
+    _nodes.reserve(2 * box_count - 1);
+    _nodes.push_back({ {}, 0, {}, (uint32) box_count });
+
+    SmallVector<uint32, stack_size> stack {};
+    stack.push_back(0);
+    while (!stack.empty()) {
+        const uint32 node_index = stack.back();
+        stack.pop_back();
+
+        const uint32 first = _nodes[node_index].first;
+        const uint32 count = _nodes[node_index].count;
+        if (count <= max_leaf_size) continue;
+
+        Primitive* const begin = primitives.data() + first;
+        Primitive* const end   = begin + count;
+
+        // Boxes are binned by their centers, within bounds of all centers
+        Bounds centers {};
+        for (auto primitive = begin; primitive != end; primitive++)
+            centers.extend(primitive->center);
+
+        const auto extent = centers.max - centers.min;
+        glm::vec3  scale {};
+        for (uint32 axis = 0; axis < 3; axis++)
+            scale[axis] = (extent[axis] > 0.0f) ? bin_count / extent[axis]
+                                                : 0.0f;
+        const auto get_bin = [&](const glm::vec3& center, const uint32 axis) {
+            const auto bin = (center[axis] - centers.min[axis]) * scale[axis];
+            return std::min((uint32) bin, bin_count - 1);
+        };
+
+        Bounds bins[3][bin_count] {};
+        uint32 bin_sizes[3][bin_count] {};
+        for (auto primitive = begin; primitive != end; primitive++) {
+            const auto min = primitive->center - primitive->half;
+            const auto max = primitive->center + primitive->half;
+            for (uint32 axis = 0; axis < 3; axis++) {
+                const auto bin = get_bin(primitive->center, axis);
+                bins[axis][bin].extend(min, max);
+                bin_sizes[axis][bin]++;
+            }
+        }
+
+        // Candidate splits lie between bins. Parent area is the same for all
+        // of them, so it's left out of the compared costs
+        float32 best_cost  = Infinity32;
+        uint32  best_axis  = 3;
+        uint32  best_split = 0;
+        for (uint32 axis = 0; axis < 3; axis++) {
+            if (scale[axis] == 0.0f) continue;
+
+            float32 right_areas[bin_count];
+            uint32  right_sizes[bin_count];
+            Bounds  right {};
+            uint32  right_size = 0;
+            for (uint32 bin = bin_count - 1; bin > 0; bin--) {
+                right.extend(bins[axis][bin]);
+                right_size += bin_sizes[axis][bin];
+                right_areas[bin] = right.half_area();
+                right_sizes[bin] = right_size;
+            }
+
+            Bounds left {};
+            uint32 left_size = 0;
+            for (uint32 split = 1; split < bin_count; split++) {
+                left.extend(bins[axis][split - 1]);
+                left_size += bin_sizes[axis][split - 1];
+                if (left_size == 0 || right_sizes[split] == 0) continue;
+
+                const float32 cost = left.half_area() * left_size +
+                                     right_areas[split] * right_sizes[split];
+                if (cost < best_cost) {
+                    best_cost  = cost;
+                    best_axis  = axis;
+                    best_split = split;
+                }
+            }
+        }
+
+        // Boxes with coinciding centers are split in half
+        Primitive* middle = begin + count / 2;
+        if (best_axis < 3)
+            middle = std::partition(begin, end, [&](const Primitive& box) {
+                return get_bin(box.center, best_axis) < best_split;
+            });
+        const uint32 left_count = middle - begin;
+
+        const uint32 child = _nodes.size();
+        _nodes.push_back({ {}, first, {}, left_count });
+        _nodes.push_back({ {}, first + left_count, {}, count - left_count });
+        _nodes[node_index].first = child;
+        _nodes[node_index].count = 0;
+
+        stack.push_back(child + 1);
+        stack.push_back(child);
+    }
+
+    for (uint64 i = 0; i < box_count; i++)
+        _indices[i] = primitives[i].index;
+
+    refit(bounds);
+    _built_cost = _cost;
+}
+
+void BVH::refit(const BBoxArray& bounds) {
+    for (uint64 i = 0; i < _indices.size(); i++)
+        _bounds.set(i, bounds, _indices[i]);
+
+    // Children come after their parents, so they're updated first
+    float32 cost = 0.0f;
+    for (uint64 i = _nodes.size(); i-- > 0;) {
+        Node&  node = _nodes[i];
+        Bounds box {};
+        if (node.is_leaf()) {
+            for (uint32 j = node.first; j < node.first + node.count; j++) {
+                const auto center = get_center(_bounds, j);
+                const auto half   = get_half(_bounds, j);
+                box.extend(center - half, center + half);
+            }
+            cost += box.half_area() * node.count * box_test_cost;
+        } else {
+            const Node& left  = _nodes[node.first];
+            const Node& right = _nodes[node.first + 1];
+            box.extend(get_min(left), get_max(left));
+            box.extend(get_min(right), get_max(right));
+            cost += box.half_area() * node_test_cost;
+        }
+        for (uint32 axis = 0; axis < 3; axis++) {
+            node.min[axis] = box.min[axis];
+            node.max[axis] = box.max[axis];
+        }
+    }
+
+    // Cost relative to a query hitting the root
+    const float32 root_area =
+        _nodes.empty() ? 0.0f
+                       : Bounds { get_min(_nodes[0]), get_max(_nodes[0]) }
+                             .half_area();
+    _cost = (root_area > 0.0f) ? cost / root_area : 0.0f;
+}
+
+bool BVH::update(const BBoxArray& bounds, const float32 rebuild_threshold) {
+    if (bounds.size() == size()) {
+        refit(bounds);
+        if (_cost <= _built_cost * rebuild_threshold) return false;
+    }
+    build(bounds);
+    return true;
+}
+
+// /////////// //
+// BVH QUERIES //
+// /////////// //
+
+void BVH::cull(const Frustum& frustum, Vector<uint32>& result) const {
+    if (_nodes.empty()) return;
+
+    SmallVector<uint32, stack_size> stack {};
+    stack.push_back(0);
+    while (!stack.empty()) {
+        const uint32 node_index = stack.back();
+        stack.pop_back();
+
+        const Node& node        = _nodes[node_index];
+        const auto  min         = get_min(node);
+        const auto  max         = get_max(node);
+        const auto  containment = frustum.classify(
+            (max + min) * 0.5f, (max - min) * 0.5f
+        );
+        if (containment == Frustum::Containment::Outside) continue;
+
+        // Boxes of a subtree are continuous in tree order, between the first
+        // box of its leftmost leaf and the last box of its rightmost leaf
+        if (containment == Frustum::Containment::Inside) {
+            uint32 leftmost  = node_index;
+            uint32 rightmost = node_index;
+            while (!_nodes[leftmost].is_leaf())
+                leftmost = _nodes[leftmost].first;
+            while (!_nodes[rightmost].is_leaf())
+                rightmost = _nodes[rightmost].first + 1;
+
+            const auto indices = _indices.begin();
+            result.insert(
+                result.end(),
+                indices + _nodes[leftmost].first,
+                indices + _nodes[rightmost].first + _nodes[rightmost].count
+            );
+            continue;
+        }
+
+        if (node.is_leaf()) {
+            for (uint32 i = node.first; i < node.first + node.count; i++) {
+                const auto box_containment = frustum.classify(
+                    get_center(_bounds, i), get_half(_bounds, i)
+                );
+                if (box_containment != Frustum::Containment::Outside)
+                    result.push_back(_indices[i]);
+            }
+            continue;
+        }
+        stack.push_back(node.first + 1);
+        stack.push_back(node.first);
+    }
+}
+
+void BVH::query_box(const BBox& bbox, Vector<uint32>& result) const {
+    if (_nodes.empty()) return;
+
+    const auto center = (bbox.max + bbox.min) * 0.5f;
+    const auto half   = (bbox.max - bbox.min) * 0.5f;
+
+    SmallVector<uint32, stack_size> stack {};
+    stack.push_back(0);
+    while (!stack.empty()) {
+        const Node& node = _nodes[stack.back()];
+        stack.pop_back();
+
+        if (glm::any(glm::lessThan(get_max(node), bbox.min)) ||
+            glm::any(glm::greaterThan(get_min(node), bbox.max)))
+            continue;
+
+        if (node.is_leaf()) {
+            for (uint32 i = node.first; i < node.first + node.count; i++) {
+                const auto distance = glm::abs(get_center(_bounds, i) - center);
+                if (glm::all(glm::lessThanEqual(
+                        distance, get_half(_bounds, i) + half
+                    )))
+                    result.push_back(_indices[i]);
+            }
+            continue;
+        }
+        stack.push_back(node.first + 1);
+        stack.push_back(node.first);
+    }
+}
+
+void BVH::query_ray(const Ray<3>& ray, Vector<uint32>& result) const {
+    if (_nodes.empty()) return;
+
+    const RayData data { ray };
+    float32       near_t;
+
+    SmallVector<uint32, stack_size> stack {};
+    stack.push_back(0);
+    while (!stack.empty()) {
+        const Node& node = _nodes[stack.back()];
+        stack.pop_back();
+
+        if (!data.intersect(node, near_t)) continue;
+
+        if (node.is_leaf()) {
+            for (uint32 i = node.first; i < node.first + node.count; i++) {
+                const auto center = get_center(_bounds, i);
+                const auto half   = get_half(_bounds, i);
+                if (data.intersect(center - half, center + half, near_t))
+                    result.push_back(_indices[i]);
+            }
+            continue;
+        }
+        stack.push_back(node.first + 1);
+        stack.push_back(node.first);
+    }
+}
+
+bool BVH::ray_cast(const Ray<3>& ray, uint32& index, float32& t) const {
+    if (_nodes.empty()) return false;
+
+    // Max param shrinks to the closest hit so far, pruning farther nodes
+    RayData data { ray };
+    bool    hit = false;
+
+    struct Entry {
+        uint32  node;
+        float32 near_t;
+    };
+    SmallVector<Entry, stack_size> stack {};
+
+    float32 root_t;
+    if (!data.intersect(_nodes[0], root_t)) return false;
+    stack.push_back({ 0, root_t });
+
+    while (!stack.empty()) {
+        const Entry entry = stack.back();
+        stack.pop_back();
+        if (entry.near_t > data.max_t) continue;
+
+        const Node& node = _nodes[entry.node];
+        if (node.is_leaf()) {
+            for (uint32 i = node.first; i < node.first + node.count; i++) {
+                const auto center = get_center(_bounds, i);
+                const auto half   = get_half(_bounds, i);
+                float32    box_t;
+                if (data.intersect(center - half, center + half, box_t)) {
+                    data.max_t = box_t;
+                    index      = _indices[i];
+                    hit        = true;
+                }
+            }
+            continue;
+        }
+
+        // Nearer child is visited first
+        float32    left_t, right_t;
+        const bool left  = data.intersect(_nodes[node.first], left_t);
+        const bool right = data.intersect(_nodes[node.first + 1], right_t);
+        if (left && right) {
+            const bool left_first = left_t <= right_t;
+            if (left_first) stack.push_back({ node.first + 1, right_t });
+            stack.push_back({ node.first, left_t });
+            if (!left_first) stack.push_back({ node.first + 1, right_t });
+        } else if (left) stack.push_back({ node.first, left_t });
+        else if (right) stack.push_back({ node.first + 1, right_t });
+    }
+
+    if (hit) t = data.max_t;
+    return hit;
+}
+
+} // namespace ENGINE_NAMESPACE
\ No newline at end of file
@@ -1,5 +1,11 @@
 #include "component/frustum.hpp"
 
+#if defined(__AVX__)
+#    include <immintrin.h>
+#elif defined(__SSE__) || defined(_M_X64)
+#    include <xmmintrin.h>
+#endif
+
 namespace ENGINE_NAMESPACE {
 
 // -----------------------------------------------------------------------------
@@ -32,8 +38,209 @@ Frustum::Frustum(
     _sides[4] = Plane(position, glm::cross(right, ff - uh));
     _sides[5] = Plane(position, glm::cross(ff + uh, right));
 }
+Frustum::Frustum(const glm::mat4& view_projection) {
+    // Planes are combinations of clip space rows (Gribb & Hartmann)
+    const auto rows = glm::transpose(view_projection);
+
+    const std::array<glm::vec4, 6> planes {
+        rows[2],           // Near (depth 0)
+        rows[3] - rows[2], // Far
+        rows[3] - rows[1], // Top
+        rows[3] + rows[1], // Bottom
+        rows[3] - rows[0], // Right
+        rows[3] + rows[0]  // Left
+    };
+
+    // Points inside satisfy dot(normal, point) >= distance
+    for (uint32 i = 0; i < 6; i++) {
+        const auto normal  = glm::vec3(planes[i]);
+        const auto length  = glm::length(normal);
+        _sides[i].equation = glm::vec4(normal, -planes[i].w) / length;
+    }
+}
 Frustum::~Frustum() {}
 
+void Frustum::extend_near_plane(const float32 distance) {
+    _sides[0].equation.w -= distance;
+}
+
+Frustum::Containment Frustum::classify(
+    const glm::vec3& center, const glm::vec3& half
+) const {
+    Containment result = Containment::Inside;
+    for (const auto& side : _sides) {
+        const auto normal   = glm::vec3(side.equation);
+        const auto distance = side.signed_distance(center);
+        const auto radius   = glm::dot(half, glm::abs(normal));
+        if (distance < -radius) return Containment::Outside;
+        if (distance < radius) result = Containment::Intersects;
+    }
+    return result;
+}
+
+// Planes laid out for culling, one array per component
+namespace {
+struct CullPlanes {
+    float32 x[6], y[6], z[6];
+    float32 abs_x[6], abs_y[6], abs_z[6];
+    float32 distance[6];
+};
+
+// Box is visible if it isn't fully behind any of the planes, that is if the
+// smallest margin (signed distance of its center plus its projected radius)
+// over all planes is non-negative
+#if defined(__AVX__)
+uint64 cull_avx(
+    const CullPlanes& planes,
+    const BBoxArray&  boxes,
+    uint64            index,
+    const uint64      end,
+    uint8* const      visible
+) {
+    __m256 x[6], y[6], z[6], abs_x[6], abs_y[6], abs_z[6], distance[6];
+    for (uint32 i = 0; i < 6; i++) {
+        x[i]        = _mm256_set1_ps(planes.x[i]);
+        y[i]        = _mm256_set1_ps(planes.y[i]);
+        z[i]        = _mm256_set1_ps(planes.z[i]);
+        abs_x[i]    = _mm256_set1_ps(planes.abs_x[i]);
+        abs_y[i]    = _mm256_set1_ps(planes.abs_y[i]);
+        abs_z[i]    = _mm256_set1_ps(planes.abs_z[i]);
+        distance[i] = _mm256_set1_ps(planes.distance[i]);
+    }
+    const __m256 zero = _mm256_setzero_ps();
+
+    for (; index + 8 <= end; index += 8) {
+        const __m256 cx = _mm256_loadu_ps(boxes.center_x.data() + index);
+        const __m256 cy = _mm256_loadu_ps(boxes.center_y.data() + index);
+        const __m256 cz = _mm256_loadu_ps(boxes.center_z.data() + index);
+        const __m256 hx = _mm256_loadu_ps(boxes.half_x.data() + index);
+        const __m256 hy = _mm256_loadu_ps(boxes.half_y.data() + index);
+        const __m256 hz = _mm256_loadu_ps(boxes.half_z.data() + index);
+
+        __m256 margin = _mm256_set1_ps(Infinity32);
+        for (uint32 i = 0; i < 6; i++) {
+            const __m256 center_distance = _mm256_sub_ps(
+                _mm256_add_ps(
+                    _mm256_add_ps(
+                        _mm256_mul_ps(x[i], cx), _mm256_mul_ps(y[i], cy)
+                    ),
+                    _mm256_mul_ps(z[i], cz)
+                ),
+                distance[i]
+            );
+            const __m256 radius = _mm256_add_ps(
+                _mm256_add_ps(
+                    _mm256_mul_ps(abs_x[i], hx), _mm256_mul_ps(abs_y[i], hy)
+                ),
+                _mm256_mul_ps(abs_z[i], hz)
+            );
+            margin = _mm256_min_ps(
+                margin, _mm256_add_ps(center_distance, radius)
+            );
+        }
+
+        const int32 mask =
+            _mm256_movemask_ps(_mm256_cmp_ps(margin, zero, _CMP_GE_OQ));
+        for (uint32 lane = 0; lane < 8; lane++)
+            visible[index + lane] = (mask >> lane) & 1;
+    }
+    return index;
+}
+#elif defined(__SSE__) || defined(_M_X64)
+uint64 cull_sse(
+    const CullPlanes& planes,
+    const BBoxArray&  boxes,
+    uint64            index,
+    const uint64      end,
+    uint8* const      visible
+) {
+    __m128 x[6], y[6], z[6], abs_x[6], abs_y[6], abs_z[6], distance[6];
+    for (uint32 i = 0; i < 6; i++) {
+        x[i]        = _mm_set1_ps(planes.x[i]);
+        y[i]        = _mm_set1_ps(planes.y[i]);
+        z[i]        = _mm_set1_ps(planes.z[i]);
+        abs_x[i]    = _mm_set1_ps(planes.abs_x[i]);
+        abs_y[i]    = _mm_set1_ps(planes.abs_y[i]);
+        abs_z[i]    = _mm_set1_ps(planes.abs_z[i]);
+        distance[i] = _mm_set1_ps(planes.distance[i]);
+    }
+    const __m128 zero = _mm_setzero_ps();
+
+    for (; index + 4 <= end; index += 4) {
+        const __m128 cx = _mm_loadu_ps(boxes.center_x.data() + index);
+        const __m128 cy = _mm_loadu_ps(boxes.center_y.data() + index);
+        const __m128 cz = _mm_loadu_ps(boxes.center_z.data() + index);
+        const __m128 hx = _mm_loadu_ps(boxes.half_x.data() + index);
+        const __m128 hy = _mm_loadu_ps(boxes.half_y.data() + index);
+        const __m128 hz = _mm_loadu_ps(boxes.half_z.data() + index);
+
+        __m128 margin = _mm_set1_ps(Infinity32);
+        for (uint32 i = 0; i < 6; i++) {
+            const __m128 center_distance = _mm_sub_ps(
+                _mm_add_ps(
+                    _mm_add_ps(_mm_mul_ps(x[i], cx), _mm_mul_ps(y[i], cy)),
+                    _mm_mul_ps(z[i], cz)
+                ),
+                distance[i]
+            );
+            const __m128 radius = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(abs_x[i], hx), _mm_mul_ps(abs_y[i], hy)),
+                _mm_mul_ps(abs_z[i], hz)
+            );
+            margin = _mm_min_ps(margin, _mm_add_ps(center_distance, radius));
+        }
+
+        const int32 mask = _mm_movemask_ps(_mm_cmpge_ps(margin, zero));
+        for (uint32 lane = 0; lane < 4; lane++)
+            visible[index + lane] = (mask >> lane) & 1;
+    }
+    return index;
+}
+#endif
+} // namespace
+
+void Frustum::cull(
+    const BBoxArray& boxes,
+    const uint64     begin,
+    const uint64     end,
+    uint8* const     visible
+) const {
+    CullPlanes planes;
+    for (uint32 i = 0; i < 6; i++) {
+        const auto& equation = _sides[i].equation;
+        planes.x[i]          = equation.x;
+        planes.y[i]          = equation.y;
+        planes.z[i]          = equation.z;
+        planes.abs_x[i]      = std::abs(equation.x);
+        planes.abs_y[i]      = std::abs(equation.y);
+        planes.abs_z[i]      = std::abs(equation.z);
+        planes.distance[i]   = equation.w;
+    }
+
+    uint64 index = begin;
+#if defined(__AVX__)
+    index = cull_avx(planes, boxes, index, end, visible);
+#elif defined(__SSE__) || defined(_M_X64)
+    index = cull_sse(planes, boxes, index, end, visible);
+#endif
+
+    // Remaining boxes one by one
+    for (; index < end; index++) {
+        float32 margin = Infinity32;
+        for (uint32 i = 0; i < 6; i++) {
+            const float32 center_distance =
+                planes.x[i] * boxes.center_x[index] +
+                planes.y[i] * boxes.center_y[index] +
+                planes.z[i] * boxes.center_z[index] - planes.distance[i];
+            const float32 radius = planes.abs_x[i] * boxes.half_x[index] +
+                                   planes.abs_y[i] * boxes.half_y[index] +
+                                   planes.abs_z[i] * boxes.half_z[index];
+            margin = std::min(margin, center_distance + radius);
+        }
+        visible[index] = margin >= 0.0f;
+    }
+}
+
 // -----------------------------------------------------------------------------
 // Plane
 // -----------------------------------------------------------------------------
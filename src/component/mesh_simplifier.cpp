@@ -0,0 +1,430 @@
+#include "component/mesh_simplifier.hpp"
+
+#include <algorithm> // binary_search, set_intersection, sort, unique
+#include <numeric>   // iota
+
+namespace ENGINE_NAMESPACE {
+
+namespace {
+// Vertex flags, reset by each pass
+constexpr uint8   border_flag            = 1 << 0;
+constexpr uint8   locked_flag            = 1 << 1;
+constexpr uint8   touched_flag           = 1 << 2;
+// Weight of planes keeping borders in place, relative to squared edge length
+constexpr float64 border_weight          = 10.0;
+// Largest rotation of a triangle normal allowed by a collapse, as cosine
+constexpr float64 min_normal_cosine      = 0.25;
+// Share of (cheapest) candidate collapses considered by each pass
+constexpr uint64  pass_candidate_divisor = 4;
+
+constexpr uint32 no_vertex = (uint32) -1;
+
+uint64 edge_key(const uint32 from, const uint32 to) {
+    return (uint64) from << 32 | to;
+}
+} // namespace
+
+// Constructor & Destructor
+MeshSimplifier::MeshSimplifier(
+    const Vector<glm::vec3>& positions, const Vector<uint32>& indices
+) {
+    const uint32 vertex_count = positions.size();
+    _positions.resize(vertex_count);
+    for (uint32 i = 0; i < vertex_count; i++)
+        _positions[i] = positions[i];
+    _indices.resize(indices.size() - indices.size() % 3);
+    for (uint64 i = 0; i < _indices.size(); i++)
+        _indices[i] = indices[i];
+
+    // Weld vertices at the same position, by sorting them
+    Vector<uint32> order {};
+    order.resize(vertex_count);
+    std::iota(order.begin(), order.end(), 0);
+    const auto less = [&](const uint32 a, const uint32 b) {
+        const auto& p = _positions[a];
+        const auto& q = _positions[b];
+        if (p.x != q.x) return p.x < q.x;
+        if (p.y != q.y) return p.y < q.y;
+        return p.z < q.z;
+    };
+    std::sort(order.begin(), order.end(), less);
+    _welded.resize(vertex_count);
+    _next_twin.resize(vertex_count);
+    for (uint32 begin = 0, end = 0; begin < vertex_count; begin = end) {
+        end = begin + 1;
+        while (end < vertex_count && !less(order[begin], order[end]))
+            end++;
+        for (uint32 i = begin; i < end; i++) {
+            _welded[order[i]]    = order[begin];
+            _next_twin[order[i]] = order[i + 1 < end ? i + 1 : begin];
+        }
+    }
+
+    // Errors are measured relative to the bounding box diagonal
+    glm::vec3 min { Infinity32 };
+    glm::vec3 max { -Infinity32 };
+    for (const auto& position : _positions) {
+        min = glm::min(min, position);
+        max = glm::max(max, position);
+    }
+    if (vertex_count > 0) _size = std::max(glm::length(max - min), 1e-6f);
+
+    // Each vertex starts with the planes of its triangles
+    _quadrics.resize(vertex_count);
+    for (uint64 i = 0; i < _indices.size(); i += 3) {
+        const glm::dvec3 p0 { _positions[_indices[i + 0]] };
+        const glm::dvec3 p1 { _positions[_indices[i + 1]] };
+        const glm::dvec3 p2 { _positions[_indices[i + 2]] };
+        const glm::dvec3 normal = glm::cross(p1 - p0, p2 - p0);
+        const float64    length = glm::length(normal);
+        if (length == 0.0) continue;
+
+        Quadric plane {};
+        plane.add_plane(
+            normal / length, -glm::dot(normal, p0) / length, length * 0.5
+        );
+        for (uint32 j = 0; j < 3; j++)
+            _quadrics[_welded[_indices[i + j]]].add(plane);
+    }
+
+    _remap.resize(vertex_count);
+    std::iota(_remap.begin(), _remap.end(), 0);
+    _flags.resize(vertex_count);
+    compact_indices();
+    collect_edges();
+    add_border_quadrics();
+}
+MeshSimplifier::~MeshSimplifier() {}
+
+// ////////////////////////////// //
+// MESH SIMPLIFIER PUBLIC METHODS //
+// ////////////////////////////// //
+
+bool MeshSimplifier::simplify(
+    const uint64 target_index_count, const float32 max_error
+) {
+    const float64 max_cost = (max_error * _size) * (max_error * _size);
+    while (_indices.size() > target_index_count) {
+        build_adjacency();
+        collect_edges();
+
+        // Both directions of each edge are candidates (border edges are only
+        // listed in one direction)
+        _collapses.clear();
+        for (const auto edge : _edges) {
+            const uint32 from = edge >> 32;
+            const uint32 to   = (uint32) edge;
+            if (from > to && has_edge(to, from)) continue;
+            add_collapse(from, to, max_cost);
+            add_collapse(to, from, max_cost);
+        }
+        if (_collapses.empty()) break;
+
+        // Only the cheapest collapses are done, so that the mesh is reduced
+        // gradually. Each collapse invalidates adjacency of its neighbours
+        // until the next pass
+        std::sort(
+            _collapses.begin(),
+            _collapses.end(),
+            [](const Collapse& a, const Collapse& b) { return a.cost < b.cost; }
+        );
+        const uint64 candidate_count = std::max(
+            _collapses.size() / pass_candidate_divisor, (uint64) 1
+        );
+        uint64 index_count = _indices.size();
+        for (uint64 i = 0; i < candidate_count; i++) {
+            if (index_count <= target_index_count) break;
+            const auto& candidate = _collapses[i];
+            if ((_flags[candidate.from] | _flags[candidate.to]) & touched_flag)
+                continue;
+
+            const uint64 removed = collapse(candidate.from, candidate.to);
+            if (removed == 0) continue;
+            index_count -= 3 * removed;
+            _error = std::max(
+                _error, (float32) (std::sqrt(candidate.cost) / _size)
+            );
+        }
+
+        const uint64 previous_count = _indices.size();
+        compact_indices();
+        if (_indices.size() == previous_count) break;
+    }
+    return _indices.size() <= target_index_count;
+}
+
+// /////////////////////////////// //
+// MESH SIMPLIFIER PRIVATE METHODS //
+// /////////////////////////////// //
+
+void MeshSimplifier::Quadric::add(const Quadric& other) {
+    a00 += other.a00;
+    a11 += other.a11;
+    a22 += other.a22;
+    a01 += other.a01;
+    a02 += other.a02;
+    a12 += other.a12;
+    b0 += other.b0;
+    b1 += other.b1;
+    b2 += other.b2;
+    c += other.c;
+    weight += other.weight;
+}
+
+void MeshSimplifier::Quadric::add_plane(
+    const glm::dvec3& normal, const float64 distance, const float64 weight
+) {
+    a00 += weight * normal.x * normal.x;
+    a11 += weight * normal.y * normal.y;
+    a22 += weight * normal.z * normal.z;
+    a01 += weight * normal.x * normal.y;
+    a02 += weight * normal.x * normal.z;
+    a12 += weight * normal.y * normal.z;
+    b0 += weight * normal.x * distance;
+    b1 += weight * normal.y * distance;
+    b2 += weight * normal.z * distance;
+    c += weight * distance * distance;
+    this->weight += weight;
+}
+
+float64 MeshSimplifier::Quadric::error(const glm::dvec3& point) const {
+    if (weight == 0.0) return 0.0;
+    const auto& p = point;
+    // Expansion of p^T A p + 2 b^T p + c, with A symmetric
+    const float64 error =
+        a00 * p.x * p.x + a11 * p.y * p.y + a22 * p.z * p.z +
+        2.0 * (a01 * p.x * p.y + a02 * p.x * p.z + a12 * p.y * p.z) +
+        2.0 * (b0 * p.x + b1 * p.y + b2 * p.z) + c;
+    return std::max(error, 0.0) / weight;
+}
+
+void MeshSimplifier::build_adjacency() {
+    const uint32 vertex_count = _positions.size();
+    _triangle_offsets.assign(vertex_count + 1, 0);
+    for (const auto index : _indices)
+        _triangle_offsets[_welded[index] + 1]++;
+    for (uint32 i = 0; i < vertex_count; i++)
+        _triangle_offsets[i + 1] += _triangle_offsets[i];
+
+    // Offsets are advanced while filling, then restored
+    _triangles.resize(_indices.size());
+    for (uint64 i = 0; i < _indices.size(); i++)
+        _triangles[_triangle_offsets[_welded[_indices[i]]]++] = i / 3;
+    for (uint32 i = vertex_count; i > 0; i--)
+        _triangle_offsets[i] = _triangle_offsets[i - 1];
+    _triangle_offsets[0] = 0;
+}
+
+void MeshSimplifier::collect_edges() {
+    _edges.clear();
+    for (uint64 i = 0; i < _indices.size(); i += 3)
+        for (uint32 j = 0; j < 3; j++)
+            _edges.push_back(edge_key(
+                _welded[_indices[i + j]], _welded[_indices[i + (j + 1) % 3]]
+            ));
+    std::sort(_edges.begin(), _edges.end());
+
+    // Edges without an opposite are borders. Edges listed twice (in the same
+    // direction) aren't manifold, their vertices are never collapsed
+    std::fill(_flags.begin(), _flags.end(), 0);
+    for (uint64 i = 0; i < _edges.size(); i++) {
+        const uint32 from = _edges[i] >> 32;
+        const uint32 to   = (uint32) _edges[i];
+        if (i + 1 < _edges.size() && _edges[i + 1] == _edges[i]) {
+            _flags[from] |= locked_flag;
+            _flags[to] |= locked_flag;
+        }
+        if (!has_edge(to, from)) {
+            _flags[from] |= border_flag;
+            _flags[to] |= border_flag;
+        }
+    }
+}
+
+void MeshSimplifier::add_border_quadrics() {
+    // Planes through border edges, perpendicular to their triangle
+    for (uint64 i = 0; i < _indices.size(); i += 3) {
+        const glm::dvec3 p0 { _positions[_indices[i + 0]] };
+        const glm::dvec3 p1 { _positions[_indices[i + 1]] };
+        const glm::dvec3 p2 { _positions[_indices[i + 2]] };
+        const glm::dvec3 normal = glm::cross(p1 - p0, p2 - p0);
+        if (glm::dot(normal, normal) == 0.0) continue;
+
+        for (uint32 j = 0; j < 3; j++) {
+            const uint32 from = _welded[_indices[i + j]];
+            const uint32 to   = _welded[_indices[i + (j + 1) % 3]];
+            if (has_edge(to, from)) continue;
+
+            const glm::dvec3 start { _positions[from] };
+            const glm::dvec3 edge   = glm::dvec3(_positions[to]) - start;
+            const glm::dvec3 border = glm::cross(edge, normal);
+            const float64    length = glm::length(border);
+            if (length == 0.0) continue;
+
+            Quadric plane {};
+            plane.add_plane(
+                border / length,
+                -glm::dot(border, start) / length,
+                glm::dot(edge, edge) * border_weight
+            );
+            _quadrics[from].add(plane);
+            _quadrics[to].add(plane);
+        }
+    }
+}
+
+void MeshSimplifier::add_collapse(
+    const uint32 from, const uint32 to, const float64 max
+) {
+    // Border vertices only move along the border
+    if (_flags[from] & locked_flag) return;
+    if ((_flags[from] & border_flag) && has_edge(from, to) &&
+        has_edge(to, from))
+        return;
+
+    Quadric quadric = _quadrics[from];
+    quadric.add(_quadrics[to]);
+    const float64 cost = quadric.error(glm::dvec3(_positions[to]));
+    if (cost <= max) _collapses.push_back({ cost, from, to });
+}
+
+uint64 MeshSimplifier::collapse(const uint32 from, const uint32 to) {
+    const uint32 begin = _triangle_offsets[from];
+    const uint32 end   = _triangle_offsets[from + 1];
+
+    // Each vertex at the collapsed position is replaced by the vertex at the
+    // target position it shares a triangle with, so that attributes stay
+    // continuous. Vertices sharing triangles with none or several of them
+    // would split a seam, so the edge isn't collapsed
+    _twin_targets.clear();
+    uint32 vertex = from;
+    do {
+        uint32 target = no_vertex;
+        bool   used   = false;
+        for (uint32 i = begin; i < end; i++) {
+            const uint64 first = 3 * (uint64) _triangles[i];
+            bool         found = false;
+            for (uint32 j = 0; j < 3; j++)
+                found |= _indices[first + j] == vertex;
+            if (!found) continue;
+            used = true;
+            for (uint32 j = 0; j < 3; j++) {
+                const uint32 index = _indices[first + j];
+                if (_welded[index] != to) continue;
+                if (target != no_vertex && target != index) return 0;
+                target = index;
+            }
+        }
+        if (used && target == no_vertex) return 0;
+        if (used) _twin_targets.push_back({ vertex, target });
+        vertex = _next_twin[vertex];
+    } while (vertex != from);
+
+    // Link condition, vertices neighbouring both end points have to be
+    // opposite to the collapsed edge. Otherwise topology would change
+    uint64 removed = 0;
+    get_ring(from, to, _ring);
+    get_ring(to, from, _other_ring);
+    for (uint32 i = begin; i < end; i++)
+        removed += has_vertex(_triangles[i], to);
+    const uint64 shared_count =
+        std::set_intersection(
+            _ring.begin(),
+            _ring.end(),
+            _other_ring.begin(),
+            _other_ring.end(),
+            _ring.begin()
+        ) -
+        _ring.begin();
+    if (removed == 0 || shared_count != removed) return 0;
+
+    // Remaining triangles can't flip (or turn too far)
+    const glm::dvec3 target { _positions[to] };
+    for (uint32 i = begin; i < end; i++) {
+        if (has_vertex(_triangles[i], to)) continue;
+
+        const uint64 first = 3 * (uint64) _triangles[i];
+        glm::dvec3   before[3];
+        glm::dvec3   after[3];
+        for (uint32 j = 0; j < 3; j++) {
+            const uint32 index = _indices[first + j];
+            before[j]          = glm::dvec3(_positions[index]);
+            after[j] = (_welded[index] == from) ? target : before[j];
+        }
+        const auto normal_before =
+            glm::cross(before[1] - before[0], before[2] - before[0]);
+        const auto normal_after =
+            glm::cross(after[1] - after[0], after[2] - after[0]);
+        if (glm::dot(normal_before, normal_after) <=
+            min_normal_cosine * glm::length(normal_before) *
+                glm::length(normal_after))
+            return 0;
+    }
+
+    // Collapse. Neighbourhood of both vertices changes, so they're left alone
+    // for the rest of the pass
+    for (const auto& twin_target : _twin_targets)
+        _remap[twin_target.first] = twin_target.second;
+    _quadrics[to].add(_quadrics[from]);
+    for (const auto vertex : { from, to }) {
+        const uint32 begin = _triangle_offsets[vertex];
+        const uint32 end   = _triangle_offsets[vertex + 1];
+        for (uint32 i = begin; i < end; i++) {
+            const uint64 first = 3 * (uint64) _triangles[i];
+            for (uint32 j = 0; j < 3; j++)
+                _flags[_welded[_indices[first + j]]] |= touched_flag;
+        }
+    }
+    return removed;
+}
+
+void MeshSimplifier::compact_indices() {
+    // Triangles with collapsed edges are dropped
+    uint64 count = 0;
+    for (uint64 i = 0; i < _indices.size(); i += 3) {
+        const uint32 a = _remap[_indices[i + 0]];
+        const uint32 b = _remap[_indices[i + 1]];
+        const uint32 c = _remap[_indices[i + 2]];
+        if (_welded[a] == _welded[b] || _welded[b] == _welded[c] ||
+            _welded[a] == _welded[c])
+            continue;
+        _indices[count++] = a;
+        _indices[count++] = b;
+        _indices[count++] = c;
+    }
+    _indices.resize(count);
+    std::iota(_remap.begin(), _remap.end(), 0);
+}
+
+bool MeshSimplifier::has_edge(const uint32 from, const uint32 to) const {
+    return std::binary_search(_edges.begin(), _edges.end(), edge_key(from, to));
+}
+
+bool MeshSimplifier::has_vertex(const uint32 triangle, const uint32 vertex)
+    const {
+    const uint64 first = 3 * (uint64) triangle;
+    return _welded[_indices[first + 0]] == vertex ||
+           _welded[_indices[first + 1]] == vertex ||
+           _welded[_indices[first + 2]] == vertex;
+}
+
+void MeshSimplifier::get_ring(
+    const uint32 vertex, const uint32 other, Vector<uint32>& ring
+) const {
+    // Welded neighbours of a vertex, other than a given one, sorted
+    ring.clear();
+    const uint32 begin = _triangle_offsets[vertex];
+    const uint32 end   = _triangle_offsets[vertex + 1];
+    for (uint32 i = begin; i < end; i++) {
+        const uint64 first = 3 * (uint64) _triangles[i];
+        for (uint32 j = 0; j < 3; j++) {
+            const uint32 neighbour = _welded[_indices[first + j]];
+            if (neighbour != vertex && neighbour != other)
+                ring.push_back(neighbour);
+        }
+    }
+    std::sort(ring.begin(), ring.end());
+    ring.erase(std::unique(ring.begin(), ring.end()), ring.end());
+}
+
+} // namespace ENGINE_NAMESPACE
\ No newline at end of file
@@ -0,0 +1,371 @@
+#include "component/occlusion_buffer.hpp"
+
+#include "multithreading/parallel.hpp"
+
+#include <algorithm> // clamp, fill, min, max
+
+#if defined(__SSE__) || defined(_M_X64)
+#    include <xmmintrin.h>
+#endif
+
+namespace ENGINE_NAMESPACE {
+
+namespace {
+// Rows of the buffer rasterized by a single job
+constexpr int32   band_height = 16;
+// Clip space w of the near plane occluders are clipped by. Boxes reaching in
+// front of it are never culled
+constexpr float32 near_w      = 1e-4f;
+// Triangles with smaller (doubled) pixel area aren't rasterized
+constexpr float32 min_area    = 1e-6f;
+
+// Point at which segment [a, b] crosses the near plane
+glm::vec4 clip_near(const glm::vec4& a, const glm::vec4& b) {
+    const float32 t = (near_w - a.w) / (b.w - a.w);
+    return a + (b - a) * t;
+}
+
+// Pixel index range covered by [min, max] within [0, size), max inclusive
+void pixel_range(
+    const float32 min,
+    const float32 max,
+    const uint32  size,
+    int32&        first,
+    int32&        last
+) {
+    first = (int32) std::clamp(std::floor(min), 0.0f, (float32) size);
+    last  = (int32) std::clamp(std::ceil(max), 0.0f, (float32) size) - 1;
+}
+} // namespace
+
+// Constructor & Destructor
+OcclusionBuffer::OcclusionBuffer(const uint32 width, const uint32 height)
+    : _width((std::max(width, 1u) + 3) & ~3u), _height(std::max(height, 1u)),
+      _view_projection(1.0f) {
+    // Each level halves the previous one, down to a single row or column
+    glm::uvec2 size { _width, _height };
+    _level_sizes.push_back(size);
+    while (size.x > 1 && size.y > 1) {
+        size = (size + 1u) / 2u;
+        _level_sizes.push_back(size);
+    }
+    for (const auto& level_size : _level_sizes)
+        _levels.emplace_back((uint64) level_size.x * level_size.y, Infinity32);
+}
+OcclusionBuffer::~OcclusionBuffer() {}
+
+// /////////////////////////////// //
+// OCCLUSION BUFFER PUBLIC METHODS //
+// /////////////////////////////// //
+
+void OcclusionBuffer::begin(const glm::mat4& view_projection) {
+    _view_projection = view_projection;
+    _triangles.clear();
+    std::fill(_levels[0].begin(), _levels[0].end(), Infinity32);
+}
+
+void OcclusionBuffer::add_occluder(
+    const Vector<glm::vec3>& vertices,
+    const Vector<uint32>&    indices,
+    const glm::mat4&         model
+) {
+    const auto transform = _view_projection * model;
+    _clip_vertices.resize(vertices.size());
+    for (uint64 i = 0; i < vertices.size(); i++)
+        _clip_vertices[i] = transform * glm::vec4(vertices[i], 1.0f);
+
+    for (uint64 i = 0; i + 2 < indices.size(); i += 3) {
+        const glm::vec4 corners[3] { _clip_vertices[indices[i]],
+                                     _clip_vertices[indices[i + 1]],
+                                     _clip_vertices[indices[i + 2]] };
+
+        const uint32 in_front = (corners[0].w >= near_w) +
+                                (corners[1].w >= near_w) +
+                                (corners[2].w >= near_w);
+        if (in_front == 0) continue;
+        if (in_front == 3) {
+            // Triangles fully outside of a side of the view are skipped
+            bool outside = false;
+            for (uint32 axis = 0; axis < 2 && !outside; axis++)
+                outside = (corners[0][axis] > corners[0].w &&
+                           corners[1][axis] > corners[1].w &&
+                           corners[2][axis] > corners[2].w) ||
+                          (corners[0][axis] < -corners[0].w &&
+                           corners[1][axis] < -corners[1].w &&
+                           corners[2][axis] < -corners[2].w);
+            if (!outside) add_triangle(corners[0], corners[1], corners[2]);
+            continue;
+        }
+
+        // Part in front of the near plane, a triangle or a quad
+        glm::vec4 polygon[4];
+        uint32    count = 0;
+        for (uint32 j = 0; j < 3; j++) {
+            const auto& current = corners[j];
+            const auto& next    = corners[(j + 1) % 3];
+            if (current.w >= near_w) polygon[count++] = current;
+            if ((current.w >= near_w) != (next.w >= near_w))
+                polygon[count++] = clip_near(current, next);
+        }
+        add_triangle(polygon[0], polygon[1], polygon[2]);
+        if (count == 4) add_triangle(polygon[0], polygon[2], polygon[3]);
+    }
+}
+
+void OcclusionBuffer::rasterize() {
+    // Bands don't share pixels, so they are rasterized independently
+    const uint64 band_count = (_height + band_height - 1) / band_height;
+    Parallel::for_loop(
+        { 0, band_count },
+        1,
+        [this](const Parallel::Range bands) {
+            for (uint64 band = bands.begin; band < bands.end; band++)
+                rasterize_band(
+                    band * band_height,
+                    std::min((int32) (band + 1) * band_height, (int32) _height)
+                );
+        }
+    );
+    build_hierarchy();
+}
+
+bool OcclusionBuffer::is_visible(
+    const glm::vec3& center, const glm::vec3& half
+) const {
+    // Corners are the clip space center offset by clip space half axes
+    const auto clip_center = _view_projection * glm::vec4(center, 1.0f);
+    const auto axis_x      = _view_projection[0] * half.x;
+    const auto axis_y      = _view_projection[1] * half.y;
+    const auto axis_z      = _view_projection[2] * half.z;
+
+    glm::vec2 screen_min { Infinity32 };
+    glm::vec2 screen_max { -Infinity32 };
+    float32   min_depth = Infinity32;
+    for (uint32 corner = 0; corner < 8; corner++) {
+        const auto clip = clip_center + ((corner & 1) ? axis_x : -axis_x) +
+                          ((corner & 2) ? axis_y : -axis_y) +
+                          ((corner & 4) ? axis_z : -axis_z);
+        if (clip.w < near_w) return true;
+
+        const auto ndc = glm::vec3(clip) / clip.w;
+        screen_min     = glm::min(screen_min, glm::vec2(ndc));
+        screen_max     = glm::max(screen_max, glm::vec2(ndc));
+        min_depth      = std::min(min_depth, ndc.z);
+    }
+
+    // Covered pixels. Boxes off screen are left to frustum culling
+    int32 x0, x1, y0, y1;
+    pixel_range(
+        (screen_min.x * 0.5f + 0.5f) * _width,
+        (screen_max.x * 0.5f + 0.5f) * _width,
+        _width,
+        x0,
+        x1
+    );
+    pixel_range(
+        (screen_min.y * 0.5f + 0.5f) * _height,
+        (screen_max.y * 0.5f + 0.5f) * _height,
+        _height,
+        y0,
+        y1
+    );
+    if (x0 > x1 || y0 > y1) return true;
+
+    // Smallest level at which the box covers at most 3x3 texels
+    uint32      level = 0;
+    const int32 span  = std::max(x1 - x0, y1 - y0);
+    while (level + 1 < _levels.size() && (span >> level) > 1)
+        level++;
+
+    // Box is hidden if it's behind the farthest occluder depth it covers
+    const auto& texels = _levels[level];
+    const auto  width  = _level_sizes[level].x;
+    for (int32 y = y0 >> level; y <= y1 >> level; y++)
+        for (int32 x = x0 >> level; x <= x1 >> level; x++)
+            if (texels[(uint64) y * width + x] >= min_depth) return true;
+    return false;
+}
+
+void OcclusionBuffer::test(
+    const BBoxArray& boxes,
+    const uint64     begin,
+    const uint64     end,
+    uint8* const     visible
+) const {
+    for (uint64 i = begin; i < end; i++) {
+        if (!visible[i]) continue;
+        const glm::vec3 center { boxes.center_x[i],
+                                 boxes.center_y[i],
+                                 boxes.center_z[i] };
+        const glm::vec3 half { boxes.half_x[i],
+                               boxes.half_y[i],
+                               boxes.half_z[i] };
+        visible[i] = is_visible(center, half);
+    }
+}
+
+// //////////////////////////////// //
+// OCCLUSION BUFFER PRIVATE METHODS //
+// //////////////////////////////// //
+
+void OcclusionBuffer::add_triangle(
+    const glm::vec4& a, const glm::vec4& b, const glm::vec4& c
+) {
+    const glm::vec4* const corners[3] { &a, &b, &c };
+
+    // Pixel coordinates and depth
+    glm::vec3 points[3];
+    for (uint32 i = 0; i < 3; i++) {
+        const auto ndc = glm::vec3(*corners[i]) / corners[i]->w;
+        points[i]      = { (ndc.x * 0.5f + 0.5f) * _width,
+                           (ndc.y * 0.5f + 0.5f) * _height,
+                           ndc.z };
+    }
+
+    // Both facings are rasterized, with vertices ordered counter clockwise
+    float32 area = (points[1].x - points[0].x) * (points[2].y - points[0].y) -
+                   (points[1].y - points[0].y) * (points[2].x - points[0].x);
+    if (std::abs(area) < min_area) return;
+    if (area < 0.0f) {
+        std::swap(points[1], points[2]);
+        area = -area;
+    }
+
+    Triangle triangle;
+    int32    last_x, last_y;
+    pixel_range(
+        std::min({ points[0].x, points[1].x, points[2].x }),
+        std::max({ points[0].x, points[1].x, points[2].x }),
+        _width,
+        triangle.min_x,
+        last_x
+    );
+    pixel_range(
+        std::min({ points[0].y, points[1].y, points[2].y }),
+        std::max({ points[0].y, points[1].y, points[2].y }),
+        _height,
+        triangle.min_y,
+        last_y
+    );
+    triangle.max_x = last_x + 1;
+    triangle.max_y = last_y + 1;
+    if (triangle.min_x >= triangle.max_x || triangle.min_y >= triangle.max_y)
+        return;
+
+    // Edge i lies opposite to vertex i. Edge function divided by the area is
+    // the barycentric weight of that vertex, which interpolates depth
+    const float32 inverse_area = 1.0f / area;
+    triangle.depth_a           = 0.0f;
+    triangle.depth_b           = 0.0f;
+    triangle.depth_c           = 0.0f;
+    for (uint32 i = 0; i < 3; i++) {
+        const auto& from = points[(i + 1) % 3];
+        const auto& to   = points[(i + 2) % 3];
+
+        triangle.edge_a[i] = from.y - to.y;
+        triangle.edge_b[i] = to.x - from.x;
+        triangle.edge_c[i] = from.x * to.y - from.y * to.x;
+        triangle.depth_a += triangle.edge_a[i] * points[i].z * inverse_area;
+        triangle.depth_b += triangle.edge_b[i] * points[i].z * inverse_area;
+        triangle.depth_c += triangle.edge_c[i] * points[i].z * inverse_area;
+    }
+    _triangles.push_back(triangle);
+}
+
+void OcclusionBuffer::rasterize_band(
+    const int32 begin_row, const int32 end_row
+) {
+    float32* const depth = _levels[0].data();
+    for (const auto& triangle : _triangles) {
+        const int32 min_y = std::max(triangle.min_y, begin_row);
+        const int32 max_y = std::min(triangle.max_y, end_row);
+
+        for (int32 y = min_y; y < max_y; y++) {
+            float32* const row      = depth + (uint64) y * _width;
+            const float32  center_y = y + 0.5f;
+
+            float32 edge_row[3];
+            for (uint32 i = 0; i < 3; i++)
+                edge_row[i] =
+                    triangle.edge_b[i] * center_y + triangle.edge_c[i];
+            const float32 depth_row =
+                triangle.depth_b * center_y + triangle.depth_c;
+
+#if defined(__SSE__) || defined(_M_X64)
+            // 4 pixels at a time, starting at a multiple of 4. Buffer width
+            // is one too, so groups never cross the end of a row
+            const __m128 zero    = _mm_setzero_ps();
+            const __m128 step    = _mm_set1_ps(4.0f);
+            const __m128 offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+            const int32  min_x   = triangle.min_x & ~3;
+
+            __m128 center_x = _mm_add_ps(_mm_set1_ps((float32) min_x), offsets);
+            for (int32 x = min_x; x < triangle.max_x; x += 4) {
+                __m128 inside = _mm_cmpeq_ps(zero, zero);
+                for (uint32 i = 0; i < 3; i++) {
+                    const __m128 edge = _mm_add_ps(
+                        _mm_mul_ps(_mm_set1_ps(triangle.edge_a[i]), center_x),
+                        _mm_set1_ps(edge_row[i])
+                    );
+                    inside = _mm_and_ps(inside, _mm_cmpge_ps(edge, zero));
+                }
+                if (_mm_movemask_ps(inside) != 0) {
+                    const __m128 z = _mm_add_ps(
+                        _mm_mul_ps(_mm_set1_ps(triangle.depth_a), center_x),
+                        _mm_set1_ps(depth_row)
+                    );
+                    const __m128 current = _mm_loadu_ps(row + x);
+                    const __m128 nearest = _mm_min_ps(current, z);
+                    _mm_storeu_ps(
+                        row + x,
+                        _mm_or_ps(
+                            _mm_and_ps(inside, nearest),
+                            _mm_andnot_ps(inside, current)
+                        )
+                    );
+                }
+                center_x = _mm_add_ps(center_x, step);
+            }
+#else
+            for (int32 x = triangle.min_x; x < triangle.max_x; x++) {
+                const float32 center_x = x + 0.5f;
+
+                bool inside = true;
+                for (uint32 i = 0; i < 3; i++)
+                    inside &= triangle.edge_a[i] * center_x + edge_row[i] >=
+                              0.0f;
+                if (!inside) continue;
+
+                const float32 z = triangle.depth_a * center_x + depth_row;
+                row[x]          = std::min(row[x], z);
+            }
+#endif
+        }
+    }
+}
+
+void OcclusionBuffer::build_hierarchy() {
+    for (uint64 level = 1; level < _levels.size(); level++) {
+        const auto& source      = _levels[level - 1];
+        const auto  source_size = _level_sizes[level - 1];
+        auto&       target      = _levels[level];
+        const auto  target_size = _level_sizes[level];
+
+        for (uint32 y = 0; y < target_size.y; y++) {
+            const uint64 row_0 = (uint64) (2 * y) * source_size.x;
+            const uint64 row_1 =
+                (uint64) std::min(2 * y + 1, source_size.y - 1) * source_size.x;
+            for (uint32 x = 0; x < target_size.x; x++) {
+                const uint32 x_0 = 2 * x;
+                const uint32 x_1 = std::min(2 * x + 1, source_size.x - 1);
+
+                target[(uint64) y * target_size.x + x] = std::max(
+                    std::max(source[row_0 + x_0], source[row_0 + x_1]),
+                    std::max(source[row_1 + x_0], source[row_1 + x_1])
+                );
+            }
+        }
+    }
+}
+
+} // namespace ENGINE_NAMESPACE
\ No newline at end of file
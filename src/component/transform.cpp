@@ -2,6 +2,8 @@
 
 namespace ENGINE_NAMESPACE {
 
+uint64 Transform::_structure_version = 0;
+
 Transform::Transform(
     const glm::vec3 position, const glm::quat rotation, const glm::vec3 scale
 )
@@ -9,37 +11,42 @@ Transform::Transform(
 Transform::Transform(const Transform& transform)
     : Transform(transform.position, transform.rotation, transform.scale) {}
 
-Transform::~Transform() {}
+Transform::~Transform() {
+    // Children become roots
+    set_parent(nullptr);
+    while (_first_child) _first_child->set_parent(nullptr);
+}
 
 void Transform::copy(const Transform& transform) {
     _position = transform.position;
     _rotation = transform.rotation;
     _scale    = transform.scale;
+    invalidate();
 }
 
 void Transform::translate_by(const glm::vec3 translation) {
     _position += translation;
-    _is_dirty = true;
+    invalidate();
 }
 void Transform::rotate_by(const glm::quat rotation) {
     _rotation *= rotation;
-    _is_dirty = true;
+    invalidate();
 }
 void Transform::rotate_by(const glm::vec3 axis, const float32 angle) {
     _rotation = glm::angleAxis(angle, axis) * _rotation;
-    _is_dirty = true;
+    invalidate();
 }
 void Transform::rotate_by_deg(const glm::vec3 axis, const float32 angle) {
     _rotation = glm::angleAxis(glm::radians(angle), axis) * _rotation;
-    _is_dirty = true;
+    invalidate();
 }
 void Transform::scale_by(const glm::vec3 scale) {
     _scale *= scale;
-    _is_dirty = true;
+    invalidate();
 }
 void Transform::scale_by(const float32 scale) {
     _scale *= scale;
-    _is_dirty = true;
+    invalidate();
 }
 
 glm::mat4 Transform::local() {
@@ -54,9 +61,51 @@ glm::mat4 Transform::local() {
     return _local;
 }
 glm::mat4 Transform::world() {
-    auto local = this->local();
-    if (parent()) return parent()->world() * local;
-    return local;
+    if (_is_world_dirty) {
+        _is_world_dirty = false;
+        _world = _parent ? _parent->world() * local() : local();
+    }
+    return _world;
+}
+
+// ///////////////////////// //
+// TRANSFORM PRIVATE METHODS //
+// ///////////////////////// //
+
+void Transform::set_parent(Transform* const parent) {
+    if (parent == _parent) return;
+
+    // Unlink from current parent's children
+    if (_parent) {
+        Transform** link = &_parent->_first_child;
+        while (*link != this)
+            link = &(*link)->_next_sibling;
+        *link = _next_sibling;
+    }
+    // Link to new parent's children
+    _parent       = parent;
+    _next_sibling = nullptr;
+    if (_parent) {
+        _next_sibling         = _parent->_first_child;
+        _parent->_first_child = this;
+    }
+
+    _structure_version++;
+    invalidate_world();
+}
+
+void Transform::invalidate() {
+    _is_dirty = true;
+    invalidate_world();
+}
+
+void Transform::invalidate_world() {
+    // Children of a transform with outdated world matrix are always outdated
+    // too, so propagation stops there
+    if (_is_world_dirty) return;
+    _is_world_dirty = true;
+    for (auto child = _first_child; child; child = child->_next_sibling)
+        child->invalidate_world();
 }
 
 } // namespace ENGINE_NAMESPACE
\ No newline at end of file
@@ -0,0 +1,94 @@
+#include "component/transform_hierarchy.hpp"
+
+#include "multithreading/parallel.hpp"
+#include "containers/unordered_map.hpp"
+
+namespace ENGINE_NAMESPACE {
+
+namespace {
+// Minimal number of subtrees updated by a single job
+constexpr uint64 subtree_grain = 256;
+} // namespace
+
+// ////////////////////////////////// //
+// TRANSFORM HIERARCHY PUBLIC METHODS //
+// ////////////////////////////////// //
+
+void TransformHierarchy::build(const Vector<Transform*>& transforms) {
+    _structure_version = Transform::structure_version();
+    _transforms.resize(transforms.size());
+    for (uint64 i = 0; i < transforms.size(); i++)
+        _transforms[i] = transforms[i];
+
+    // Gather transforms with all their parents, marking roots on the way.
+    // Scratch lists grow, so they can't use the stack based temp allocator
+    UnorderedMap<Transform*, uint32> positions {};
+    Vector<Transform*>               roots {};
+    for (auto transform : transforms) {
+        while (transform && positions.count(transform) == 0) {
+            positions[transform] = no_parent;
+            if (transform->_parent == nullptr) roots.push_back(transform);
+            transform = transform->_parent;
+        }
+    }
+
+    // Depth first traversal from each root, over gathered transforms only
+    _nodes.clear();
+    _parents.clear();
+    _roots.clear();
+    Vector<Transform*> stack {};
+    for (const auto root : roots) {
+        _roots.push_back(_nodes.size());
+        stack.push_back(root);
+        while (!stack.empty()) {
+            const auto transform = stack.back();
+            stack.pop_back();
+
+            positions[transform] = _nodes.size();
+            _nodes.push_back(transform);
+            _parents.push_back(
+                transform->_parent ? positions[transform->_parent] : no_parent
+            );
+            for (auto child = transform->_first_child; child;
+                 child      = child->_next_sibling)
+                if (positions.count(child)) stack.push_back(child);
+        }
+    }
+
+    _tree_positions.resize(transforms.size());
+    for (uint64 i = 0; i < transforms.size(); i++)
+        _tree_positions[i] = positions[transforms[i]];
+    _world_matrices.resize(_nodes.size());
+    update();
+}
+
+void TransformHierarchy::update() {
+    if (_structure_version != Transform::structure_version())
+        build(_transforms);
+
+    // Parents precede children within a subtree, so their world matrices are
+    // up to date by the time children need them
+    Parallel::for_loop(
+        { 0, _roots.size() },
+        subtree_grain,
+        [this](const Parallel::Range subtrees) {
+            const uint64 begin = _roots[subtrees.begin];
+            const uint64 end   = subtrees.end < _roots.size()
+                                     ? _roots[subtrees.end]
+                                     : _nodes.size();
+            for (uint64 i = begin; i < end; i++) {
+                const auto transform = _nodes[i];
+                if (transform->_is_world_dirty) {
+                    transform->_is_world_dirty = false;
+                    transform->_world =
+                        _parents[i] == no_parent
+                            ? transform->local()
+                            : _world_matrices[_parents[i]] * transform->local();
+                }
+                _world_matrices[i] = transform->_world;
+            }
+        }
+    );
+}
+
+} // namespace ENGINE_NAMESPACE
\ No newline at end of file
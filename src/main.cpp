@@ -5,6 +5,7 @@
 #include "math_libs.hpp"
 
 #include "systems/memory/memory_system.hpp"
+#include "multithreading/job_system.hpp"
 #include "app/app_temp.hpp"
 
 using namespace ENGINE_NAMESPACE;
@@ -13,6 +14,7 @@ using namespace ENGINE_NAMESPACE;
 // TODO: UNIT TESTINGString message) {}
 
 int main(int, char**) {
+    JobSystem::initialize();
     TestApplication* app = new (MemoryTag::Application) TestApplication {};
 
 #ifdef NDEBUG
@@ -24,7 +26,9 @@ int main(int, char**) {
     app->run();
 
     del(app);
+    JobSystem::shutdown();
     MemorySystem::reset_memory(MemoryTag::Application);
+    MemorySystem::report_leaks();
 
     return EXIT_SUCCESS;
 }
\ No newline at end of file
@@ -0,0 +1,309 @@
+#include "multithreading/job_system.hpp"
+
+#include "logger.hpp"
+
+#include <algorithm>          // max
+#include <condition_variable> // condition_variable
+#include <mutex>              // mutex, unique_lock
+#include <thread>             // thread, yield
+
+namespace ENGINE_NAMESPACE {
+
+typedef JobSystem::Job Job;
+
+// Worker queues and shared state
+namespace {
+/**
+ * @brief Fixed capacity work stealing queue (Chase-Lev deque). Owning worker
+ * pushes and pops jobs at the bottom, other threads steal them from the top.
+ */
+class WorkQueue {
+  public:
+    static constexpr int64 capacity = 4096;
+
+    // Owner only. Fails if the queue is full
+    bool push(Job* const job) {
+        const int64 bottom = _bottom.load(std::memory_order_relaxed);
+        const int64 top    = _top.load(std::memory_order_acquire);
+        if (bottom - top >= capacity) return false;
+
+        _jobs[bottom & mask].store(job, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        _bottom.store(bottom + 1, std::memory_order_relaxed);
+        return true;
+    }
+    // Owner only. Returns most recently pushed job
+    Job* pop() {
+        const int64 bottom = _bottom.load(std::memory_order_relaxed) - 1;
+        _bottom.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64 top = _top.load(std::memory_order_relaxed);
+
+        if (top > bottom) {
+            _bottom.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        Job* job = _jobs[bottom & mask].load(std::memory_order_relaxed);
+        if (top == bottom) {
+            // Last job, race thieves for it
+            if (!_top.compare_exchange_strong(
+                    top,
+                    top + 1,
+                    std::memory_order_seq_cst,
+                    std::memory_order_relaxed
+                ))
+                job = nullptr;
+            _bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+        return job;
+    }
+    // Any thread. Returns least recently pushed job
+    Job* steal() {
+        int64 top = _top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const int64 bottom = _bottom.load(std::memory_order_acquire);
+        if (top >= bottom) return nullptr;
+
+        Job* const job = _jobs[top & mask].load(std::memory_order_relaxed);
+        if (!_top.compare_exchange_strong(
+                top,
+                top + 1,
+                std::memory_order_seq_cst,
+                std::memory_order_relaxed
+            ))
+            return nullptr;
+        return job;
+    }
+
+  private:
+    static constexpr int64 mask       = capacity - 1;
+    static constexpr int64 cache_line = 64;
+
+    // Top and bottom are kept on separate cache lines
+    std::atomic<int64> _top { 0 };
+    ubyte              _top_padding[cache_line - sizeof(int64)];
+    std::atomic<int64> _bottom { 0 };
+    ubyte              _bottom_padding[cache_line - sizeof(int64)];
+    std::atomic<Job*>  _jobs[capacity] {};
+};
+
+// One queue per worker, while threads are started for all but the first one
+WorkQueue*        queues      = nullptr;
+std::thread*      threads     = nullptr;
+uint32            queue_count = 0;
+bool              is_running  = false;
+std::atomic<bool> stopping { false };
+
+// Jobs submitted by non worker threads, or not fitting into a worker queue
+tbb::spin_mutex shared_lock {};
+Job*            shared_head = nullptr;
+Job*            shared_tail = nullptr;
+
+// Idle workers sleep until jobs are queued
+std::mutex              sleep_mutex {};
+std::condition_variable wake_condition {};
+std::atomic<int64>      queued_count { 0 };
+std::atomic<uint32>     sleeping_count { 0 };
+
+// Number of failed attempts to find a job before worker goes to sleep
+constexpr uint32 idle_spin_count = 64;
+
+thread_local uint32 current_worker = JobSystem::invalid_worker;
+thread_local uint32 steal_seed     = 0;
+
+void push_shared(Job* const job) {
+    shared_lock.lock();
+    if (shared_tail != nullptr) shared_tail->next = job;
+    else shared_head = job;
+    shared_tail = job;
+    shared_lock.unlock();
+}
+Job* pop_shared() {
+    shared_lock.lock();
+    Job* const job = shared_head;
+    if (job != nullptr) {
+        shared_head = job->next;
+        if (shared_head == nullptr) shared_tail = nullptr;
+        job->next = nullptr;
+    }
+    shared_lock.unlock();
+    return job;
+}
+
+Job* take_job() {
+    if (queued_count.load(std::memory_order_relaxed) <= 0) return nullptr;
+
+    const uint32 worker = current_worker;
+    Job*         job    = nullptr;
+    if (worker != JobSystem::invalid_worker) job = queues[worker].pop();
+    if (job == nullptr) job = pop_shared();
+
+    // Steal from others, starting at a random victim
+    if (job == nullptr && queue_count > 1) {
+        steal_seed         = steal_seed * 1664525 + 1013904223;
+        const uint32 start = (steal_seed >> 16) % queue_count;
+        for (uint32 i = 0; i < queue_count && job == nullptr; i++) {
+            const uint32 victim = (start + i) % queue_count;
+            if (victim != worker) job = queues[victim].steal();
+        }
+    }
+
+    if (job != nullptr) queued_count.fetch_sub(1);
+    return job;
+}
+
+void idle() {
+    for (uint32 i = 0; i < idle_spin_count; i++) {
+        if (queued_count.load() > 0 || stopping.load()) return;
+        std::this_thread::yield();
+    }
+
+    std::unique_lock<std::mutex> lock { sleep_mutex };
+    sleeping_count.fetch_add(1);
+    wake_condition.wait(lock, [] {
+        return queued_count.load() > 0 || stopping.load();
+    });
+    sleeping_count.fetch_sub(1);
+}
+} // namespace
+
+// ///////////////////////// //
+// JOB SYSTEM PUBLIC METHODS //
+// ///////////////////////// //
+
+void JobSystem::initialize(const uint32 worker_count) {
+    if (is_running) Logger::fatal(JOB_SYSTEM_LOG, "Already initialized.");
+
+    queue_count = (worker_count != 0)
+                      ? worker_count
+                      : std::max(std::thread::hardware_concurrency(), 1u);
+    queues      = new (MemoryTag::System) WorkQueue[queue_count];
+    threads     = new (MemoryTag::System) std::thread[queue_count - 1];
+
+    stopping.store(false);
+    is_running     = true;
+    current_worker = 0;
+    for (uint32 i = 1; i < queue_count; i++)
+        threads[i - 1] = std::thread(JobSystem::worker_loop, i);
+
+    Logger::trace(JOB_SYSTEM_LOG, "Started ", queue_count, " workers.");
+}
+
+void JobSystem::shutdown() {
+    if (!is_running) return;
+
+    // Queued jobs are still executed
+    while (queued_count.load() > 0) {
+        Job* const job = take_job();
+        if (job != nullptr) execute(job);
+        else std::this_thread::yield();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock { sleep_mutex };
+        stopping.store(true);
+    }
+    wake_condition.notify_all();
+    for (uint32 i = 0; i < queue_count - 1; i++)
+        threads[i].join();
+
+    delete[] threads;
+    delete[] queues;
+    threads        = nullptr;
+    queues         = nullptr;
+    queue_count    = 0;
+    is_running     = false;
+    current_worker = invalid_worker;
+
+    Logger::trace(JOB_SYSTEM_LOG, "Stopped.");
+}
+
+uint32 JobSystem::worker_count() { return std::max(queue_count, 1u); }
+uint32 JobSystem::worker_index() { return current_worker; }
+
+void JobSystem::wait(Counter& counter) {
+    while (!counter.is_done()) {
+        Job* const job = take_job();
+        if (job != nullptr) execute(job);
+        else std::this_thread::yield();
+    }
+
+    // Thread which finished the last job might still hold the lock
+    counter._lock.lock();
+    counter._lock.unlock();
+}
+
+// ////////////////////////// //
+// JOB SYSTEM PRIVATE METHODS //
+// ////////////////////////// //
+
+void JobSystem::submit(Job* const job) {
+    // Without workers, job is executed right away
+    if (!is_running) return execute(job);
+
+    queued_count.fetch_add(1);
+    const uint32 worker = current_worker;
+    if (worker == invalid_worker || !queues[worker].push(job)) push_shared(job);
+
+    // Lock makes sure the wake up isn't missed by a worker going to sleep
+    if (sleeping_count.load() > 0) {
+        { std::lock_guard<std::mutex> lock { sleep_mutex }; }
+        wake_condition.notify_one();
+    }
+}
+
+void JobSystem::add_continuation(Counter& dependency, Job* const job) {
+    dependency._lock.lock();
+    if (dependency._value.load() == 0) {
+        dependency._lock.unlock();
+        return submit(job);
+    }
+    job->next                 = dependency._continuations;
+    dependency._continuations = job;
+    dependency._lock.unlock();
+}
+
+void JobSystem::execute(Job* const job) {
+    const auto counter = job->counter;
+    job->function(job->storage);
+    del(job);
+    if (counter != nullptr) finish(*counter);
+}
+
+void JobSystem::finish(Counter& counter) {
+    // All but the last job only decrement
+    uint32 value = counter._value.load();
+    while (value > 1)
+        if (counter._value.compare_exchange_weak(value, value - 1)) return;
+
+    // Last one takes the continuations. Counter can be destroyed once waiters
+    // see it done, so it isn't touched after the lock is released
+    Job* continuation = nullptr;
+    counter._lock.lock();
+    if (counter._value.fetch_sub(1) == 1) {
+        continuation           = counter._continuations;
+        counter._continuations = nullptr;
+    }
+    counter._lock.unlock();
+
+    while (continuation != nullptr) {
+        const auto next    = continuation->next;
+        continuation->next = nullptr;
+        submit(continuation);
+        continuation = next;
+    }
+}
+
+void JobSystem::worker_loop(const uint32 index) {
+    current_worker = index;
+    steal_seed     = index;
+    while (true) {
+        Job* const job = take_job();
+        if (job != nullptr) execute(job);
+        else if (stopping.load()) break;
+        else idle();
+    }
+    current_worker = invalid_worker;
+}
+
+} // namespace ENGINE_NAMESPACE
\ No newline at end of file
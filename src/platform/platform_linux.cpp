@@ -9,6 +9,14 @@
 #        include <unistd.h>
 #    endif
 
+#    include <sys/mman.h> // mmap, mprotect, madvise
+#    include <unistd.h>   // sysconf
+#    include <stdio.h>    // fopen, fscanf
+#    include <algorithm>  // min
+#    include <stdlib.h>   // free
+#    include <execinfo.h> // backtrace, backtrace_symbols
+#    include <cxxabi.h>   // __cxa_demangle
+
 #    include "multithreading/parallel.hpp"
 
 namespace ENGINE_NAMESPACE {
@@ -52,6 +60,121 @@ void Platform::Console::write(std::string message, uint32 kind, bool new_line) {
     mutex.unlock();
 }
 
+// ///////// //
+// Callstack //
+// ///////// //
+
+uint32 Platform::capture_callstack(
+    void** const frames, const uint32 max_frames, const uint32 skip
+) {
+    // Capture into a local buffer first, so this frame can be skipped too
+    constexpr int max_depth = 64;
+    void*         buffer[max_depth];
+
+    const int depth = backtrace(
+        buffer, (int) std::min<uint64>(max_depth, max_frames + skip + 1)
+    );
+
+    uint32 count = 0;
+    for (int i = skip + 1; i < depth; i++)
+        frames[count++] = buffer[i];
+    return count;
+}
+
+std::string Platform::callstack_to_string(
+    void* const* const frames, const uint32 frame_count
+) {
+    // Symbols are allocated with malloc, not through the memory system
+    char** const symbols = backtrace_symbols(frames, frame_count);
+    if (symbols == nullptr) return "";
+
+    std::string result {};
+    for (uint32 i = 0; i < frame_count; i++) {
+        // Symbols look like "binary(mangled_name+offset) [address]"
+        std::string symbol = symbols[i];
+        const auto  begin  = symbol.find('(');
+        const auto  end    = symbol.find('+', begin);
+        if (begin != std::string::npos && end != std::string::npos &&
+            end > begin + 1) {
+            const auto name  = symbol.substr(begin + 1, end - begin - 1);
+            int        state = 0;
+
+            // Replace mangled name if it can be demangled
+            const auto demangled =
+                abi::__cxa_demangle(name.c_str(), nullptr, nullptr, &state);
+            if (state == 0) symbol.replace(begin + 1, name.size(), demangled);
+            ::free(demangled);
+        }
+        result += "    " + symbol + "\n";
+    }
+    ::free(symbols);
+    return result;
+}
+
+// ////////////// //
+// Virtual memory //
+// ////////////// //
+
+uint64 Platform::VirtualMemory::page_size() {
+    static const uint64 size = sysconf(_SC_PAGESIZE);
+    return size;
+}
+
+uint64 Platform::VirtualMemory::huge_page_size() {
+    // Transparent huge pages are PMD sized
+    static const uint64 size = []() {
+        uint64 result = 0;
+        FILE*  file =
+            fopen("/sys/kernel/mm/transparent_hugepage/hpage_pmd_size", "r");
+        if (file == nullptr) return result;
+        if (fscanf(file, "%llu", &result) != 1) result = 0;
+        fclose(file);
+        return result;
+    }();
+    return size;
+}
+
+void* Platform::VirtualMemory::reserve(const uint64 size) {
+    void* const address = mmap(
+        nullptr,
+        size,
+        PROT_NONE,
+        MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+        -1,
+        0
+    );
+    if (address == MAP_FAILED) return nullptr;
+    return address;
+}
+
+bool Platform::VirtualMemory::commit(void* const address, const uint64 size) {
+    const auto aligned_size = get_aligned(size, page_size());
+    return mprotect(address, aligned_size, PROT_READ | PROT_WRITE) == 0;
+}
+
+void Platform::VirtualMemory::decommit(void* const address, const uint64 size) {
+    const auto aligned_size = get_aligned(size, page_size());
+    madvise(address, aligned_size, MADV_DONTNEED);
+    mprotect(address, aligned_size, PROT_NONE);
+}
+
+void Platform::VirtualMemory::release(void* const address, const uint64 size) {
+    munmap(address, size);
+}
+
+bool Platform::VirtualMemory::use_huge_pages(
+    void* const address, const uint64 size
+) {
+    // Transparent huge pages. Explicit ones (MAP_HUGETLB) would need a
+    // preallocated pool and huge page aligned commits, so they aren't used
+#        ifdef MADV_HUGEPAGE
+    if (huge_page_size() == 0) return false;
+    return madvise(address, size, MADV_HUGEPAGE) == 0;
+#        else
+    return false;
+#        endif
+}
+
 } // namespace ENGINE_NAMESPACE
 
 #endif
\ No newline at end of file
@@ -3,6 +3,7 @@
 #if PLATFORM == WINDOWS32
 
 #    include <windows.h>
+#    include <stdio.h> // snprintf
 
 namespace ENGINE_NAMESPACE {
 
@@ -75,6 +76,73 @@ void Platform::Console::write(std::string message, uint32 kind, bool new_line) {
     if (new_line) { std::cout << std::endl; }
 }
 
+// ///////// //
+// Callstack //
+// ///////// //
+
+uint32 Platform::capture_callstack(
+    void** const frames, const uint32 max_frames, const uint32 skip
+) {
+    // Skip this frame as well
+    return CaptureStackBackTrace(skip + 1, max_frames, frames, nullptr);
+}
+
+std::string Platform::callstack_to_string(
+    void* const* const frames, const uint32 frame_count
+) {
+    // Resolving symbols would require DbgHelp, so only addresses are listed
+    std::string result {};
+    char        line[32];
+    for (uint32 i = 0; i < frame_count; i++) {
+        snprintf(line, sizeof(line), "    %p\n", frames[i]);
+        result += line;
+    }
+    return result;
+}
+
+// ////////////// //
+// Virtual memory //
+// ////////////// //
+
+uint64 Platform::VirtualMemory::page_size() {
+    static const uint64 size = []() {
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        return (uint64) info.dwPageSize;
+    }();
+    return size;
+}
+
+void* Platform::VirtualMemory::reserve(const uint64 size) {
+    return VirtualAlloc(nullptr, size, MEM_RESERVE, PAGE_NOACCESS);
+}
+
+uint64 Platform::VirtualMemory::huge_page_size() {
+    // Large pages can't be commited lazily (and require a special privilege)
+    return 0;
+}
+
+bool Platform::VirtualMemory::commit(void* const address, const uint64 size) {
+    const auto aligned_size = get_aligned(size, page_size());
+    return VirtualAlloc(address, aligned_size, MEM_COMMIT, PAGE_READWRITE) !=
+           nullptr;
+}
+
+void Platform::VirtualMemory::decommit(void* const address, const uint64 size) {
+    const auto aligned_size = get_aligned(size, page_size());
+    VirtualFree(address, aligned_size, MEM_DECOMMIT);
+}
+
+void Platform::VirtualMemory::release(void* const address, const uint64 size) {
+    VirtualFree(address, 0, MEM_RELEASE);
+}
+
+bool Platform::VirtualMemory::use_huge_pages(
+    void* const address, const uint64 size
+) {
+    return false;
+}
+
 } // namespace ENGINE_NAMESPACE
 
 #endif
\ No newline at end of file
@@ -137,8 +137,8 @@ glm::mat4 DirectionalLight::get_light_space_matrix(uint32 rp_index) const {
     return light_space_matrix;
 }
 
-Vector<glm::mat4> DirectionalLight::get_light_space_matrices() const {
-    Vector<glm::mat4> light_space_matrices;
+SmallVector<glm::mat4, 4> DirectionalLight::get_light_space_matrices() const {
+    SmallVector<glm::mat4, 4> light_space_matrices;
     for (size_t i = 0; i < _views.size(); ++i) {
         light_space_matrices.push_back(get_light_space_matrix(i));
     }
@@ -197,6 +197,10 @@ void DirectionalLight::create_cascade_views(
 
         _views.at(i)->set_visible_meshes(meshes);
     }
+
+    // Cascades are culled together
+    for (const auto view : _views)
+        view->set_cascades(&data.direction, _views);
 }
 
 } // namespace ENGINE_NAMESPACE
@@ -23,7 +23,7 @@ RenderModule::~RenderModule() {
     for (const auto map : _own_maps)
         _renderer->destroy_texture_map(map);
     for (const auto texture : _own_textures)
-        _texture_system->release(texture->name);
+        _texture_system->release(texture);
 }
 
 // //////////////////////////// //
@@ -94,7 +94,28 @@ void RenderModule::setup_uniform_indices(String uniform) {
 }
 
 ModulePacket* RenderModule::on_build_pocket() {
-    return new (MemoryTag::Temp) ModulePacket { this };
+    return new (MemoryTag::Frame) ModulePacket { this };
+}
+
+uint64 RenderModule::draw_instances(
+    const Vector<GeometryRenderData>& render_data, const uint64 begin
+) {
+    const auto geometry = render_data[begin].geometry;
+    const auto material = render_data[begin].material;
+    const auto lod      = render_data[begin].lod;
+
+    _instance_models.clear();
+    uint64 end = begin;
+    for (; end < render_data.size(); end++) {
+        const auto& data = render_data[end];
+        if (data.geometry != geometry || data.material != material ||
+            data.lod != lod)
+            break;
+        _instance_models.push_back(data.model);
+    }
+
+    _renderer->draw_geometry(geometry, _instance_models, lod);
+    return end;
 }
 
 // ///////////////////////////// //
@@ -0,0 +1,156 @@
+#include "renderer/render_queue.hpp"
+
+#include <algorithm> // clamp, find
+
+namespace ENGINE_NAMESPACE {
+
+namespace {
+// Key fields, see class description
+constexpr uint32 layer_offset    = 63;
+constexpr uint32 pass_offset     = 60;
+constexpr uint32 pass_bits       = 3;
+constexpr uint32 shader_bits     = 8;
+constexpr uint32 material_bits   = 16;
+constexpr uint32 geometry_bits   = 18;
+constexpr uint32 lod_bits        = 2;
+constexpr uint32 depth_bits      = 16;
+// Shader, material, geometry and its level of detail, as a single field
+constexpr uint32 geometry_offset = lod_bits;
+constexpr uint32 material_offset = geometry_offset + geometry_bits;
+constexpr uint32 shader_offset   = material_offset + material_bits;
+constexpr uint32 state_bits      = shader_offset + shader_bits;
+
+// Radix sort digits
+constexpr uint32 digit_bits   = 8;
+constexpr uint32 digit_count  = 64 / digit_bits;
+constexpr uint32 bucket_count = 1 << digit_bits;
+
+constexpr uint64 mask(const uint32 bits) { return (1ull << bits) - 1; }
+
+uint32 get_digit(const uint64 key, const uint32 digit) {
+    return (key >> (digit * digit_bits)) & mask(digit_bits);
+}
+} // namespace
+
+// /////////////////////////// //
+// RENDER QUEUE PUBLIC METHODS //
+// /////////////////////////// //
+
+void RenderQueue::clear(const float32 max_depth) {
+    _depth_scale = (max_depth > 0.0f) ? mask(depth_bits) / max_depth : 0.0f;
+    _draws.clear();
+    _items.clear();
+}
+
+void RenderQueue::add(
+    const GeometryRenderData& data,
+    const float32             depth,
+    const bool                transparent,
+    const uint8               pass
+) {
+    const auto material = data.material;
+    const auto geometry = data.geometry;
+
+    // Ids only serve for grouping, so they are truncated to their field
+    const uint64 shader_key = material ? get_shader_key(material->shader()) : 0;
+    const uint64 material_key =
+        (material && material->id.has_value()) ? material->id.value() : 0;
+    const uint64 geometry_key =
+        (geometry && geometry->internal_id.has_value())
+            ? geometry->internal_id.value()
+            : 0;
+    const uint64 state =
+        (shader_key & mask(shader_bits)) << shader_offset |
+        (material_key & mask(material_bits)) << material_offset |
+        (geometry_key & mask(geometry_bits)) << geometry_offset |
+        (data.lod & mask(lod_bits));
+    const uint64 depth_key = (uint64) std::clamp(
+        depth * _depth_scale, 0.0f, (float32) mask(depth_bits)
+    );
+
+    uint64 key = (uint64) transparent << layer_offset |
+                 (uint64) (pass & mask(pass_bits)) << pass_offset;
+    if (transparent)
+        key |= (mask(depth_bits) - depth_key) << state_bits | state;
+    else key |= state << depth_bits | depth_key;
+
+    _items.push_back({ key, _draws.size() });
+    _draws.push_back(data);
+}
+
+void RenderQueue::sort() {
+    // Histograms of all digits are computed in a single pass
+    uint32 counts[digit_count][bucket_count] {};
+    for (const auto& item : _items)
+        for (uint32 digit = 0; digit < digit_count; digit++)
+            counts[digit][get_digit(item.key, digit)]++;
+
+    // Least significant digit first. Digits equal for all keys are skipped
+    _sort_buffer.resize(_items.size());
+    for (uint32 digit = 0; digit < digit_count; digit++) {
+        const auto& count = counts[digit];
+        if (_items.empty() ||
+            count[get_digit(_items[0].key, digit)] == _items.size())
+            continue;
+
+        uint32 offsets[bucket_count];
+        uint32 offset = 0;
+        for (uint32 bucket = 0; bucket < bucket_count; bucket++) {
+            offsets[bucket] = offset;
+            offset += count[bucket];
+        }
+        for (const auto& item : _items)
+            _sort_buffer[offsets[get_digit(item.key, digit)]++] = item;
+        _items.swap(_sort_buffer);
+    }
+
+    compute_stats();
+}
+
+void RenderQueue::get_draws(Vector<GeometryRenderData>& result) const {
+    result.reserve(result.size() + _items.size());
+    for (const auto& item : _items)
+        result.push_back(_draws[item.index]);
+}
+
+// //////////////////////////// //
+// RENDER QUEUE PRIVATE METHODS //
+// //////////////////////////// //
+
+uint8 RenderQueue::get_shader_key(const Shader* const shader) {
+    const auto it = std::find(_shaders.begin(), _shaders.end(), shader);
+    if (it != _shaders.end()) return it - _shaders.begin();
+    _shaders.push_back(shader);
+    return _shaders.size() - 1;
+}
+
+void RenderQueue::compute_stats() {
+    // Counts changes of material and geometry between consecutive draws
+    const auto count_changes = [&](const auto& get_draw) {
+        Stats           stats {};
+        const Material* material = nullptr;
+        const Geometry* geometry = nullptr;
+        for (uint64 i = 0; i < _draws.size(); i++) {
+            const auto& draw = get_draw(i);
+            stats.materials += draw.material != material;
+            stats.geometries += draw.geometry != geometry;
+            material = draw.material;
+            geometry = draw.geometry;
+        }
+        return stats;
+    };
+    const auto submitted = count_changes([&](const uint64 i) -> const auto& {
+        return _draws[i];
+    });
+    const auto sorted = count_changes([&](const uint64 i) -> const auto& {
+        return _draws[_items[i].index];
+    });
+
+    _stats.draws                = _draws.size();
+    _stats.submitted_materials  = submitted.materials;
+    _stats.submitted_geometries = submitted.geometries;
+    _stats.materials            = sorted.materials;
+    _stats.geometries           = sorted.geometries;
+}
+
+} // namespace ENGINE_NAMESPACE
\ No newline at end of file
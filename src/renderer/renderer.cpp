@@ -1,12 +1,24 @@
 #include "renderer/renderer.hpp"
 
 #include "renderer/modules/render_module.hpp"
+#include "renderer/views/render_view.hpp"
+#include "multithreading/job_system.hpp"
 #include "timer.hpp"
 
+#include <algorithm> // find
+
 namespace ENGINE_NAMESPACE {
 
 #define RENDERER_LOG "Renderer :: "
 
+namespace {
+// Wall clock interval of one frame preparation job, in seconds
+struct JobTime {
+    float64 start = 0.0;
+    float64 end   = 0.0;
+};
+} // namespace
+
 // Constructor & Destructor
 Renderer::Renderer(
     const RendererBackend::Type backend_type, Platform::Surface* const surface
@@ -31,11 +43,129 @@ Renderer::~Renderer() { del(_backend); }
 // RENDERER PUBLIC METHODS //
 // /////////////////////// //
 
+Result<void, RuntimeError> Renderer::prepare_frame() {
+    // Views are prepared for the new frame number before the frame is drawn
+    _backend->increment_frame_number();
+
+    auto result = _backend->wait_for_frame();
+    if (result.has_error()) return Failure(result.error());
+
+    // Frame memory of this frame in flight is no longer in use
+    MemorySystem::begin_frame(result.value());
+    return {};
+}
+
+void Renderer::build_packet(
+    const Vector<RenderModule*>& modules, Packet* const packet
+) {
+    const uint64  frame_number = _backend->get_current_frame();
+    const float64 start_time   = Platform::get_absolute_time();
+
+    // Collect views drawn by modules. Shared views are prepared only once
+    Vector<RenderView*> views { { MemoryTag::Frame } };
+    for (const auto module : modules)
+        module->add_render_views(views);
+    uint64 view_count = 0;
+    for (const auto view : views)
+        if (std::find(views.begin(), views.begin() + view_count, view) ==
+            views.begin() + view_count)
+            views[view_count++] = view;
+    views.resize(view_count);
+
+    // Outdated world matrices are resolved before any concurrent reads. Views
+    // may share transforms, so they are updated one by one (each in parallel
+    // across its transform subtrees). This is the serial part of frame
+    // preparation
+    for (const auto view : views)
+        view->update_transforms();
+    const float64 serial_time = Platform::get_absolute_time() - start_time;
+
+    // One job per module packet and per view. Results are written into their
+    // own slots, so module packets stay in the order of modules
+    const uint64    job_count = modules.size() + views.size();
+    Vector<JobTime> job_times(job_count, JobTime {}, { MemoryTag::Frame });
+    packet->module_data.resize(modules.size());
+
+    JobSystem::Counter counter {};
+    for (uint64 i = 0; i < modules.size(); i++)
+        JobSystem::run(
+            [&, i] {
+                job_times[i].start     = Platform::get_absolute_time();
+                packet->module_data[i] = modules[i]->build_pocket();
+                job_times[i].end       = Platform::get_absolute_time();
+            },
+            &counter
+        );
+    for (uint64 i = 0; i < views.size(); i++)
+        JobSystem::run(
+            [&, i] {
+                auto& time = job_times[modules.size() + i];
+                time.start = Platform::get_absolute_time();
+                views[i]->prepare_render_data(frame_number);
+                time.end = Platform::get_absolute_time();
+            },
+            &counter
+        );
+    JobSystem::wait(counter);
+
+    // Log how far frame preparation is from its critical path (serial part
+    // followed by the longest job)
+    Timer& timer = Timer::global_timer;
+    if (!timer.is_running()) return;
+
+    const float64 wall_time    = Platform::get_absolute_time() - start_time;
+    float64       work_time    = 0.0;
+    float64       longest_time = 0.0;
+    uint64        longest_job  = 0;
+    for (uint64 i = 0; i < job_count; i++) {
+        const float64 duration = job_times[i].end - job_times[i].start;
+        work_time += duration;
+        if (duration <= longest_time) continue;
+        longest_time = duration;
+        longest_job  = i;
+    }
+    const String longest_name =
+        (longest_job < modules.size())
+            ? String::build("module ", longest_job)
+            : views[longest_job - modules.size()]->name();
+    Logger::log(
+        "Frame prepared in ",
+        wall_time * 1000,
+        "ms (serial ",
+        serial_time * 1000,
+        "ms, jobs ",
+        work_time * 1000,
+        "ms, critical path ",
+        (serial_time + longest_time) * 1000,
+        "ms through ",
+        longest_name,
+        ")"
+    );
+
+    // Log binds saved by sorting render data of views
+    uint64 sorted_draws    = 0;
+    uint64 saved_materials = 0;
+    uint64 saved_buffers   = 0;
+    for (const auto view : views) {
+        const auto& stats = view->get_queue_stats();
+        sorted_draws += stats.draws;
+        saved_materials += stats.saved_materials();
+        saved_buffers += stats.saved_geometries();
+    }
+    Logger::log(
+        "Draws sorted: ",
+        sorted_draws,
+        " (material binds saved ",
+        saved_materials,
+        ", vertex & index buffer binds saved ",
+        saved_buffers,
+        ")"
+    );
+}
+
 Result<void, RuntimeError> Renderer::draw_frame(
     const Packet* const render_data, const float32 delta_time
 ) {
-    _backend->increment_frame_number();
-
     // Timer
     Timer& timer = Timer::global_timer;
 
@@ -48,16 +178,33 @@ Result<void, RuntimeError> Renderer::draw_frame(
 
     timer.time("Frame begun in ");
 
-    // Render each module
+    // Render each module, counting its draws
+    String module_draws {};
+    _draw_count      = 0;
+    _draw_call_count = 0;
     for (const auto& data : render_data->module_data) {
+        const uint64 draw_count = _draw_count;
         data->module->render(data, _backend->get_current_frame());
+        if (timer.is_running())
+            module_draws += String::build(" ", _draw_count - draw_count);
     }
 
-    // Clear render module packets in reverse order
+    // Destroy render module packets in reverse order. Their memory is
+    // released together with the rest of this frame's memory
     for (int32 i = render_data->module_data.size() - 1; i >= 0; i--)
-        del(render_data->module_data[i]);
+        render_data->module_data[i]->~ModulePacket();
 
     timer.time("On render preformed in ");
+    if (timer.is_running())
+        Logger::log(
+            "Geometries drawn: ",
+            _draw_count,
+            " in ",
+            _draw_call_count,
+            " draw calls (per module:",
+            module_draws,
+            ")"
+        );
 
     // End frame
     result = _backend->end_frame(delta_time);
@@ -70,8 +217,22 @@ Result<void, RuntimeError> Renderer::draw_frame(
     return {};
 }
 
-void Renderer::draw_geometry(Geometry* const geometry) {
-    _backend->draw_geometry(geometry);
+void Renderer::draw_geometry(Geometry* const geometry, const uint8 lod) {
+    _backend->draw_geometry(geometry, lod);
+    _draw_count++;
+    _draw_call_count++;
+}
+
+void Renderer::draw_geometry(
+    Geometry* const          geometry,
+    const Vector<glm::mat4>& models,
+    const uint8              lod
+) {
+    _backend->draw_geometry(
+        geometry, lod, models.data(), sizeof(glm::mat4), models.size()
+    );
+    _draw_count += models.size();
+    _draw_call_count++;
 }
 
 void Renderer::on_resize(const uint32 width, const uint32 height) {
@@ -0,0 +1,88 @@
+#include "renderer/views/render_view.hpp"
+
+#include "resources/mesh.hpp"
+#include "multithreading/parallel.hpp"
+
+namespace ENGINE_NAMESPACE {
+
+// Minimal number of geometries culled by a single job
+constexpr uint64  cull_grain      = 1024;
+// Screen size (relative to view height) below which full detail isn't drawn
+constexpr float32 lod_screen_size = 0.5f;
+
+// ////////////////////////// //
+// RENDER VIEW PUBLIC METHODS //
+// ////////////////////////// //
+
+void RenderView::set_visible_meshes(const Vector<Mesh*>& meshes) {
+    // Copy references over
+    _potentially_visible_meshes.resize(meshes.size());
+    for (uint64 i = 0; i < meshes.size(); i++)
+        _potentially_visible_meshes[i] = meshes[i];
+
+    Vector<Transform*> transforms {};
+    transforms.reserve(meshes.size());
+    for (const auto mesh : meshes)
+        transforms.push_back(&mesh->transform);
+    _transforms.build(transforms);
+}
+
+void RenderView::update_transforms() { _transforms.update(); }
+
+void RenderView::prepare_render_data(const uint64 frame_number) {
+    // Only update once per frame
+    if (_last_frame == frame_number) return;
+    _last_frame = frame_number;
+
+    // Clear geometry data
+    _visible_render_data.clear();
+    compute_visible_render_data();
+}
+
+// ///////////////////////////// //
+// RENDER VIEW PROTECTED METHODS //
+// ///////////////////////////// //
+
+void RenderView::cull_geometries(const Frustum& frustum) {
+    // List geometries, world matrices were computed per mesh beforehand
+    _cull_entries.clear();
+    for (uint32 i = 0; i < _potentially_visible_meshes.size(); i++)
+        for (const auto geometry : _potentially_visible_meshes[i]->geometries())
+            _cull_entries.push_back({ geometry, i });
+
+    // Each chunk computes its world space bounds, then culls them
+    const uint64 geometry_count = _cull_entries.size();
+    _world_bounds.resize(geometry_count);
+    _visibility.resize(geometry_count);
+    Parallel::for_loop(
+        { 0, geometry_count },
+        cull_grain,
+        [&](const Parallel::Range chunk) {
+            for (uint64 i = chunk.begin; i < chunk.end; i++) {
+                const auto& entry    = _cull_entries[i];
+                const auto  geometry = static_cast<Geometry3D*>(entry.geometry);
+                _world_bounds.set_transformed(
+                    i, geometry->bbox, _transforms.world(entry.mesh_index)
+                );
+            }
+            frustum.cull(
+                _world_bounds, chunk.begin, chunk.end, _visibility.data()
+            );
+        }
+    );
+}
+
+uint8 RenderView::select_lod(
+    const Geometry* const geometry, const float32 screen_size
+) const {
+    const uint8 lod_count = geometry->lod_count();
+    float32     threshold = lod_screen_size * _lod_bias;
+    uint8       lod       = 0;
+    while (lod + 1 < lod_count && screen_size < threshold) {
+        threshold *= 0.5f;
+        lod++;
+    }
+    return lod;
+}
+
+} // namespace ENGINE_NAMESPACE
\ No newline at end of file
@@ -1,11 +1,22 @@
 #include "renderer/views/render_view_directional_shadow.hpp"
 #include "resources/mesh.hpp"
+#include "containers/small_vector.hpp"
+
+#include <algorithm> // stable_sort
 
 namespace ENGINE_NAMESPACE {
 
+namespace {
+// Shadow casters switch to coarser levels of detail at 4 times the screen
+// size of perspective views. Cascades span hundreds of units, while casters
+// only show as shadow silhouettes
+constexpr float32 shadow_lod_bias = 4.0f;
+} // namespace
+
 // Constructor & Destructor
 RenderViewDirectionalShadow::RenderViewDirectionalShadow(const RenderView::Config& config)
     : RenderViewOrthographic(config) {
+    _lod_bias = shadow_lod_bias;
 
     _proj_matrix = glm::ortho(
         -1.0f * (float32) _width, (float32) _width, -1.0f * (float32) _height, (float32) _height, _near_clip, _far_clip
@@ -52,27 +63,138 @@ glm::vec3 RenderViewDirectionalShadow::get_light_camera_position(glm::vec3 light
     return _camera->transform.position() - glm::normalize(light_dir) * (_far_clip * 0.5f);
 }
 
-Vector<GeometryRenderData>& RenderViewDirectionalShadow::get_visible_render_data(
-    const uint32 frame_number
+void RenderViewDirectionalShadow::set_cascades(
+    const glm::vec4* const                      light_direction,
+    const Vector<RenderViewDirectionalShadow*>& cascades
 ) {
-    // Only update once per frame
-    if (_last_frame == frame_number) return _visible_render_data;
-    _last_frame = frame_number;
-
-    // Clear geometry data
-    _visible_render_data.clear();
-
-    // Update render data
-    // TODO: add frustrum culling
-    for (const auto& mesh : _potentially_visible_meshes) {
-        const auto model_matrix = mesh->transform.world();
-        for (auto* const geom : mesh->geometries())
-            _visible_render_data.push_back(
-                { geom, geom->material, model_matrix }
+    _light_direction = light_direction;
+    _cascades        = cascades;
+}
+
+// /////////////////////////////////////////////// //
+// RENDER VIEW DIRECTIONAL SHADOW PROTECTED METHODS //
+// /////////////////////////////////////////////// //
+
+void RenderViewDirectionalShadow::compute_visible_render_data() {
+    // Without culling setup every geometry is a potential caster
+    if (_light_direction == nullptr || _cascades.empty()) {
+        for (uint64 i = 0; i < _potentially_visible_meshes.size(); i++) {
+            const auto  mesh         = _potentially_visible_meshes[i];
+            const auto& model_matrix = _transforms.world(i);
+            for (auto* const geom : mesh->geometries())
+                _visible_render_data.push_back(
+                    { geom, geom->material, model_matrix }
+                );
+        }
+        return;
+    }
+
+    // First cascade prepares all of them
+    if (_cascades[0] == this) cull_cascades();
+    else _cascades[0]->prepare_render_data(_last_frame);
+}
+
+// ///////////////////////////////////////////// //
+// RENDER VIEW DIRECTIONAL SHADOW PRIVATE METHODS //
+// ///////////////////////////////////////////// //
+
+Frustum RenderViewDirectionalShadow::get_culling_volume() const {
+    // Casters between the light and the volume still shadow its content
+    Frustum volume { _proj_matrix * get_view_matrix(*_light_direction) };
+    volume.extend_near_plane(Infinity32);
+    return volume;
+}
+
+bool RenderViewDirectionalShadow::contains_volume(
+    const RenderViewDirectionalShadow* const other
+) const {
+    // Cascades are centered at the camera, looking in the light direction
+    return _camera == other->_camera && _near_clip == other->_near_clip &&
+           _far_clip == other->_far_clip && _width >= other->_width &&
+           _height >= other->_height;
+}
+
+void RenderViewDirectionalShadow::cull_cascades() {
+    // Larger cascades first, so that cascades contained within them only test
+    // geometries they see
+    SmallVector<RenderViewDirectionalShadow*, 4> cascades {};
+    for (const auto cascade : _cascades)
+        cascades.push_back(cascade);
+    std::stable_sort(
+        cascades.begin(),
+        cascades.end(),
+        [](const RenderViewDirectionalShadow* const a,
+           const RenderViewDirectionalShadow* const b) {
+            return a->_width * a->_height > b->_width * b->_height;
+        }
+    );
+
+    // World space bounds are computed while culling the largest cascade
+    cull_geometries(cascades[0]->get_culling_volume());
+    const uint64 geometry_count = _cull_entries.size();
+    _candidates.clear();
+    for (uint32 i = 0; i < geometry_count; i++)
+        if (_visibility[i]) _candidates.push_back(i);
+
+    for (uint64 i = 0; i < cascades.size(); i++) {
+        const auto cascade = cascades[i];
+        if (i > 0) {
+            // Unless contained in the previous cascade, all geometries are
+            // tested again
+            if (!cascades[i - 1]->contains_volume(cascade)) {
+                _candidates.resize(geometry_count);
+                for (uint32 j = 0; j < geometry_count; j++)
+                    _candidates[j] = j;
+            }
+
+            // Cull bounds of remaining candidates
+            const uint64 candidate_count = _candidates.size();
+            _candidate_bounds.resize(candidate_count);
+            _candidate_visibility.resize(candidate_count);
+            for (uint64 j = 0; j < candidate_count; j++)
+                _candidate_bounds.set(j, _world_bounds, _candidates[j]);
+            cascade->get_culling_volume().cull(
+                _candidate_bounds,
+                0,
+                candidate_count,
+                _candidate_visibility.data()
             );
+
+            uint64 visible_count = 0;
+            for (uint64 j = 0; j < candidate_count; j++)
+                if (_candidate_visibility[j])
+                    _candidates[visible_count++] = _candidates[j];
+            _candidates.resize(visible_count);
+        }
+        add_candidates(cascade);
     }
+}
+
+void RenderViewDirectionalShadow::add_candidates(
+    RenderViewDirectionalShadow* const cascade
+) const {
+    // Cascade is marked as prepared for the current frame
+    cascade->_last_frame = _last_frame;
+    cascade->_visible_render_data.clear();
+    for (const auto index : _candidates) {
+        const auto& entry = _cull_entries[index];
+        const auto  geom  = entry.geometry;
 
-    return _visible_render_data;
+        // Projection is orthographic, bounds diameter relative to cascade
+        // height doesn't depend on distance
+        const glm::vec3 half { _world_bounds.half_x[index],
+                               _world_bounds.half_y[index],
+                               _world_bounds.half_z[index] };
+        const float32   screen_size =
+            glm::length(half) * cascade->_proj_matrix[1][1];
+
+        cascade->_visible_render_data.push_back(
+            { geom,
+              geom->material,
+              _transforms.world(entry.mesh_index),
+              cascade->select_lod(geom, screen_size) }
+        );
+    }
 }
 
-} // namespace ENGINE_NAMESPACE
+} // namespace ENGINE_NAMESPACE
\ No newline at end of file
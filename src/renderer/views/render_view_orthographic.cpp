@@ -33,26 +33,16 @@ void RenderViewOrthographic::on_resize(
     _proj_inv_matrix = glm::inverse(_proj_matrix);
 }
 
-Vector<GeometryRenderData>& RenderViewOrthographic::get_visible_render_data(
-    const uint32 frame_number
-) {
-    // Only update once per frame
-    if (_last_frame == frame_number) return _visible_render_data;
-    _last_frame = frame_number;
-
-    // Clear geometry data
-    _visible_render_data.clear();
-
+void RenderViewOrthographic::compute_visible_render_data() {
     // Update render data
-    for (const auto& mesh : _potentially_visible_meshes) {
-        const auto model_matrix = mesh->transform.world();
+    for (uint64 i = 0; i < _potentially_visible_meshes.size(); i++) {
+        const auto  mesh         = _potentially_visible_meshes[i];
+        const auto& model_matrix = _transforms.world(i);
         for (auto* const geom : mesh->geometries())
             _visible_render_data.push_back(
                 { geom, geom->material, model_matrix }
             );
     }
-
-    return _visible_render_data;
 }
 
 } // namespace ENGINE_NAMESPACE
\ No newline at end of file
@@ -4,8 +4,26 @@
 #include "component/frustum.hpp"
 #include "resources/mesh.hpp"
 
+#include <algorithm> // max, partial_sort
+
 namespace ENGINE_NAMESPACE {
 
+namespace {
+// Minimal number of geometries tested for occlusion by a single job
+constexpr uint64  occlusion_grain          = 1024;
+// Occluders rasterized per frame, at most
+constexpr uint64  max_occluder_count       = 16;
+constexpr uint64  max_occluder_triangles   = 16384;
+// Smallest size on screen (squared ratio of bounds radius and distance) of
+// an occluder
+constexpr float32 min_occluder_screen_size = 0.01f;
+
+// TODO: Add something in material to check for transparency.
+bool is_transparent(const Geometry* const geometry) {
+    return geometry->material()->diffuse_map()->texture->has_transparency();
+}
+} // namespace
+
 // Constructor & Destructor
 RenderViewPerspective::RenderViewPerspective(const RenderView::Config& config)
     : RenderView(config) {
@@ -36,8 +54,9 @@ void RenderViewPerspective::on_resize(const uint32 width, const uint32 height) {
 
 Vector<GeometryRenderData>& RenderViewPerspective::get_all_render_data() {
     if (_all_render_data.size() == 0) {
-        for (const auto& mesh : _potentially_visible_meshes) {
-            const auto model_matrix = mesh->transform.world();
+        for (uint64 i = 0; i < _potentially_visible_meshes.size(); i++) {
+            const auto  mesh         = _potentially_visible_meshes[i];
+            const auto& model_matrix = _transforms.world(i);
             for (const auto& geo : mesh->geometries()) {
                 _all_render_data.push_back( //
                     { geo, geo->material, model_matrix }
@@ -48,23 +67,22 @@ Vector<GeometryRenderData>& RenderViewPerspective::get_all_render_data() {
     return _all_render_data;
 }
 
-Vector<GeometryRenderData>& RenderViewPerspective::get_visible_render_data(
-    const uint32 frame_number
-) {
-    // Only update once per frame
-    if (_last_frame == frame_number) return _visible_render_data;
-    _last_frame = frame_number;
-
-    // Clear geometry data
-    _visible_render_data.clear();
-
-    // Keep a list of transparent objects
-    typedef std::pair<float32, GeometryRenderData> TGeomData;
+Geometry* RenderViewPerspective::ray_cast(const Ray<3>& ray, float32& t) const {
+    uint32 index;
+    if (!_bvh.ray_cast(ray, index, t)) return nullptr;
+    return _cull_entries[index].geometry;
+}
 
-    // TODO: Performance :/
-    static Vector<TGeomData> transparent_geometries {};
-    transparent_geometries.clear();
+void RenderViewPerspective::query_box(
+    const BVH::BBox& bbox, Vector<Geometry*>& result
+) const {
+    Vector<uint32> indices {};
+    _bvh.query_box(bbox, indices);
+    for (const auto index : indices)
+        result.push_back(_cull_entries[index].geometry);
+}
 
+void RenderViewPerspective::compute_visible_render_data() {
     // Create frustum for culling
     const auto forward = _camera->forward();
     const auto right   = -_camera->left();
@@ -74,52 +92,118 @@ Vector<GeometryRenderData>& RenderViewPerspective::get_visible_render_data(
         (float32) _width / _height,    _fov,    _near_clip, _far_clip
     };
 
-    // Add all opaque geometries
-    for (const auto& mesh : _potentially_visible_meshes) {
-        const auto model_matrix = mesh->transform.world();
-        for (auto* const geom : mesh->geometries()) {
-            // Check if geometry is inside view frustum
-            const auto geom_3d = static_cast<Geometry3D*>(geom);
-            const auto aabb    = geom_3d->bbox.get_transformed(model_matrix);
-            if (!frustum.contains(aabb))
-                // We are skipping this geometry. It wont be rendered
-                continue;
-
-            // Create render data
-            const GeometryRenderData render_data { geom,
-                                                   geom->material,
-                                                   model_matrix };
-
-            // TODO: Add something in material to check for transparency.
-            if (geom->material()->diffuse_map()->texture->has_transparency() ==
-                false)
-                _visible_render_data.push_back(render_data);
-            else {
-                const auto geom3d   = dynamic_cast<Geometry3D*>(geom);
-                const auto center   = geom3d->bbox.get_center();
-                const auto distance = glm::distance(
-                    _camera->transform.position(),
-                    { model_matrix * glm::vec4(center, 1) }
-                );
-                transparent_geometries.push_back({ distance, render_data });
-            }
-        }
+    cull_geometries(frustum);
+    if (_occlusion_culling) cull_occluded_geometries();
+
+    // Refit query hierarchy to the new world bounds. Rebuilt when geometries
+    // were added or removed, or once refitting degraded it too much
+    _bvh.update(_world_bounds);
+
+    // Queue all visible geometries. Opaque ones are grouped by state, while
+    // transparent ones are drawn last, from the farthest
+    const auto position = _camera->transform.position();
+    _render_queue.clear(_far_clip);
+    for (uint64 i = 0; i < _cull_entries.size(); i++) {
+        // Geometries outside of view frustum wont be rendered
+        if (!_visibility[i]) continue;
+
+        // Distance to the center of world space bounds
+        const glm::vec3 center { _world_bounds.center_x[i],
+                                 _world_bounds.center_y[i],
+                                 _world_bounds.center_z[i] };
+        const glm::vec3 half { _world_bounds.half_x[i],
+                               _world_bounds.half_y[i],
+                               _world_bounds.half_z[i] };
+        const float32   distance = glm::distance(position, center);
+
+        // Bounds diameter relative to view height at that distance
+        const float32 screen_size =
+            glm::length(half) * _proj_matrix[1][1] / std::max(distance, 1e-6f);
+
+        // Create render data
+        const auto&              entry = _cull_entries[i];
+        const auto               geom  = entry.geometry;
+        const GeometryRenderData render_data {
+            geom,
+            geom->material,
+            _transforms.world(entry.mesh_index),
+            select_lod(geom, screen_size)
+        };
+        _render_queue.add(render_data, distance, is_transparent(geom));
     }
+    _render_queue.sort();
+    _render_queue.get_draws(_visible_render_data);
+}
 
-    // Sort transparent geometry list
-    Parallel::sort(
-        transparent_geometries.begin(),
-        transparent_geometries.end(),
-        [](const TGeomData& x, const TGeomData& y) -> bool {
-            return x.first > y.first;
-        }
+// /////////////////////////////////////// //
+// RENDER VIEW PERSPECTIVE PRIVATE METHODS //
+// /////////////////////////////////////// //
+
+void RenderViewPerspective::cull_occluded_geometries() {
+    const auto position = _camera->transform.position();
+
+    // Largest visible opaque geometries on screen occlude the others
+    _occluders.clear();
+    for (uint64 i = 0; i < _cull_entries.size(); i++) {
+        if (!_visibility[i]) continue;
+        const auto geometry =
+            static_cast<const Geometry3D*>(_cull_entries[i].geometry);
+        if (geometry->occluder_indices.empty() || is_transparent(geometry))
+            continue;
+
+        const glm::vec3 center { _world_bounds.center_x[i],
+                                 _world_bounds.center_y[i],
+                                 _world_bounds.center_z[i] };
+        const glm::vec3 half { _world_bounds.half_x[i],
+                               _world_bounds.half_y[i],
+                               _world_bounds.half_z[i] };
+        const auto      offset      = center - position;
+        const auto      screen_size = glm::dot(half, half) /
+                                 std::max(glm::dot(offset, offset), 1e-6f);
+        if (screen_size >= min_occluder_screen_size)
+            _occluders.push_back({ screen_size, (uint32) i });
+    }
+    const uint64 occluder_count =
+        std::min<uint64>(_occluders.size(), max_occluder_count);
+    std::partial_sort(
+        _occluders.begin(),
+        _occluders.begin() + occluder_count,
+        _occluders.end(),
+        [](const auto& a, const auto& b) { return a.first > b.first; }
     );
 
-    // Add all transparent geometries
-    for (const auto& t_geom : transparent_geometries)
-        _visible_render_data.push_back(t_geom.second);
-
-    return _visible_render_data;
+    // View matrix is computed here, as camera updates its own lazily
+    const auto view = glm::lookAt(
+        position, position + _camera->forward(), _camera->up()
+    );
+    _occlusion_buffer.begin(_proj_matrix * view);
+    uint64 triangle_count = 0;
+    for (uint64 i = 0; i < occluder_count; i++) {
+        const auto& entry    = _cull_entries[_occluders[i].second];
+        const auto  geometry = static_cast<const Geometry3D*>(entry.geometry);
+        const auto  triangles = geometry->occluder_indices.size() / 3;
+        if (triangle_count + triangles > max_occluder_triangles) continue;
+
+        triangle_count += triangles;
+        _occlusion_buffer.add_occluder(
+            geometry->occluder_vertices,
+            geometry->occluder_indices,
+            _transforms.world(entry.mesh_index)
+        );
+    }
+    if (_occlusion_buffer.triangle_count() == 0) return;
+    _occlusion_buffer.rasterize();
+
+    // Geometries still visible are tested against occluder depth
+    Parallel::for_loop(
+        { 0, _cull_entries.size() },
+        occlusion_grain,
+        [this](const Parallel::Range chunk) {
+            _occlusion_buffer.test(
+                _world_bounds, chunk.begin, chunk.end, _visibility.data()
+            );
+        }
+    );
 }
 
 } // namespace ENGINE_NAMESPACE
\ No newline at end of file
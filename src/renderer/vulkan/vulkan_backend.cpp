@@ -5,6 +5,8 @@
 
 #include "timer.hpp"
 
+#include <algorithm> // max, min
+
 namespace ENGINE_NAMESPACE {
 
 // Helper functions
@@ -79,6 +81,14 @@ VulkanBackend::~VulkanBackend() {
     del(_index_buffer);
     del(_vertex_buffer);
 
+    // Instance buffers
+    for (uint32 i = 0; i < VulkanSettings::max_frames_in_flight; i++) {
+        _instance_buffers[i]->unlock_memory();
+        del(_instance_buffers[i]);
+        for (auto buffer : _retired_instance_buffers[i])
+            del(buffer);
+    }
+
     // Render pass
     for (auto& pass : _registered_passes)
         destroy_render_pass(pass);
@@ -124,11 +134,8 @@ VulkanBackend::~VulkanBackend() {
 // VULKAN RENDERER PUBLIC METHODS //
 // ////////////////////////////// //
 
-Result<void, RuntimeError> VulkanBackend::begin_frame(const float32 delta_time
-) {
-    Timer& timer = Timer::global_timer;
-
-    // Wait for previous frame to finish drawing
+Result<uint32, RuntimeError> VulkanBackend::wait_for_frame() {
+    // Wait for previous use of this frame to finish drawing
     std::array<vk::Fence, 1> fences { _fences_in_flight[_current_frame] };
     try {
         auto result = _device->handle().waitForFences(fences, true, uint64_max);
@@ -139,6 +146,16 @@ Result<void, RuntimeError> VulkanBackend::begin_frame(const float32 delta_time
     } catch (const vk::SystemError& e) {
         Logger::fatal(RENDERER_VULKAN_LOG, e.what());
     }
+    return _current_frame;
+}
+
+Result<void, RuntimeError> VulkanBackend::begin_frame(const float32 delta_time
+) {
+    Timer& timer = Timer::global_timer;
+
+    // Wait for previous frame to finish drawing (No-op if already waited on)
+    auto wait_result = wait_for_frame();
+    if (wait_result.has_error()) return Failure(wait_result.error());
 
     timer.time("Previous frame finished in ");
 
@@ -150,6 +167,7 @@ Result<void, RuntimeError> VulkanBackend::begin_frame(const float32 delta_time
     timer.time("Next swapchain image computed in ");
 
     // Reset fence
+    std::array<vk::Fence, 1> fences { _fences_in_flight[_current_frame] };
     try {
         _device->handle().resetFences(fences);
     } catch (const vk::SystemError& e) {
@@ -165,6 +183,14 @@ Result<void, RuntimeError> VulkanBackend::begin_frame(const float32 delta_time
     begin_info.setPInheritanceInfo(nullptr);
 
     command_buffer->begin(begin_info);
+    _bound_vertex_buffer = nullptr;
+    _bound_index_buffer  = nullptr;
+
+    // Previous use of this frame's instance data is finished
+    for (auto buffer : _retired_instance_buffers[_current_frame])
+        del(buffer);
+    _retired_instance_buffers[_current_frame].clear();
+    _instance_buffer_offset = 0;
 
     // Set dynamic states
     viewport_reset();
@@ -474,32 +500,45 @@ void VulkanBackend::destroy_geometry(Geometry* const geometry) {
     _geometries.erase(geometry->internal_id.value());
 }
 
-void VulkanBackend::draw_geometry(Geometry* const geometry) {
+void VulkanBackend::draw_geometry(Geometry* const geometry, const uint8 lod) {
+    draw_geometry_instances(geometry, lod, 1);
+}
+
+void VulkanBackend::draw_geometry(
+    Geometry* const   geometry,
+    const uint8       lod,
+    const void* const instance_data,
+    const uint32      instance_size,
+    const uint32      instance_count
+) {
     // Check if geometry data is valid
     if (!geometry || !geometry->internal_id.has_value()) return;
+    if (instance_count == 0) return;
+
+    // Copy instance data into this frame's instance buffer. When full, the
+    // buffer is replaced by a larger one, kept alive until the frame is done
+    const vk::DeviceSize size = (vk::DeviceSize) instance_size * instance_count;
+    auto&                buffer = _instance_buffers[_current_frame];
+    if (_instance_buffer_offset + size > buffer->size()) {
+        const vk::DeviceSize new_size = std::max(2 * buffer->size(), size);
+        buffer->unlock_memory();
+        _retired_instance_buffers[_current_frame].push_back(buffer);
+        create_instance_buffer(_current_frame, new_size);
+        _instance_buffer_offset = 0;
+    }
+    std::memcpy(
+        _instance_buffer_data[_current_frame] + _instance_buffer_offset,
+        instance_data,
+        size
+    );
 
-    auto buffer_data    = _geometries[geometry->internal_id.value()];
-    auto command_buffer = _command_buffer->handle;
-
-    // Bind vertex buffer
-    std::array<vk::Buffer, 1>     vertex_buffers { _vertex_buffer->handle };
-    std::array<vk::DeviceSize, 1> offsets { buffer_data.vertex_offset };
-    command_buffer->bindVertexBuffers(0, vertex_buffers, offsets);
+    // Per instance attributes are read from binding 1
+    std::array<vk::Buffer, 1>     instance_buffers { buffer->handle };
+    std::array<vk::DeviceSize, 1> offsets { _instance_buffer_offset };
+    _command_buffer->handle->bindVertexBuffers(1, instance_buffers, offsets);
+    _instance_buffer_offset += size;
 
-    // Issue draw command
-    if (buffer_data.index_count > 0) {
-        // Bind index buffer
-        command_buffer->bindIndexBuffer(
-            _index_buffer->handle,
-            buffer_data.index_offset,
-            vk::IndexType::eUint32 // TODO: Might need to be configurable
-        );
-        // Draw command indexed
-        command_buffer->drawIndexed(buffer_data.index_count, 1, 0, 0, 0);
-    } else {
-        // Draw command non-indexed
-        command_buffer->draw(buffer_data.vertex_count, 1, 0, 0);
-    }
+    draw_geometry_instances(geometry, lod, instance_count);
 }
 
 // -----------------------------------------------------------------------------
@@ -769,12 +808,14 @@ void VulkanBackend::create_sync_objects() {
 void VulkanBackend::create_buffers() {
     // Create vertex buffer
     // TODO: NOT LIKE THIS, values choosen arbitrarily
+    // Buffers grow on demand, copying old content (hence eTransferSrc usage)
     vk::DeviceSize vertex_buffer_size = sizeof(Vertex3D) * 1024 * 1024;
     _vertex_buffer =
         new (MemoryTag::GPUBuffer) VulkanManagedBuffer(_device, _allocator);
     _vertex_buffer->create(
         vertex_buffer_size,
-        vk::BufferUsageFlagBits::eTransferDst |
+        vk::BufferUsageFlagBits::eTransferSrc |
+            vk::BufferUsageFlagBits::eTransferDst |
             vk::BufferUsageFlagBits::eVertexBuffer,
         vk::MemoryPropertyFlagBits::eDeviceLocal
     );
@@ -785,10 +826,32 @@ void VulkanBackend::create_buffers() {
         new (MemoryTag::GPUBuffer) VulkanManagedBuffer(_device, _allocator);
     _index_buffer->create(
         index_buffer_size,
-        vk::BufferUsageFlagBits::eTransferDst |
+        vk::BufferUsageFlagBits::eTransferSrc |
+            vk::BufferUsageFlagBits::eTransferDst |
             vk::BufferUsageFlagBits::eIndexBuffer,
         vk::MemoryPropertyFlagBits::eDeviceLocal
     );
+
+    // Create instance buffers, room for 16k model matrices per frame at first
+    vk::DeviceSize instance_buffer_size = sizeof(glm::mat4) * 16 * 1024;
+    for (uint32 i = 0; i < VulkanSettings::max_frames_in_flight; i++)
+        create_instance_buffer(i, instance_buffer_size);
+}
+
+void VulkanBackend::create_instance_buffer(
+    const uint32 frame, const vk::DeviceSize size
+) {
+    // Written by the host every frame, so kept host visible and mapped
+    _instance_buffers[frame] =
+        new (MemoryTag::GPUBuffer) VulkanBuffer(_device, _allocator);
+    _instance_buffers[frame]->create(
+        size,
+        vk::BufferUsageFlagBits::eVertexBuffer,
+        vk::MemoryPropertyFlagBits::eHostVisible |
+            vk::MemoryPropertyFlagBits::eHostCoherent
+    );
+    _instance_buffer_data[frame] =
+        (byte*) _instance_buffers[frame]->lock_memory(0, VK_WHOLE_SIZE);
 }
 
 void VulkanBackend::upload_data_to_buffer(
@@ -830,6 +893,57 @@ uint32 VulkanBackend::generate_geometry_id() {
     return id++;
 }
 
+void VulkanBackend::draw_geometry_instances(
+    Geometry* const geometry, const uint8 lod, const uint32 instance_count
+) {
+    // Check if geometry data is valid
+    if (!geometry || !geometry->internal_id.has_value()) return;
+
+    auto buffer_data    = _geometries[geometry->internal_id.value()];
+    auto command_buffer = _command_buffer->handle;
+
+    // Bind vertex buffer, unless an earlier draw already did
+    if (_bound_vertex_buffer != _vertex_buffer->handle() ||
+        _bound_vertex_offset != buffer_data.vertex_offset) {
+        std::array<vk::Buffer, 1>     vertex_buffers { _vertex_buffer->handle };
+        std::array<vk::DeviceSize, 1> offsets { buffer_data.vertex_offset };
+        command_buffer->bindVertexBuffers(0, vertex_buffers, offsets);
+        _bound_vertex_buffer = _vertex_buffer->handle;
+        _bound_vertex_offset = buffer_data.vertex_offset;
+    }
+
+    // Issue draw command
+    if (buffer_data.index_count > 0) {
+        // Bind index buffer, unless an earlier draw already did
+        if (_bound_index_buffer != _index_buffer->handle() ||
+            _bound_index_offset != buffer_data.index_offset) {
+            command_buffer->bindIndexBuffer(
+                _index_buffer->handle,
+                buffer_data.index_offset,
+                vk::IndexType::eUint32 // TODO: Might need to be configurable
+            );
+            _bound_index_buffer = _index_buffer->handle;
+            _bound_index_offset = buffer_data.index_offset;
+        }
+        // Draw command indexed, over the index range of the requested level
+        // of detail (or the coarsest one available)
+        uint32 first_index = 0;
+        uint32 index_count = buffer_data.index_count;
+        if (!geometry->lods.empty()) {
+            const uint32 last  = geometry->lods.size() - 1;
+            const auto&  range = geometry->lods[std::min<uint32>(lod, last)];
+            first_index        = range.first_index;
+            index_count        = range.index_count;
+        }
+        command_buffer->drawIndexed(
+            index_count, instance_count, first_index, 0, 0
+        );
+    } else {
+        // Draw command non-indexed
+        command_buffer->draw(buffer_data.vertex_count, instance_count, 0, 0);
+    }
+}
+
 void VulkanBackend::create_geometry_internal(
     Geometry* const   geometry,
     const uint32      vertex_size,
@@ -877,7 +991,8 @@ void VulkanBackend::create_geometry_internal(
 
     // Upload vertex data
     vk::DeviceSize buffer_size   = vertex_size * vertex_count;
-    vk::DeviceSize buffer_offset = _vertex_buffer->allocate(buffer_size);
+    vk::DeviceSize buffer_offset =
+        _vertex_buffer->allocate(_command_pool, buffer_size);
 
     internal_data->vertex_count  = vertex_count;
     internal_data->vertex_size   = vertex_size;
@@ -890,7 +1005,7 @@ void VulkanBackend::create_geometry_internal(
     // Upload index data
     if (index_count > 0) {
         buffer_size   = index_size * index_count;
-        buffer_offset = _index_buffer->allocate(buffer_size);
+        buffer_offset = _index_buffer->allocate(_command_pool, buffer_size);
 
         internal_data->index_count  = index_count;
         internal_data->index_size   = index_size;
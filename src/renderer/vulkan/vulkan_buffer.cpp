@@ -50,7 +50,7 @@ void VulkanBuffer::bind(const vk::DeviceSize offset) const {
 }
 
 void VulkanBuffer::resize(
-    const vk::CommandBuffer& command_buffer, const vk::DeviceSize new_size
+    const VulkanCommandPool* const command_pool, const vk::DeviceSize new_size
 ) {
     // Buffer can only increase in size
     if (new_size <= _size)
@@ -70,8 +70,11 @@ void VulkanBuffer::resize(
     // Bind allocated memory to buffer
     _device->handle().bindBufferMemory(new_handle, new_memory, 0);
 
-    // Copy all the data over
-    copy_data_to_buffer(command_buffer, new_handle, 0, 0, size);
+    // Copy all the data over. Single time commands wait for the queue to
+    // become idle, so the old buffer is no longer in use afterwards
+    auto command_buffer = command_pool->begin_single_time_commands();
+    copy_data_to_buffer(command_buffer, new_handle, 0, 0, _size);
+    command_pool->end_single_time_commands(command_buffer);
 
     // Destroy the old
     if (_handle) _device->handle().destroyBuffer(_handle, _allocator);
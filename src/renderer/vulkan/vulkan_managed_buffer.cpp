@@ -1,5 +1,7 @@
 #include "renderer/vulkan/vulkan_managed_buffer.hpp"
 
+#include <algorithm> // std::max
+
 namespace ENGINE_NAMESPACE {
 
 VulkanManagedBuffer::~VulkanManagedBuffer() { del(_memory_allocator); }
@@ -15,16 +17,17 @@ void VulkanManagedBuffer::create(
     const bool                    bind_on_create
 ) {
     VulkanBuffer::create(size, usage, properties, bind_on_create);
-    _memory_allocator = new (MemoryTag::GPUBuffer) GPUFreeListAllocator(
-        size, 0, GPUFreeListAllocator::PlacementPolicy::FindFirst
-    );
+    _memory_allocator =
+        new (MemoryTag::GPUBuffer) GPUFreeListAllocator(size, 0);
     _memory_allocator->init();
 }
 
 void VulkanManagedBuffer::resize(
-    const vk::CommandBuffer& command_buffer, const vk::DeviceSize new_size
+    const VulkanCommandPool* const command_pool, const vk::DeviceSize new_size
 ) {
-    Logger::fatal("ERROR :: UNIMPLEMENTED YET"); // TODO: Implement
+    VulkanBuffer::resize(command_pool, new_size);
+    // Offsets stay the same, so allocator only gains new free space at the end
+    _memory_allocator->resize(new_size);
 }
 
 void VulkanManagedBuffer::load_data(
@@ -45,6 +48,22 @@ vk::DeviceSize VulkanManagedBuffer::allocate(
 ) {
     return (vk::DeviceSize) _memory_allocator->allocate(size, alignment);
 }
+vk::DeviceSize VulkanManagedBuffer::allocate(
+    const VulkanCommandPool* const command_pool,
+    const uint64                   size,
+    const uint64                   alignment
+) {
+    uint64 offset;
+    if (_memory_allocator->try_allocate(size, alignment, offset))
+        return offset;
+
+    // Out of space. Free segment at the new end is at least twice the request
+    // size, which fits it even after alignment and size class rounding
+    const vk::DeviceSize buffer_size = this->size;
+    const vk::DeviceSize request     = 2 * (size + alignment);
+    resize(command_pool, std::max(2 * buffer_size, buffer_size + request));
+    return (vk::DeviceSize) _memory_allocator->allocate(size, alignment);
+}
 void VulkanManagedBuffer::deallocate(vk::DeviceSize offset) {
     _memory_allocator->free((void*) offset);
 }
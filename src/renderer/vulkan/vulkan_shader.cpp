@@ -138,10 +138,7 @@ VulkanShader::VulkanShader(
 
     // === Vertex input state info ===
     // Vertex bindings
-    Vector<vk::VertexInputBindingDescription> binding_descriptions(1);
-    binding_descriptions[0].setBinding(0);
-    binding_descriptions[0].setStride(_attribute_stride);
-    binding_descriptions[0].setInputRate(vk::VertexInputRate::eVertex);
+    auto binding_descriptions = compute_bindings();
 
     vk::PipelineVertexInputStateCreateInfo vertex_input_info {};
     vertex_input_info.setVertexBindingDescriptions(binding_descriptions);
@@ -292,10 +289,7 @@ void VulkanShader::reload() {
 
     // === Vertex input state info ===
     // Vertex bindings
-    Vector<vk::VertexInputBindingDescription> binding_descriptions(1);
-    binding_descriptions[0].setBinding(0);
-    binding_descriptions[0].setStride(_attribute_stride);
-    binding_descriptions[0].setInputRate(vk::VertexInputRate::eVertex);
+    auto binding_descriptions = compute_bindings();
 
     vk::PipelineVertexInputStateCreateInfo vertex_input_info {};
     vertex_input_info.setVertexBindingDescriptions(binding_descriptions);
@@ -336,10 +330,6 @@ void VulkanShader::apply_descriptor_set(DescriptorSet& set, uint32 state_id) {
         static Vector<vk::WriteDescriptorSet> descriptor_writes {};
         descriptor_writes.clear();
 
-        // Keep track of temporary allocated objects
-        Vector<std::pair<vk::DescriptorBufferInfo*, vk::DescriptorImageInfo*>>
-            allocated_infos {};
-
         // Iterate bindings
         for (auto& binding : set.bindings) {
             // descriptor_set_id is a hack for initializing all frames in flight
@@ -360,12 +350,10 @@ void VulkanShader::apply_descriptor_set(DescriptorSet& set, uint32 state_id) {
                 const auto& texture_maps =
                     state->texture_maps[binding.binding_index];
 
-                // Allocate temporary info for initialization
-                const auto image_infos = new (MemoryTag::Temp)
+                // Allocate temporary info for initialization. Released together
+                // with the rest of the frame memory
+                const auto image_infos = new (MemoryTag::Frame)
                     vk::DescriptorImageInfo[texture_maps.size()];
-
-                // Keep track of these objects
-                allocated_infos.push_back({ nullptr, image_infos });
                 binding_write.setPImageInfo(image_infos);
 
                 // Set all image infos
@@ -409,10 +397,7 @@ void VulkanShader::apply_descriptor_set(DescriptorSet& set, uint32 state_id) {
             } else /* Uniform or storage buffer */ {
                 // Allocate temporary info for initialization
                 const auto buffer_info =
-                    new (MemoryTag::Temp) vk::DescriptorBufferInfo {};
-
-                // Keep track of these objects
-                allocated_infos.push_back({ buffer_info, nullptr });
+                    new (MemoryTag::Frame) vk::DescriptorBufferInfo {};
                 binding_write.setPBufferInfo(buffer_info);
 
                 // Set values
@@ -433,12 +418,6 @@ void VulkanShader::apply_descriptor_set(DescriptorSet& set, uint32 state_id) {
         // Throws no exceptions
         if (descriptor_writes.size() > 0)
             _device->handle().updateDescriptorSets(descriptor_writes, nullptr);
-
-        // Free temporary memory
-        if (!allocated_infos.empty()) {
-            if (allocated_infos[0].first) del(allocated_infos[0].first);
-            if (allocated_infos[0].second) del(allocated_infos[0].second);
-        }
     }
 
     // Bind the global descriptor set to be updated.
@@ -717,23 +696,44 @@ Vector<vk::VertexInputAttributeDescription> VulkanShader::compute_attributes(
         types = t;
     }
 
-    // Process
+    // Process. Per vertex attributes are read from binding 0, per instance
+    // ones from binding 1
     Vector<vk::VertexInputAttributeDescription> attributes(_attributes.size());
-    uint32                                      offset = 0;
+    uint32                                      offsets[2] { 0, 0 };
     for (uint32 i = 0; i < _attributes.size(); ++i) {
+        const uint32 binding =
+            (_attributes[i].rate == AttributeRate::Instance) ? 1 : 0;
+
         // Setup the new attribute.
         attributes[i].setLocation(i);
-        attributes[i].setBinding(0);
-        attributes[i].setOffset(offset);
+        attributes[i].setBinding(binding);
+        attributes[i].setOffset(offsets[binding]);
         attributes[i].setFormat(types[(uint8) _attributes[i].type]);
 
         // Add to the stride.
-        offset += _attributes[i].size;
+        offsets[binding] += _attributes[i].size;
     }
 
     return attributes;
 }
 
+Vector<vk::VertexInputBindingDescription> VulkanShader::compute_bindings(
+) const {
+    Vector<vk::VertexInputBindingDescription> bindings(1);
+    bindings[0].setBinding(0);
+    bindings[0].setStride(_attribute_stride);
+    bindings[0].setInputRate(vk::VertexInputRate::eVertex);
+
+    // Instance buffer binding, only if there is something to read from it
+    if (_instance_attribute_stride > 0) {
+        bindings.resize(2);
+        bindings[1].setBinding(1);
+        bindings[1].setStride(_instance_attribute_stride);
+        bindings[1].setInputRate(vk::VertexInputRate::eInstance);
+    }
+    return bindings;
+}
+
 void VulkanShader::compute_uniforms(
     const Vector<vk::ShaderStageFlagBits>& shader_stages
 ) {
@@ -5,9 +5,15 @@
 #include "systems/geometry_system.hpp"
 #include "renderer/renderer_types.hpp"
 #include "serialization/binary_serializer.hpp"
+#include "component/mesh_simplifier.hpp"
+#include "multithreading/parallel.hpp"
 
 namespace ENGINE_NAMESPACE {
 
+// Version of the proprietary format. Files of other versions are imported
+// again from their source format, when available
+constexpr uint64 mesh_version = 0x2u;
+
 // Helper functions
 Result<void, RuntimeError> save_mesh(
     const String& name, const String& path, GeometryConfigArray* const configs
@@ -42,19 +48,32 @@ Result<Resource*, RuntimeError> MeshLoader::load(const String name) {
         ResourceSystem::base_path + "/" + _type_path + "/" + file_name;
 
     // Check files existence for all supported formats
+    std::optional<RuntimeError> error {};
     for (const auto& supported_mesh_file_type : _supported_mesh_file_types) {
         const auto full_path = file_path + supported_mesh_file_type.extension;
         if (FileSystem::exists(full_path)) {
-            // Format found. Load it or fail.
+            // Format found. Load it, or fall back to the next format found
             const auto result = supported_mesh_file_type.load(name, full_path);
+            if (result.has_error()) {
+                Logger::warning(
+                    RESOURCE_LOG,
+                    "Mesh file \"",
+                    full_path,
+                    "\" couldn't be loaded. ",
+                    result.error().what()
+                );
+                error = result.error();
+                continue;
+            }
 
-            Resource* const configs = check(result);
+            Resource* const configs = result.value();
             configs->full_path      = full_path;
             configs->loader_type    = ResourceType::Mesh;
 
             return configs;
         }
     }
+    if (error.has_value()) return Failure(error.value());
 
     // This mesh file doesn't exist
     return Failure(RuntimeError("Mesh file \"" + name + "\" not found."));
@@ -85,7 +104,7 @@ Result<void, RuntimeError> save_mesh(
     String           buffer {};
 
     // Push header to buffer
-    uint64 version = 0x1u;
+    uint64 version = mesh_version;
     buffer += serializer.serialize(
         version, name, (uint32) config_array->configs.size()
     );
@@ -127,6 +146,10 @@ Result<GeometryConfigArray*, RuntimeError> load_mesh(
     );
     if (read.has_error()) return Failure(read.error());
     buffer_pos += read.value();
+    if (version != mesh_version)
+        return Failure(RuntimeError(
+            String::build("Unsupported mesh file version (", version, ").")
+        ));
 
     // Output geometry configuration array
     auto config_array =
@@ -146,7 +169,8 @@ Result<GeometryConfigArray*, RuntimeError> load_mesh(
         // Read geometry
         switch (dim_count) {
         case 3: {
-            auto config = new (MemoryTag::Geometry) Geometry::Config3D();
+            // Config object stays in place, keep it out of the compacted heap
+            auto config = new (MemoryTag::Resource) Geometry::Config3D();
             read        = config->deserialize(&serializer, buffer, buffer_pos);
             config_array->configs.push_back(config);
         } break;
@@ -184,10 +208,25 @@ Result<GeometryConfigArray*, RuntimeError> load_mesh(
 
 namespace ENGINE_NAMESPACE {
 
+// Levels of detail aren't simplified further once below this triangle count
+constexpr uint64  min_lod_triangle_count = 128;
+// Error allowed at the first simplified level of detail, relative to mesh
+// size. Doubled at each next level
+constexpr float32 lod_max_error          = 0.0025f;
+
 // Local helper
-String               create_mat_file(const Material::Config& config);
-Result<uint32, bool> fuzzy_get_index(
-    Map<float32, std::pair<Vertex3D, uint32>>& vertex_map, Vertex3D& vertex
+String                 create_mat_file(const Material::Config& config);
+Result<uint32, bool>   fuzzy_get_index(
+      Map<float32, std::pair<Vertex3D, uint32>>& vertex_map, Vertex3D& vertex
+  );
+Vector<Vector<uint32>> generate_lods(
+    const Vector<Vertex3D>& vertices, const Vector<uint32>& indices
+);
+Geometry::Config3D*    load_shape(
+    const String&            name,
+    const tinyobj::shape_t&  shape,
+    const tinyobj::attrib_t& attributes,
+    const Vector<String>&    material_configs
 );
 
 Result<GeometryConfigArray*, RuntimeError> load_obj(
@@ -231,94 +270,19 @@ Result<GeometryConfigArray*, RuntimeError> load_obj(
 
     // Geometry configuration obj
     auto config_array = new (MemoryTag::Resource) GeometryConfigArray(name);
-    config_array->configs.reserve(shapes.size());
-
-    // Loop over shapes
-    Map<float32, std::pair<Vertex3D, uint32>> unique_vertices {};
-    for (const auto& shape : shapes) {
-        Vector<Vertex3D> vertices { { MemoryTag::Geometry } };
-        Vector<uint32>   indices { { MemoryTag::Geometry } };
-        glm::vec3        extent_min { Infinity32, Infinity32, Infinity32 };
-        glm::vec3        extent_max { -Infinity32, -Infinity32, -Infinity32 };
-
-        // Load vertices, indices and extent
-        unique_vertices.clear();
-        for (const auto& index : shape.mesh.indices) {
-            Vertex3D vertex {};
-
-            // Load position
-            const auto x    = attributes.vertices[3 * index.vertex_index + 0];
-            const auto y    = attributes.vertices[3 * index.vertex_index + 1];
-            const auto z    = attributes.vertices[3 * index.vertex_index + 2];
-            vertex.position = { x, y, z };
-
-            // Compute extent
-            if (x < extent_min.x) extent_min.x = x;
-            if (y < extent_min.y) extent_min.y = y;
-            if (z < extent_min.z) extent_min.z = z;
-            if (x > extent_max.x) extent_max.x = x;
-            if (y > extent_max.y) extent_max.y = y;
-            if (z > extent_max.z) extent_max.z = z;
-
-            // Load normal
-            vertex.normal = { attributes.normals[3 * index.normal_index + 0],
-                              attributes.normals[3 * index.normal_index + 1],
-                              attributes.normals[3 * index.normal_index + 2] };
-
-            // Load texture coordinate
-            vertex.texture_coord = {
-                attributes.texcoords[2 * index.texcoord_index + 0],
-                1.0f - attributes.texcoords[2 * index.texcoord_index + 1]
-            };
-
-            // Load colors
-            vertex.color = { attributes.colors[3 * index.vertex_index + 0],
-                             attributes.colors[3 * index.vertex_index + 1],
-                             attributes.colors[3 * index.vertex_index + 2],
-                             1 };
-
-            // Was vertex with this index already present?
-            const auto new_index_res = fuzzy_get_index(unique_vertices, vertex);
-            const auto new_index     = new_index_res.value_or(vertices.size());
-            if (new_index_res.has_value() == false) {
-                // Push to vertex list
-                unique_vertices[vertex.position.x] =
-                    std::pair(vertex, new_index);
-                vertices.push_back(vertex);
-            }
 
-            // Push this index to the list anyways
-            indices.push_back(new_index);
+    // Shapes are independent, so each one is imported (tangents and levels of
+    // detail included) by its own job. Configs keep the order of shapes
+    config_array->configs.resize(shapes.size());
+    Parallel::for_loop(
+        { 0, shapes.size() },
+        1,
+        [&](const Parallel::Range range) {
+            for (uint64 i = range.begin; i < range.end; i++)
+                config_array->configs[i] =
+                    load_shape(name, shapes[i], attributes, material_configs);
         }
-
-        // Compute tangents
-        GeometrySystem::generate_tangents(vertices, indices);
-
-        // Compute materials
-        // TODO: Support multiple materials per geometry
-        // Does that even ever happen?
-        const auto val_of_in = shape.mesh.material_ids.size();
-        if (val_of_in > 1)
-            Logger::trace(
-                "[!!!] :: Shape with multiple materials : ", val_of_in
-            );
-
-        const auto mat_id = shape.mesh.material_ids[0];
-        const auto material_name =
-            (mat_id >= 0) ? material_configs[mat_id] : "";
-
-        // Save as new geometry 3D of this object
-        Geometry::Config3D* config =
-            new (MemoryTag::Geometry) Geometry::Config3D(
-                name + "_" + shape.name,
-                vertices,
-                indices,
-                { extent_min, extent_max },
-                material_name, // TODO:
-                true
-            );
-        config_array->configs.push_back(config);
-    }
+    );
 
     // Save as proprietary format for future faster loading
     // Changes the path extension from .obj to .mesh
@@ -331,6 +295,94 @@ Result<GeometryConfigArray*, RuntimeError> load_obj(
     return config_array;
 }
 
+Geometry::Config3D* load_shape(
+    const String&            name,
+    const tinyobj::shape_t&  shape,
+    const tinyobj::attrib_t& attributes,
+    const Vector<String>&    material_configs
+) {
+    Vector<Vertex3D> vertices { { MemoryTag::Geometry } };
+    Vector<uint32>   indices { { MemoryTag::Geometry } };
+    glm::vec3        extent_min { Infinity32, Infinity32, Infinity32 };
+    glm::vec3        extent_max { -Infinity32, -Infinity32, -Infinity32 };
+
+    // Load vertices, indices and extent
+    Map<float32, std::pair<Vertex3D, uint32>> unique_vertices {};
+    for (const auto& index : shape.mesh.indices) {
+        Vertex3D vertex {};
+
+        // Load position
+        const auto x    = attributes.vertices[3 * index.vertex_index + 0];
+        const auto y    = attributes.vertices[3 * index.vertex_index + 1];
+        const auto z    = attributes.vertices[3 * index.vertex_index + 2];
+        vertex.position = { x, y, z };
+
+        // Compute extent
+        if (x < extent_min.x) extent_min.x = x;
+        if (y < extent_min.y) extent_min.y = y;
+        if (z < extent_min.z) extent_min.z = z;
+        if (x > extent_max.x) extent_max.x = x;
+        if (y > extent_max.y) extent_max.y = y;
+        if (z > extent_max.z) extent_max.z = z;
+
+        // Load normal
+        vertex.normal = { attributes.normals[3 * index.normal_index + 0],
+                          attributes.normals[3 * index.normal_index + 1],
+                          attributes.normals[3 * index.normal_index + 2] };
+
+        // Load texture coordinate
+        vertex.texture_coord = {
+            attributes.texcoords[2 * index.texcoord_index + 0],
+            1.0f - attributes.texcoords[2 * index.texcoord_index + 1]
+        };
+
+        // Load colors
+        vertex.color = { attributes.colors[3 * index.vertex_index + 0],
+                         attributes.colors[3 * index.vertex_index + 1],
+                         attributes.colors[3 * index.vertex_index + 2],
+                         1 };
+
+        // Was vertex with this index already present?
+        const auto new_index_res = fuzzy_get_index(unique_vertices, vertex);
+        const auto new_index     = new_index_res.value_or(vertices.size());
+        if (new_index_res.has_value() == false) {
+            // Push to vertex list
+            unique_vertices[vertex.position.x] = std::pair(vertex, new_index);
+            vertices.push_back(vertex);
+        }
+
+        // Push this index to the list anyways
+        indices.push_back(new_index);
+    }
+
+    // Compute tangents
+    GeometrySystem::generate_tangents(vertices, indices);
+
+    // Compute coarser levels of detail
+    const auto lods = generate_lods(vertices, indices);
+
+    // Compute materials
+    // TODO: Support multiple materials per geometry
+    // Does that even ever happen?
+    const auto val_of_in = shape.mesh.material_ids.size();
+    if (val_of_in > 1)
+        Logger::trace("[!!!] :: Shape with multiple materials : ", val_of_in);
+
+    const auto mat_id = shape.mesh.material_ids[0];
+    const auto material_name = (mat_id >= 0) ? material_configs[mat_id] : "";
+
+    // Save as new geometry 3D of this object
+    return new (MemoryTag::Resource) Geometry::Config3D(
+        name + "_" + shape.name,
+        vertices,
+        indices,
+        { extent_min, extent_max },
+        material_name, // TODO:
+        true,
+        lods
+    );
+}
+
 Result<uint32, bool> fuzzy_get_index(
     Map<float32, std::pair<Vertex3D, uint32>>& vertex_map, Vertex3D& vertex
 ) {
@@ -345,6 +397,36 @@ Result<uint32, bool> fuzzy_get_index(
     return Failure(0);
 }
 
+Vector<Vector<uint32>> generate_lods(
+    const Vector<Vertex3D>& vertices, const Vector<uint32>& indices
+) {
+    Vector<glm::vec3> positions {};
+    positions.reserve(vertices.size());
+    for (const auto& vertex : vertices)
+        positions.push_back(vertex.position);
+
+    // Each level has about half the triangles of the previous one
+    Vector<Vector<uint32>> lods {};
+    MeshSimplifier         simplifier { positions, indices };
+    float32                max_error = lod_max_error;
+    while (lods.size() + 1 < Geometry::max_lod_count) {
+        const uint64 index_count = simplifier.indices().size();
+        if (index_count / 3 < min_lod_triangle_count) break;
+
+        // Levels barely simpler than the previous one aren't worth it
+        simplifier.simplify(index_count / 2, max_error);
+        if (simplifier.indices().size() > index_count * 3 / 4) break;
+
+        Vector<uint32> lod {};
+        lod.insert(
+            lod.end(), simplifier.indices().begin(), simplifier.indices().end()
+        );
+        lods.push_back(lod);
+        max_error *= 2.0f;
+    }
+    return lods;
+}
+
 // TODO: REMOVE WHEN POSSIBLE
 #define MAT_PATH "materials"
 
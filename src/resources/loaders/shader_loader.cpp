@@ -149,6 +149,12 @@ Result<Resource*, RuntimeError> ShaderLoader::load(const String name) {
                 attribute.error().what(),
                 "\" passed."
             );
+            Err(2) Logger::warning(
+                RESOURCE_LOG,
+                "Invalid attribute rate \"",
+                attribute.error().what(),
+                "\" passed."
+            );
         }
         else { shader_attributes.push_back(attribute.value()); }
     }
@@ -373,6 +379,14 @@ Result<Shader::Attribute, RuntimeErrorCode> parse_attribute_config(
         attribute_config.size = sizeof(uint32);
     } else return Failure(RuntimeErrorCode(1, attribute_type));
 
+    // Parse rate (optional), attributes advance per vertex by default
+    String attribute_rate = attribute_settings.value("rate", "vertex");
+    if (attribute_rate.compare_ci("vertex") == 0)
+        attribute_config.rate = Shader::AttributeRate::Vertex;
+    else if (attribute_rate.compare_ci("instance") == 0)
+        attribute_config.rate = Shader::AttributeRate::Instance;
+    else return Failure(RuntimeErrorCode(2, attribute_rate));
+
     return attribute_config;
 }
 
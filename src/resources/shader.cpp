@@ -18,7 +18,9 @@ Shader::Shader(TextureSystem* const texture_system, const Config& config)
       _bound_instance_id(0) {
     // Process attributes
     for (const auto attribute : config.attributes) {
-        _attribute_stride += attribute.size;
+        if (attribute.rate == AttributeRate::Instance)
+            _instance_attribute_stride += attribute.size;
+        else _attribute_stride += attribute.size;
     }
     _attributes = config.attributes;
 
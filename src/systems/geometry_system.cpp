@@ -18,9 +18,20 @@ GeometrySystem::GeometrySystem(
         );
     create_default_geometries();
 
+    // Shed unused geometries under memory pressure. Geometry objects are
+    // resources, while their vertex & index data is kept under geometry tag
+    _eviction_callback_ids[0] = MemorySystem::add_eviction_callback(
+        MemoryTag::Resource, [this]() { return evict_geometry(); }
+    );
+    _eviction_callback_ids[1] = MemorySystem::add_eviction_callback(
+        MemoryTag::Geometry, [this]() { return evict_geometry(); }
+    );
+
     Logger::trace(GEOMETRY_SYS_LOG, "Geometry system created.");
 }
 GeometrySystem::~GeometrySystem() {
+    for (const auto id : _eviction_callback_ids)
+        MemorySystem::remove_eviction_callback(id);
     // for (auto geometry : _registered_geometries) {
     //     _renderer->destroy_geometry(geometry.second.handle);
     //     delete geometry.second.handle;
@@ -37,27 +48,26 @@ GeometrySystem::~GeometrySystem() {
 // GEOMETRY SYSTEM PUBLIC METHODS //
 // ////////////////////////////// //
 
-Geometry* GeometrySystem::acquire(const uint32 id) {
+Geometry* GeometrySystem::acquire(const uint64 id) {
     Logger::trace(GEOMETRY_SYS_LOG, "Geometry with id ", id, " requested.");
 
-    auto ref = _registered_geometries.find(id);
-    if (ref == _registered_geometries.end()) {
+    auto ref = _registered_geometries.get(GeometryHandle { id });
+    if (ref == nullptr) {
         Logger::error(
             GEOMETRY_SYS_LOG,
             "Invalid geometry requested. Default returned instead."
         );
         return _default_geometry;
     }
-    ref->second.reference_count++;
+    // Geometry is used again, so it can't be evicted
+    if (ref->reference_count == 0 && ref->auto_release)
+        _unused_geometries.erase(ref->unused_entry);
+    ref->reference_count++;
 
     Logger::trace(GEOMETRY_SYS_LOG, "Geometry with id ", id, " acquired");
-    return ref->second.handle;
+    return ref->handle;
 }
 
-inline uint32 generate_id() { // TODO: TEMP
-    static uint32 id = 0;
-    return id++;
-}
 Geometry* GeometrySystem::acquire(const Geometry::Config2D& config) {
     return acquire_internal(config);
 }
@@ -74,24 +84,34 @@ void GeometrySystem::release(Geometry* geometry) {
         return;
     }
 
-    auto& ref = _registered_geometries[geometry->id.value()];
-    if (ref.handle->id != geometry->id.value()) {
+    // Handle is stale if geometry was already destroyed
+    const auto     id = geometry->id.value();
+    GeometryHandle handle { id };
+    auto           ref = _registered_geometries.get(handle);
+    if (ref == nullptr) {
+        Logger::warning(
+            GEOMETRY_SYS_LOG,
+            "Cannot release geometry with id ",
+            id,
+            ". Geometry was already released."
+        );
+        return;
+    }
+    if (ref->handle != geometry) {
         Logger::fatal(
             GEOMETRY_SYS_LOG, "Geometry id mismatch. Check registration logic."
         );
         return;
     }
 
-    if (ref.reference_count > 0) ref.reference_count--;
+    // Unreferenced geometry is either cached already or managed manually
+    if (ref->reference_count == 0) return;
+    ref->reference_count--;
 
-    // Is the geometry still need, if not release it
-    auto id = geometry->id.value();
-    if (ref.auto_release && ref.reference_count < 1) {
-        _material_system->release(ref.handle->material()->name);
-        _renderer->destroy_geometry(ref.handle);
-        del(ref.handle);
-        _registered_geometries.erase(geometry->id.value());
-    }
+    // Is the geometry still needed, if not cache it until evicted
+    if (ref->auto_release && ref->reference_count == 0)
+        ref->unused_entry =
+            _unused_geometries.insert(_unused_geometries.end(), handle);
 
     Logger::trace(GEOMETRY_SYS_LOG, "Geometry with id ", id, " released.");
 }
@@ -275,9 +295,22 @@ Geometry* GeometrySystem::acquire_internal(const Geometry::Config<Dim>& config
     if constexpr (Dim == 2)
         geometry =
             new (MemoryTag::Resource) Geometry2D(config.name, config.bbox);
-    if constexpr (Dim == 3)
-        geometry =
+    if constexpr (Dim == 3) {
+        const auto geometry_3d =
             new (MemoryTag::Resource) Geometry3D(config.name, config.bbox);
+
+        // Small enough geometries can serve as occluders
+        if (config.indices.size() / 3 <=
+            Geometry3D::max_occluder_triangle_count) {
+            geometry_3d->occluder_vertices.reserve(config.vertices.size());
+            for (const auto& vertex : config.vertices)
+                geometry_3d->occluder_vertices.push_back(vertex.position);
+            geometry_3d->occluder_indices.assign(
+                config.indices.begin(), config.indices.end()
+            );
+        }
+        geometry = geometry_3d;
+    }
     if (geometry == nullptr)
         Logger::fatal(
             GEOMETRY_SYS_LOG,
@@ -286,8 +319,31 @@ Geometry* GeometrySystem::acquire_internal(const Geometry::Config<Dim>& config
             "]. Geometry acquisition failed."
         );
 
-    // Create on GPU
-    _renderer->create_geometry(geometry, config.vertices, config.indices);
+    // Create on GPU. Levels of detail share vertices, with their indices
+    // following each other in a single index buffer. Upload data is a stack
+    // based temp allocation, so it's sized up front and never grows
+    const uint64 level_count =
+        std::min<uint64>(config.lods.size(), Geometry::max_lod_count - 1);
+    uint64 index_count = config.indices.size();
+    for (uint64 i = 0; i < level_count; i++)
+        index_count += config.lods[i].size();
+
+    const Vector<Vertex<Dim>> vertices {
+        config.vertices.begin(), config.vertices.end(), { MemoryTag::Temp }
+    };
+    Vector<uint32> indices { { MemoryTag::Temp } };
+    indices.reserve(index_count);
+    indices.insert(indices.end(), config.indices.begin(), config.indices.end());
+    if (level_count > 0)
+        geometry->lods.push_back({ 0, (uint32) config.indices.size() });
+    for (uint64 i = 0; i < level_count; i++) {
+        const auto& lod = config.lods[i];
+        geometry->lods.push_back(
+            { (uint32) indices.size(), (uint32) lod.size() }
+        );
+        indices.insert(indices.end(), lod.begin(), lod.end());
+    }
+    _renderer->create_geometry(geometry, vertices, indices);
 
     // Acquire material
     if (config.material_name.length() != 0) {
@@ -296,19 +352,32 @@ Geometry* GeometrySystem::acquire_internal(const Geometry::Config<Dim>& config
             geometry->material = _material_system->default_material();
     } else geometry->material = _material_system->default_material();
 
-    // Generate unique id
-    auto id      = generate_id();
-    geometry->id = id;
-
-    // Register new slot
-    auto& ref           = _registered_geometries[id];
-    ref.handle          = geometry;
-    ref.auto_release    = config.auto_release;
-    ref.reference_count = 1;
+    // Register new slot, its handle serves as unique id
+    const auto handle =
+        _registered_geometries.insert({ geometry, 1, config.auto_release });
+    geometry->id = handle.packed();
 
     Logger::trace(GEOMETRY_SYS_LOG, "Geometry \"", config.name, "\" acquired.");
     return geometry;
 }
+
+bool GeometrySystem::evict_geometry() {
+    if (_unused_geometries.empty()) return false;
+
+    const auto handle   = _unused_geometries.front();
+    const auto geometry = _registered_geometries.get(handle)->handle;
+    Logger::trace(
+        GEOMETRY_SYS_LOG, "Geometry \"", geometry->name(), "\" evicted."
+    );
+
+    _unused_geometries.pop_front();
+    _registered_geometries.remove(handle);
+    _material_system->release(geometry->material());
+    _renderer->destroy_geometry(geometry);
+    del(geometry);
+    return true;
+}
+
 void GeometrySystem::create_default_geometries() {
     float f = 10.0f;
 
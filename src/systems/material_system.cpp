@@ -21,12 +21,20 @@ MaterialSystem::MaterialSystem(
             "Const _max_material_count must be greater than 0."
         );
 
+    // Shed unused materials under memory pressure
+    _eviction_callback_id = MemorySystem::add_eviction_callback(
+        MemoryTag::MaterialInstance, [this]() { return evict_material(); }
+    );
+
     Logger::trace(MATERIAL_SYS_LOG, "Material system created.");
 }
 MaterialSystem::~MaterialSystem() {
+    MemorySystem::remove_eviction_callback(_eviction_callback_id);
     for (auto& material : _registered_materials)
-        destroy_material(material.second.handle);
+        destroy_material(material.handle);
     _registered_materials.clear();
+    _material_lookup.clear();
+    _unused_materials.clear();
     if (_default_material) {
         _default_material->release_map_resources();
         _renderer->destroy_texture_map(_default_material->diffuse_map);
@@ -68,11 +76,11 @@ Material* MaterialSystem::acquire(const String name) {
     }
 
     const auto key = name.lower_c();
-    auto       ref = _registered_materials.find(key);
-    if (ref != _registered_materials.end()) {
-        ref->second.reference_count++;
+    auto       ref = find_material(key);
+    if (ref != nullptr) {
+        reference_material(ref);
         Logger::trace(MATERIAL_SYS_LOG, "Material acquired.");
-        return ref->second.handle;
+        return ref->handle;
     }
 
     // No material under this name found; load form resource system
@@ -91,16 +99,15 @@ Material* MaterialSystem::acquire(const String name) {
 
     // Check for errors
     if (material_result.has_error()) return default_material;
-    auto material_ref = material_result.value();
 
     // Register created material
-    _registered_materials[key] = material_ref;
+    const auto material = register_material(key, material_result.value());
 
     // Free config
     _resource_system->unload(material_config);
 
     Logger::trace(MATERIAL_SYS_LOG, "Material \"", name, "\" acquired.");
-    return material_ref.handle;
+    return material;
 }
 Material* MaterialSystem::acquire(const Material::Config& config) {
     Logger::trace(
@@ -129,27 +136,26 @@ Material* MaterialSystem::acquire(const Material::Config& config) {
     }
 
     // Get reference
-    auto ref = _registered_materials.find(name);
-    if (ref == _registered_materials.end()) {
+    auto ref = find_material(name);
+    if (ref == nullptr) {
         // Create material
         auto result = create_material(config);
 
         // Check for errors
         if (result.has_error()) return default_material;
-        auto material_ref = result.value();
 
         // Register created material
-        _registered_materials[name] = material_ref;
+        const auto material = register_material(name, result.value());
 
         Logger::trace(
             MATERIAL_SYS_LOG, "Material \"", config.name, "\" acquired."
         );
-        return material_ref.handle;
+        return material;
     }
-    ref->second.reference_count++;
+    reference_material(ref);
 
     Logger::trace(MATERIAL_SYS_LOG, "Material \"", config.name, "\" acquired.");
-    return ref->second.handle;
+    return ref->handle;
 }
 
 void MaterialSystem::release(const String name) {
@@ -158,23 +164,35 @@ void MaterialSystem::release(const String name) {
         return;
     }
 
-    const auto key = name.lower_c();
-    auto       ref = _registered_materials.find(key);
-
-    if (ref == _registered_materials.end() ||
-        ref->second.reference_count == 0) {
+    const auto handle = _material_lookup.find(name.lower_c());
+    if (handle == _material_lookup.end() ||
+        _registered_materials.get(handle->second)->reference_count == 0) {
         Logger::warning(
             MATERIAL_SYS_LOG, "Tried to release a non-existent material: ", name
         );
         return;
     }
-    ref->second.reference_count--;
+    release_material(handle->second);
+
+    Logger::trace(MATERIAL_SYS_LOG, "Material \"", name, "\" released.");
+}
+void MaterialSystem::release(const Material* const material) {
+    if (material == _default_material) {
+        Logger::warning(MATERIAL_SYS_LOG, "Cannot release default material.");
+        return;
+    }
 
-    // Release resource if it isn't needed
-    if (ref->second.reference_count == 0 && ref->second.auto_release == true) {
-        destroy_material(ref->second.handle);
-        _registered_materials.erase(key);
+    // Handle is stale if material was already destroyed
+    const MaterialHandle handle { material->id.value_or(0) };
+    const auto           ref = _registered_materials.get(handle);
+    if (ref == nullptr || ref->reference_count == 0) {
+        Logger::warning(
+            MATERIAL_SYS_LOG, "Tried to release a non-existent material."
+        );
+        return;
     }
+    const String name = material->name;
+    release_material(handle);
 
     Logger::trace(MATERIAL_SYS_LOG, "Material \"", name, "\" released.");
 }
@@ -305,13 +323,60 @@ MaterialSystem::create_material(const Material::Config& config) {
     // Material
     material_ref.handle          = material;
     // Other
-    material_ref.handle->id      = (uint64) material_ref.handle;
     material_ref.auto_release    = config.auto_release;
     material_ref.reference_count = 1;
 
     return material_ref;
 }
 
+MaterialSystem::MaterialRef* MaterialSystem::find_material(const String& key) {
+    const auto handle = _material_lookup.find(key);
+    if (handle == _material_lookup.end()) return nullptr;
+    return _registered_materials.get(handle->second);
+}
+
+Material* MaterialSystem::register_material(
+    const String& key, const MaterialRef& ref
+) {
+    const auto handle     = _registered_materials.insert(ref);
+    ref.handle->id        = handle.packed();
+    _material_lookup[key] = handle;
+    return ref.handle;
+}
+
+void MaterialSystem::release_material(const MaterialHandle handle) {
+    const auto ref = _registered_materials.get(handle);
+    ref->reference_count--;
+
+    // Cache resource until it needs to be evicted
+    if (ref->reference_count == 0 && ref->auto_release == true)
+        ref->unused_entry =
+            _unused_materials.insert(_unused_materials.end(), handle);
+}
+
+void MaterialSystem::reference_material(MaterialRef* const ref) {
+    // Material is used again, so it can't be evicted
+    if (ref->reference_count == 0 && ref->auto_release == true)
+        _unused_materials.erase(ref->unused_entry);
+    ref->reference_count++;
+}
+
+bool MaterialSystem::evict_material() {
+    if (_unused_materials.empty()) return false;
+
+    const auto handle   = _unused_materials.front();
+    const auto material = _registered_materials.get(handle)->handle;
+    Logger::trace(
+        MATERIAL_SYS_LOG, "Material \"", material->name(), "\" evicted."
+    );
+
+    _unused_materials.pop_front();
+    _material_lookup.erase(material->name().lower_c());
+    _registered_materials.remove(handle);
+    destroy_material(material);
+    return true;
+}
+
 void MaterialSystem::destroy_material(Material* material) {
     if (!material->internal_id.has_value())
         Logger::fatal(
@@ -324,18 +389,17 @@ void MaterialSystem::destroy_material(Material* material) {
     // Release Textures & Texture map resources
     if (material->diffuse_map()) {
         const Texture* diffuse_texture = material->diffuse_map()->texture;
-        if (diffuse_texture) _texture_system->release(diffuse_texture->name());
+        _texture_system->release(diffuse_texture);
         _renderer->destroy_texture_map(material->diffuse_map());
     }
     if (material->specular_map()) {
         const Texture* specular_texture = material->specular_map()->texture;
-        if (specular_texture)
-            _texture_system->release(specular_texture->name());
+        _texture_system->release(specular_texture);
         _renderer->destroy_texture_map(material->specular_map());
     }
     if (material->normal_map()) {
         const Texture* normal_texture = material->normal_map()->texture;
-        if (normal_texture) _texture_system->release(normal_texture->name());
+        _texture_system->release(normal_texture);
         _renderer->destroy_texture_map(material->normal_map());
     }
 
@@ -1,27 +1,72 @@
 #include "systems/memory/memory_allocators/allocator.hpp"
 
-#include <stdlib.h> /* malloc, free */
+#include "platform/platform.hpp"
+
+#include <algorithm> // min, max
+#include <stdlib.h>  /* malloc, free */
 
 namespace ENGINE_NAMESPACE {
 
 Allocator::~Allocator() {
-    free(_start_ptr);
+    if (_owns_memory) free(_start_ptr);
     _start_ptr = nullptr;
 }
 
 void Allocator::init() {
-    if (_start_ptr != nullptr) { free(_start_ptr); }
-    _start_ptr = malloc(_total_size);
+    if (_owns_memory) free(_start_ptr);
+    _start_ptr   = malloc(_total_size);
+    _owns_memory = true;
+    this->reset();
+}
+void Allocator::init_at(void* const memory, const uint64 reserved_size) {
+    if (_owns_memory) free(_start_ptr);
+    _owns_memory   = false;
+    _start_ptr     = memory;
+    _reserved_size = reserved_size;
     this->reset();
 }
+void Allocator::set_growth(const uint64 growth_step, const uint64 size_limit) {
+    _growth_step = growth_step;
+    _size_limit  = std::min(size_limit, _reserved_size);
+}
 void* Allocator::allocate(const uint64 size, const uint64 alignment) {
     return nullptr;
 }
 void Allocator::free(void* ptr) {}
 void Allocator::reset() {}
 bool Allocator::owns(void* ptr) {
-    return ptr >= _start_ptr &&
-           (uint64) ptr < (uint64) _start_ptr + _total_size;
+    // Whole reserved range is owned, even the part not yet grown into
+    const uint64 size = (_reserved_size != 0) ? _reserved_size : _total_size;
+    return ptr >= _start_ptr && (uint64) ptr < (uint64) _start_ptr + size;
+}
+uint64 Allocator::allocation_size(void* ptr) { return 0; }
+uint64 Allocator::largest_free_block() { return 0; }
+bool   Allocator::compact(Relocator& relocator, const uint64 max_bytes) {
+    return false;
+}
+bool Allocator::supports_compaction() { return false; }
+
+bool Allocator::grow(const uint64 min_size) {
+    if (_total_size + min_size > _size_limit) return false;
+    // Grow by whole pages
+    const uint64 page_size = Platform::VirtualMemory::page_size();
+    const uint64 new_size  = std::min(
+        _size_limit,
+        get_aligned(_total_size + std::max(min_size, _growth_step), page_size)
+    );
+
+    // Commit from the page containing current end (it may be partially used)
+    const uint64 commit_start = _total_size & ~(page_size - 1);
+    if (!Platform::VirtualMemory::commit(
+            (void*) ((uint64) _start_ptr + commit_start),
+            new_size - commit_start
+        ))
+        return false;
+
+    const uint64 old_size = _total_size;
+    _total_size           = new_size;
+    on_grow(old_size);
+    return true;
 }
 
 } // namespace ENGINE_NAMESPACE
\ No newline at end of file
@@ -0,0 +1,88 @@
+#include "systems/memory/memory_allocators/frame_allocator.hpp"
+
+#include "logger.hpp"
+
+#include <algorithm> // max
+
+namespace ENGINE_NAMESPACE {
+
+// Constructor & Destructor
+FrameAllocator::FrameAllocator(
+    const uint64 total_size, const uint32 frame_count
+)
+    : Allocator(total_size), _frame_count(frame_count),
+      _arena_size((total_size / std::max(frame_count, 1u)) & ~(uint64) 15) {
+    if (frame_count == 0 || frame_count > max_frame_count)
+        Logger::fatal(
+            ALLOCATOR_LOG,
+            "Frame allocator supports between 1 and ",
+            max_frame_count,
+            " frames."
+        );
+}
+
+// ////////////////////////////// //
+// FRAME ALLOCATOR PUBLIC METHODS //
+// ////////////////////////////// //
+
+void* FrameAllocator::allocate(const uint64 size, const uint64 alignment) {
+    const uint64 start = arena_start(_current_frame);
+
+    // Bump offset. Retried only if another thread allocated in the meantime
+    uint64 offset = _offset.load(std::memory_order_relaxed);
+    uint64 padding, next_offset;
+    do {
+        padding = 0;
+        if (alignment != 0 && (start + offset) % alignment != 0)
+            padding = calculate_padding(start + offset, alignment);
+
+        next_offset = offset + padding + size;
+        if (next_offset > _arena_size)
+            Logger::fatal(
+                ALLOCATOR_LOG, "Frame allocator out of memory error."
+            );
+    } while (!_offset.compare_exchange_weak(
+        offset, next_offset, std::memory_order_relaxed
+    ));
+
+    return (void*) (start + offset + padding);
+}
+
+void FrameAllocator::free(void* ptr) {
+    // Memory is released only with the whole arena
+    return;
+}
+
+void FrameAllocator::reset() {
+    for (auto& used : _arena_used)
+        used = 0;
+    _offset = 0;
+    _used   = 0;
+    _peak   = 0;
+}
+
+void FrameAllocator::begin_frame(const uint32 frame_index) {
+    // Remember how much the finished frame used
+    _arena_used[_current_frame] = _offset.load();
+    _peak                       = std::max(_peak, _arena_used[_current_frame]);
+
+    // Switch to the new arena, dropping its old content
+    _current_frame              = frame_index % _frame_count;
+    _arena_used[_current_frame] = 0;
+    _offset                     = 0;
+
+    uint64 used = 0;
+    for (uint32 i = 0; i < _frame_count; i++)
+        used += _arena_used[i];
+    _used.store(used, std::memory_order_relaxed);
+}
+
+// /////////////////////////////// //
+// FRAME ALLOCATOR PRIVATE METHODS //
+// /////////////////////////////// //
+
+uint64 FrameAllocator::arena_start(const uint32 frame_index) const {
+    return (uint64) _start_ptr + frame_index * _arena_size;
+}
+
+} // namespace ENGINE_NAMESPACE
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "logger.hpp"
 
 #include <algorithm> // std::max
+#include <cstring>   // memcpy, memmove
 
 namespace ENGINE_NAMESPACE {
 
@@ -12,6 +13,20 @@ FreeListAllocator::FreeListAllocator(
 )
     : Allocator(totalSize) {
     _placement_policy = pPolicy;
+
+    if (_placement_policy == SegregatedFit) {
+        if (totalSize >= ((uint64) 1 << fl_index_max))
+            Logger::fatal(
+                ALLOCATOR_LOG,
+                "Segregated fit free list allocator can manage at most ",
+                ((uint64) 1 << fl_index_max) - 1,
+                " bytes."
+            );
+        _segregated_lists = new SegregatedLists();
+    }
+}
+FreeListAllocator::~FreeListAllocator() {
+    if (_segregated_lists) delete _segregated_lists;
 }
 
 // ////////////////////////////////// //
@@ -21,6 +36,9 @@ FreeListAllocator::FreeListAllocator(
 #define FREE_LIST_ALLOCATION_SIZE_WAR 0
 
 void* FreeListAllocator::allocate(const uint64 size, const uint64 alignment) {
+    if (_placement_policy == SegregatedFit)
+        return allocate_segregated(size, alignment);
+
     if (size < sizeof(Node))
 #if FREE_LIST_ALLOCATION_SIZE_WAR == 1
         Logger::warning(
@@ -41,6 +59,11 @@ void* FreeListAllocator::allocate(const uint64 size, const uint64 alignment) {
     Node * affected_node, *previous_node;
     find(size, alignment, padding, previous_node, affected_node);
 
+    // Grow if no free block is large enough
+    while (affected_node == nullptr &&
+           grow(size + alignment + sizeof(AllocationHeader)))
+        find(size, alignment, padding, previous_node, affected_node);
+
     if (affected_node == nullptr)
         Logger::fatal(
             ALLOCATOR_LOG, "Free list allocator out of memory error."
@@ -68,13 +91,17 @@ void* FreeListAllocator::allocate(const uint64 size, const uint64 alignment) {
     ((AllocationHeader*) header_address)->padding    = alignment_padding;
 
     // Debug vars
-    _used += required_size;
-    _peak = std::max(_peak, _used);
+    increase_used(required_size);
 
     return (void*) data_address;
 }
 
 void FreeListAllocator::free(void* ptr) {
+    if (_placement_policy == SegregatedFit) {
+        free_segregated(ptr);
+        return;
+    }
+
     // Insert it in a sorted position by the address number
     const uint64 current_address = (uint64) ptr;
     const uint64 header_address  = current_address - sizeof(AllocationHeader);
@@ -87,22 +114,21 @@ void FreeListAllocator::free(void* ptr) {
     free_node->next            = nullptr;
 
     Node *it = _free_list.head, *it_prev = nullptr;
-    while (it != nullptr) {
-        if (ptr < it) {
-            _free_list.insert(it_prev, free_node);
-            break;
-        }
+    while (it != nullptr && it < free_node) {
         it_prev = it;
         it      = it->next;
     }
+    _free_list.insert(it_prev, free_node);
 
-    _used -= free_node->data.block_size;
+    decrease_used(free_node->data.block_size);
 
     // Merge contiguous nodes
     coalescence(it_prev, free_node);
 }
 
 void FreeListAllocator::reset() {
+    if (_placement_policy == SegregatedFit) return reset_segregated();
+
     _used                       = 0;
     _peak                       = 0;
     Node* first_node            = (Node*) _start_ptr;
@@ -112,10 +138,117 @@ void FreeListAllocator::reset() {
     _free_list.insert(nullptr, first_node);
 }
 
+uint64 FreeListAllocator::allocation_size(void* ptr) {
+    if (_placement_policy == SegregatedFit)
+        return ((Block*) ((uint64) ptr - block_header_size))->size() -
+               block_header_size;
+
+    const uint64 header_address = (uint64) ptr - sizeof(AllocationHeader);
+    const AllocationHeader* allocation_header =
+        (AllocationHeader*) header_address;
+    return allocation_header->block_size - allocation_header->padding -
+           sizeof(AllocationHeader);
+}
+
+uint64 FreeListAllocator::largest_free_block() {
+    uint64 largest = 0;
+    if (_placement_policy == SegregatedFit) {
+        // Largest block is in the highest non empty list
+        if (_segregated_lists->fl_bitmap == 0) return 0;
+        const uint32 fl = 31 - __builtin_clz(_segregated_lists->fl_bitmap);
+        const uint32 sl = 31 - __builtin_clz(_segregated_lists->sl_bitmap[fl]);
+        for (auto it = _segregated_lists->heads[fl][sl]; it != nullptr;
+             it      = it->next_free)
+            largest = std::max(largest, it->size());
+        return largest;
+    }
+
+    for (auto it = _free_list.head; it != nullptr; it = it->next)
+        largest = std::max(largest, it->data.block_size);
+    return largest;
+}
+
+void FreeListAllocator::set_growth(
+    const uint64 growth_step, const uint64 size_limit
+) {
+    Allocator::set_growth(growth_step, size_limit);
+    if (_placement_policy == SegregatedFit)
+        _size_limit =
+            std::min(_size_limit, ((uint64) 1 << fl_index_max) - 1);
+}
+
+bool FreeListAllocator::supports_compaction() {
+    return _placement_policy == SegregatedFit;
+}
+
+bool FreeListAllocator::compact(Relocator& relocator, const uint64 max_bytes) {
+    if (!supports_compaction()) return false;
+
+    uint64 moved   = 0;
+    uint32 scanned = 0;
+    Block* block   = (_compaction_cursor != nullptr) ? _compaction_cursor
+                                                     : (Block*) _start_ptr;
+    while (block != nullptr) {
+        if (moved >= max_bytes || scanned++ >= compaction_scan_limit) {
+            _compaction_cursor = block;
+            return true;
+        }
+
+        void* const ptr = (void*) ((uint64) block + block_header_size);
+        if (block->is_free() || !relocator.can_relocate(ptr)) {
+            block = next_physical(block);
+            continue;
+        }
+
+        // Move into any fitting free block at a lower address, otherwise slide
+        // into the free block right before. Either way, continue from the free
+        // block left behind
+        uint32 fl, sl;
+        Block* target = nullptr;
+        mapping_search(block->size(), fl, sl);
+        if (fl < fl_index_count) target = find_suitable(fl, sl);
+
+        const uint64 size = block->size();
+        const auto   gap  = block->prev_physical;
+        if (target != nullptr && target < block) {
+            block = move_block(target, block);
+        } else if (gap != nullptr && gap->is_free()) {
+            target = gap;
+            block  = slide(gap, block);
+        } else {
+            block = next_physical(block);
+            continue;
+        }
+        moved += size;
+        relocator.relocated(ptr, (void*) ((uint64) target + block_header_size));
+    }
+
+    // Pass is done, next one starts from the beginning
+    _compaction_cursor = nullptr;
+    return false;
+}
+
 // /////////////////////////////////// //
 // FREE LIST ALLOCATOR PRIVATE METHODS //
 // /////////////////////////////////// //
 
+void FreeListAllocator::on_grow(const uint64 old_size) {
+    if (_placement_policy == SegregatedFit) return grow_segregated(old_size);
+
+    // Gained memory is a new free block at the end of the list
+    Node* const new_node      = (Node*) ((uint64) _start_ptr + old_size);
+    new_node->data.block_size = _total_size - old_size;
+    new_node->next            = nullptr;
+
+    Node *it = _free_list.head, *it_prev = nullptr;
+    while (it != nullptr) {
+        it_prev = it;
+        it      = it->next;
+    }
+    _free_list.insert(it_prev, new_node);
+    coalescence(it_prev, new_node);
+}
+
 void FreeListAllocator::find(
     const uint64 size,
     const uint64 alignment,
@@ -130,6 +263,11 @@ void FreeListAllocator::find(
     case FindBest:
         find_best(size, alignment, padding, previous_node, found_node);
         break;
+    case SegregatedFit:
+        // Allocates through segregated lists, never searches the free list
+        Logger::fatal(
+            ALLOCATOR_LOG, "Free list search used with segregated fit policy."
+        );
     }
 }
 
@@ -165,7 +303,9 @@ void FreeListAllocator::find_best(
 ) {
     // Iterate WHOLE list keeping a pointer to the best fit
     uint64 smallest_diff = uint64_max;
+    uint64 best_padding  = 0;
     Node*  best_block    = nullptr;
+    Node*  best_previous = nullptr;
 
     Node *it = _free_list.head, *it_prev = nullptr;
     while (it != nullptr) {
@@ -175,12 +315,16 @@ void FreeListAllocator::find_best(
         const uint64 required_space = size + padding;
         if (it->data.block_size >= required_space &&
             (it->data.block_size - required_space < smallest_diff)) {
-            best_block = it;
+            smallest_diff = it->data.block_size - required_space;
+            best_padding  = padding;
+            best_block    = it;
+            best_previous = it_prev;
         }
         it_prev = it;
         it      = it->next;
     }
-    previous_node = it_prev;
+    padding       = best_padding;
+    previous_node = best_previous;
     found_node    = best_block;
 }
 
@@ -200,4 +344,286 @@ void FreeListAllocator::coalescence(Node* previous_node, Node* free_node) {
     }
 }
 
+// -----------------------------------------------------------------------------
+// Segregated fit
+// -----------------------------------------------------------------------------
+
+void* FreeListAllocator::allocate_segregated(
+    const uint64 size, const uint64 alignment
+) {
+    // Compute block size
+    const uint64 payload_size = get_aligned(
+        std::max(size, min_block_size - block_header_size), block_alignment
+    );
+    const uint64 block_size = payload_size + block_header_size;
+
+    // Larger alignments may require a free gap in front of the payload, which
+    // must itself be able to hold a free block
+    const bool   over_aligned = alignment > block_alignment;
+    const uint64 search_size =
+        (over_aligned) ? block_size + alignment + min_block_size : block_size;
+
+    // Find free block, growing until one is found or the limit is reached
+    uint32 fl, sl;
+    Block* block = nullptr;
+    do {
+        mapping_search(search_size, fl, sl);
+        block = (fl < fl_index_count) ? find_suitable(fl, sl) : nullptr;
+    } while (block == nullptr && grow(search_size));
+    if (block == nullptr)
+        Logger::fatal(
+            ALLOCATOR_LOG, "Free list allocator out of memory error."
+        );
+    remove_free_block(block);
+
+    // Split off alignment gap
+    if (over_aligned) {
+        const uint64 payload = (uint64) block + block_header_size;
+        uint64       aligned = get_aligned(payload, alignment);
+        if (aligned != payload && aligned - payload < min_block_size)
+            aligned = get_aligned(payload + min_block_size, alignment);
+
+        if (aligned != payload) {
+            const auto gap = block;
+            block          = split(gap, aligned - payload);
+            insert_free_block(gap);
+        }
+    }
+
+    // Split off remainder
+    if (block->size() >= block_size + min_block_size)
+        insert_free_block(split(block, block_size));
+    block->size_and_flags &= ~Block::free_flag;
+
+    // Debug vars
+    increase_used(block->size());
+
+    return (void*) ((uint64) block + block_header_size);
+}
+
+FreeListAllocator::Block* FreeListAllocator::free_segregated(void* ptr) {
+    Block* block = (Block*) ((uint64) ptr - block_header_size);
+    decrease_used(block->size());
+    block->size_and_flags |= Block::free_flag;
+
+    // Merge with physical neighbours
+    const auto previous = block->prev_physical;
+    if (previous != nullptr && previous->is_free()) {
+        remove_free_block(previous);
+        block = merge(previous, block);
+    }
+    const auto next = next_physical(block);
+    if (next != nullptr && next->is_free()) {
+        remove_free_block(next);
+        block = merge(block, next);
+    }
+
+    insert_free_block(block);
+    return block;
+}
+
+void FreeListAllocator::reset_segregated() {
+    _used              = 0;
+    _peak              = 0;
+    _compaction_cursor = nullptr;
+    *_segregated_lists = {};
+
+    // Whole memory is one free block
+    Block* const block    = (Block*) _start_ptr;
+    block->prev_physical  = nullptr;
+    block->size_and_flags = (_total_size & ~(block_alignment - 1)) |
+                            Block::free_flag;
+    _last_block = block;
+    insert_free_block(block);
+}
+
+void FreeListAllocator::grow_segregated(const uint64 old_size) {
+    // Gained memory is a new free block after the physically last one
+    const uint64 old_end =
+        (uint64) _start_ptr + (old_size & ~(block_alignment - 1));
+    const uint64 new_end =
+        (uint64) _start_ptr + (_total_size & ~(block_alignment - 1));
+
+    Block* block          = (Block*) old_end;
+    block->prev_physical  = _last_block;
+    block->size_and_flags = (new_end - old_end) | Block::free_flag;
+    _last_block           = block;
+
+    const auto previous = block->prev_physical;
+    if (previous != nullptr && previous->is_free()) {
+        remove_free_block(previous);
+        block = merge(previous, block);
+    }
+    insert_free_block(block);
+}
+
+void FreeListAllocator::mapping_insert(
+    const uint64 size, uint32& fl, uint32& sl
+) const {
+    if (size < small_block_size) {
+        fl = 0;
+        sl = size / (small_block_size / sl_index_count);
+        return;
+    }
+    const uint32 msb = 63 - __builtin_clzll(size);
+    sl = (size >> (msb - sl_index_log2)) ^ sl_index_count;
+    fl = msb - fl_index_shift + 1;
+}
+
+void FreeListAllocator::mapping_search(
+    const uint64 size, uint32& fl, uint32& sl
+) const {
+    // Round up to the next sub-class, so that any block found there fits
+    uint64 rounded_size = size;
+    if (size >= small_block_size) {
+        const uint32 msb = 63 - __builtin_clzll(size);
+        rounded_size += ((uint64) 1 << (msb - sl_index_log2)) - 1;
+    }
+    mapping_insert(rounded_size, fl, sl);
+}
+
+FreeListAllocator::Block* FreeListAllocator::find_suitable(
+    uint32& fl, uint32& sl
+) const {
+    // Search given first level list for a large enough second level list
+    uint32 sl_map = _segregated_lists->sl_bitmap[fl] & (~0U << sl);
+    if (sl_map == 0) {
+        // Search for any larger first level list
+        const uint32 fl_map =
+            (fl + 1 < 32) ? _segregated_lists->fl_bitmap & (~0U << (fl + 1))
+                          : 0;
+        if (fl_map == 0) return nullptr;
+
+        fl     = __builtin_ctz(fl_map);
+        sl_map = _segregated_lists->sl_bitmap[fl];
+    }
+    sl = __builtin_ctz(sl_map);
+    return _segregated_lists->heads[fl][sl];
+}
+
+void FreeListAllocator::insert_free_block(Block* const block) {
+    uint32 fl, sl;
+    mapping_insert(block->size(), fl, sl);
+
+    auto& head       = _segregated_lists->heads[fl][sl];
+    block->next_free = head;
+    block->prev_free = nullptr;
+    if (head != nullptr) head->prev_free = block;
+    head = block;
+
+    _segregated_lists->fl_bitmap |= 1U << fl;
+    _segregated_lists->sl_bitmap[fl] |= 1U << sl;
+}
+
+void FreeListAllocator::remove_free_block(Block* const block) {
+    uint32 fl, sl;
+    mapping_insert(block->size(), fl, sl);
+
+    if (block->next_free != nullptr)
+        block->next_free->prev_free = block->prev_free;
+    if (block->prev_free != nullptr)
+        block->prev_free->next_free = block->next_free;
+    else {
+        // Block was the head of its list
+        auto& head = _segregated_lists->heads[fl][sl];
+        head       = block->next_free;
+        if (head == nullptr) {
+            _segregated_lists->sl_bitmap[fl] &= ~(1U << sl);
+            if (_segregated_lists->sl_bitmap[fl] == 0)
+                _segregated_lists->fl_bitmap &= ~(1U << fl);
+        }
+    }
+}
+
+FreeListAllocator::Block* FreeListAllocator::next_physical(
+    const Block* const block
+) const {
+    const uint64 next_address = (uint64) block + block->size();
+    const uint64 end_address =
+        (uint64) _start_ptr + (_total_size & ~(block_alignment - 1));
+    if (next_address >= end_address) return nullptr;
+    return (Block*) next_address;
+}
+
+FreeListAllocator::Block* FreeListAllocator::split(
+    Block* const block, const uint64 size
+) {
+    // Right part keeps the flags of the original block
+    Block* const remainder = (Block*) ((uint64) block + size);
+    remainder->prev_physical  = block;
+    remainder->size_and_flags = block->size_and_flags - size;
+
+    const auto next = next_physical(remainder);
+    if (next != nullptr) next->prev_physical = remainder;
+
+    block->size_and_flags =
+        size | (block->size_and_flags & Block::free_flag);
+    if (block == _last_block) _last_block = remainder;
+    return remainder;
+}
+
+FreeListAllocator::Block* FreeListAllocator::merge(
+    Block* const left, Block* const right
+) {
+    left->size_and_flags += right->size();
+    if (right == _last_block) _last_block = left;
+    if (right == _compaction_cursor) _compaction_cursor = left;
+
+    const auto next = next_physical(left);
+    if (next != nullptr) next->prev_physical = left;
+    return left;
+}
+
+FreeListAllocator::Block* FreeListAllocator::slide(
+    Block* const gap, Block* const block
+) {
+    const uint64 gap_size   = gap->size();
+    const uint64 block_size = block->size();
+    const auto   next       = next_physical(block);
+    remove_free_block(gap);
+
+    // Move content first, as new headers overwrite its old location
+    std::memmove(
+        (void*) ((uint64) gap + block_header_size),
+        (void*) ((uint64) block + block_header_size),
+        block_size - block_header_size
+    );
+
+    // Allocated block now starts where the gap did, followed by the gap
+    Block* const moved    = gap;
+    moved->size_and_flags = block_size;
+
+    Block* free_block          = (Block*) ((uint64) moved + block_size);
+    free_block->prev_physical  = moved;
+    free_block->size_and_flags = gap_size | Block::free_flag;
+    if (next != nullptr) next->prev_physical = free_block;
+    if (block == _last_block) _last_block = free_block;
+
+    if (next != nullptr && next->is_free()) {
+        remove_free_block(next);
+        free_block = merge(free_block, next);
+    }
+    insert_free_block(free_block);
+    return free_block;
+}
+
+FreeListAllocator::Block* FreeListAllocator::move_block(
+    Block* const target, Block* const block
+) {
+    const uint64 block_size = block->size();
+    remove_free_block(target);
+    if (target->size() >= block_size + min_block_size)
+        insert_free_block(split(target, block_size));
+    target->size_and_flags &= ~Block::free_flag;
+
+    std::memcpy(
+        (void*) ((uint64) target + block_header_size),
+        (void*) ((uint64) block + block_header_size),
+        block_size - block_header_size
+    );
+    increase_used(target->size());
+
+    return free_segregated((void*) ((uint64) block + block_header_size));
+}
+
 } // namespace ENGINE_NAMESPACE
\ No newline at end of file
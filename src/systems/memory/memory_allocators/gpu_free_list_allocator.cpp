@@ -3,206 +3,437 @@
 #include "logger.hpp"
 
 #include <algorithm> // std::max
+#include <string.h>  // memcpy
 
 namespace ENGINE_NAMESPACE {
 
 // Constructor & Destructor
 GPUFreeListAllocator::GPUFreeListAllocator(
-    const uint64          totalSize,
-    const uint64          begin_offset,
-    const PlacementPolicy pPolicy
+    const uint64 totalSize, const uint64 begin_offset
 )
     : Allocator(totalSize) {
-    _placement_policy = pPolicy;
-    _start_ptr        = (void*) begin_offset;
+    _start_ptr = (void*) begin_offset;
+}
+GPUFreeListAllocator::~GPUFreeListAllocator() {
+    if (_blocks) delete[] _blocks;
+    if (_allocations) delete[] _allocations;
 }
 
-// ////////////////////////////////// //
-// FREE LIST ALLOCATOR PUBLIC METHODS //
-// ////////////////////////////////// //
+// ////////////////////////////////////// //
+// GPU FREE LIST ALLOCATOR PUBLIC METHODS //
+// ////////////////////////////////////// //
 
-void GPUFreeListAllocator::init() { this->reset(); }
+void GPUFreeListAllocator::init() {
+    if (_blocks == nullptr) {
+        _blocks         = new Block[initial_capacity];
+        _block_capacity = initial_capacity;
+    }
+    if (_allocations == nullptr) rehash_allocations(2 * initial_capacity);
+    this->reset();
+}
 
 void* GPUFreeListAllocator::allocate(
     const uint64 size, const uint64 alignment
 ) {
-#ifdef WARN_FREE_LIST_SIZE_FOR_GPU
-    if (size < sizeof(Node))
-        Logger::warning(
-            ALLOCATOR_LOG,
-            "Free list allocation size should be bigger then or equal to ",
-            sizeof(Node),
-            ", which is sizeof(Node)."
-        );
-#endif // DEBUG
-    if (alignment < 4)
+    uint64 offset;
+    if (!try_allocate(size, alignment, offset))
         Logger::fatal(
-            ALLOCATOR_LOG, "Free list allocation alignment must be at least 4."
+            ALLOCATOR_LOG, "GPU free list allocator out of memory error."
         );
+    return (void*) offset;
+}
 
-    // Search through the free list for a free block that has enough space to
-    // allocate our data
-    uint64 padding;
-    Node   previous_node, affected_node;
-    find(size, alignment, padding, previous_node, affected_node);
+bool GPUFreeListAllocator::try_allocate(
+    const uint64 size, const uint64 alignment, uint64& offset
+) {
+    // Compute block size
+    const uint64 block_size =
+        get_aligned(std::max(size, (uint64) 1), block_alignment);
 
-    if (affected_node == _free_list.end())
-        Logger::fatal(
-            ALLOCATOR_LOG, "Free list allocator out of memory error."
-        );
+    // Larger alignments may require a free gap in front of the segment. Since
+    // headers aren't stored in the buffer, gap of any size is a valid block
+    const bool   over_aligned = alignment > block_alignment;
+    const uint64 search_size =
+        (over_aligned) ? block_size + alignment - block_alignment : block_size;
 
-    const uint64 offset        = affected_node->offset;
-    const uint64 required_size = size + padding;
-    const uint64 rest          = affected_node->block_size - required_size;
-
-    if (rest > 0) {
-        // We have to split the block into the data block and a free block of
-        // size 'rest'
-        FreeHeader new_free_node {};
-        new_free_node.block_size = rest;
-        new_free_node.offset     = affected_node->offset + required_size;
-        _free_list.insert_after(affected_node, new_free_node);
+    // Find free block
+    uint32 fl, sl;
+    mapping_search(search_size, fl, sl);
+    uint32 block = (fl < fl_index_count) ? find_suitable(fl, sl)
+                                         : invalid_index;
+    if (block == invalid_index) return false;
+    remove_free_block(block);
+
+    // Split off alignment gap
+    if (over_aligned) {
+        const uint64 start   = _blocks[block].offset;
+        const uint64 aligned = get_aligned(start, alignment);
+        if (aligned != start) {
+            const auto gap = block;
+            block          = split(gap, aligned - start);
+            insert_free_block(gap);
+        }
     }
-    _free_list.erase_after(previous_node);
 
-    // Setup data block
-    const uint64 data_address = offset + padding;
-    _allocated[data_address]  = { required_size, (uint8) padding };
+    // Split off remainder
+    if (_blocks[block].size > block_size)
+        insert_free_block(split(block, block_size));
+    _blocks[block].is_free = false;
+
+    offset = _blocks[block].offset;
+    insert_allocation(offset, block);
 
     // Debug vars
-    _used += required_size;
-    _peak = std::max(_peak, _used);
+    increase_used(_blocks[block].size);
 
-    return (void*) data_address;
+    return true;
 }
 
 void GPUFreeListAllocator::free(void* ptr) {
-    const uint64           offset            = (uint64) ptr;
-    const AllocationHeader allocation_header = _allocated[offset];
-    _allocated.erase(offset);
-
-    FreeHeader free_node {};
-    free_node.block_size = allocation_header.block_size;
-    free_node.offset     = offset - allocation_header.padding;
-
-    auto prev = _free_list.before_begin();
-    for (auto curr = _free_list.begin(); curr != _free_list.end(); curr++) {
-        if (offset < curr->offset) break;
-        prev = curr;
-    }
-    _free_list.insert_after(prev, free_node);
+    const uint64 offset = (uint64) ptr;
+    uint32       block  = find_allocation(offset);
+    if (block == invalid_index)
+        Logger::fatal(
+            ALLOCATOR_LOG,
+            "GPU free list allocator can't free unallocated offset ",
+            offset,
+            "."
+        );
+    remove_allocation(offset);
 
-    _used -= free_node.block_size;
+    decrease_used(_blocks[block].size);
+    _blocks[block].is_free = true;
+
+    // Merge with physical neighbours
+    const auto previous = _blocks[block].prev_physical;
+    if (previous != invalid_index && _blocks[previous].is_free) {
+        remove_free_block(previous);
+        block = merge(previous, block);
+    }
+    const auto next = _blocks[block].next_physical;
+    if (next != invalid_index && _blocks[next].is_free) {
+        remove_free_block(next);
+        block = merge(block, next);
+    }
 
-    // Merge contiguous nodes
-    coalescence(prev, std::next(prev));
+    insert_free_block(block);
 }
 
 void GPUFreeListAllocator::reset() {
     _used = 0;
     _peak = 0;
-    _free_list.clear();
-    _allocated.clear();
-    FreeHeader free_node {};
-    free_node.block_size = _total_size;
-    free_node.offset     = (uint64) _start_ptr;
-    _free_list.emplace_front(free_node);
+
+    // Clear segregated lists
+    _fl_bitmap = 0;
+    for (uint32 fl = 0; fl < fl_index_count; fl++) {
+        _sl_bitmap[fl] = 0;
+        for (uint32 sl = 0; sl < sl_index_count; sl++)
+            _heads[fl][sl] = invalid_index;
+    }
+
+    // All blocks become unused
+    for (uint32 i = 0; i < _block_capacity; i++)
+        _blocks[i].next_free = i + 1;
+    _blocks[_block_capacity - 1].next_free = invalid_index;
+    _unused_head                           = 0;
+    _last_block                            = invalid_index;
+
+    // Clear allocations
+    for (uint32 i = 0; i <= _allocation_mask; i++)
+        _allocations[i].block = invalid_index;
+    _allocation_count = 0;
+
+    // Whole memory is one free block
+    const uint64 size = _total_size & ~(block_alignment - 1);
+    if (size == 0) return;
+    _last_block = create_block((uint64) _start_ptr, size, invalid_index);
+    insert_free_block(_last_block);
+}
+
+uint64 GPUFreeListAllocator::allocation_size(void* ptr) {
+    const uint32 block = find_allocation((uint64) ptr);
+    return (block != invalid_index) ? _blocks[block].size : 0;
+}
+
+uint64 GPUFreeListAllocator::largest_free_block() {
+    // Largest block is in the highest non-empty list
+    if (_fl_bitmap == 0) return 0;
+    const uint32 fl = 63 - __builtin_clzll(_fl_bitmap);
+    const uint32 sl = 31 - __builtin_clz(_sl_bitmap[fl]);
+
+    uint64 largest = 0;
+    for (auto it = _heads[fl][sl]; it != invalid_index;
+         it      = _blocks[it].next_free)
+        largest = std::max(largest, _blocks[it].size);
+    return largest;
+}
+
+void GPUFreeListAllocator::resize(const uint64 new_size) {
+    if (new_size <= _total_size)
+        Logger::fatal(
+            ALLOCATOR_LOG,
+            "GPU free list allocator can only be resized to a larger size."
+        );
+
+    // Gained memory is a new free block after the physically last one
+    const uint64 old_end =
+        (uint64) _start_ptr + (_total_size & ~(block_alignment - 1));
+    const uint64 new_end =
+        (uint64) _start_ptr + (new_size & ~(block_alignment - 1));
+    _total_size = new_size;
+    if (new_end == old_end) return;
+
+    uint32 block = create_block(old_end, new_end - old_end, _last_block);
+    if (_last_block != invalid_index)
+        _blocks[_last_block].next_physical = block;
+    _last_block = block;
+
+    const auto previous = _blocks[block].prev_physical;
+    if (previous != invalid_index && _blocks[previous].is_free) {
+        remove_free_block(previous);
+        block = merge(previous, block);
+    }
+    insert_free_block(block);
 }
 
 bool GPUFreeListAllocator::allocated(const void* ptr, const uint64 size) {
-    // Get iterator to the closest allocated address <= to ptr
-    auto it = _allocated.upper_bound((uint64) ptr);
-    it--;
-
-    // Check if ptr points to an address before the first allocated address
-    if (it == _allocated.end()) return false;
-    // if this iterator envelops the whole requested region we are good
-    return it->first + it->second.block_size >= (uint64) ptr + size;
-}
-
-// /////////////////////////////////// //
-// FREE LIST ALLOCATOR PRIVATE METHODS //
-// /////////////////////////////////// //
-
-void GPUFreeListAllocator::find(
-    const uint64 size,
-    const uint64 alignment,
-    uint64&      padding,
-    Node&        previous_node,
-    Node&        found_node
-) {
-    switch (_placement_policy) {
-    case FindFirst:
-        find_first(size, alignment, padding, previous_node, found_node);
-        break;
-    case FindBest:
-        find_best(size, alignment, padding, previous_node, found_node);
-        break;
+    const uint64 offset = (uint64) ptr;
+
+    // Segments are usually referenced from their beginning
+    uint32 block = find_allocation(offset);
+
+    // Otherwise find the block containing this offset
+    if (block == invalid_index) {
+        for (block = _last_block; block != invalid_index;
+             block = _blocks[block].prev_physical)
+            if (_blocks[block].offset <= offset) break;
+        if (block == invalid_index || _blocks[block].is_free) return false;
     }
+
+    // if this block envelops the whole requested region we are good
+    return _blocks[block].offset + _blocks[block].size >= offset + size;
 }
 
-void GPUFreeListAllocator::find_first(
-    const uint64 size,
-    const uint64 alignment,
-    uint64&      padding,
-    Node&        previous_node,
-    Node&        found_node
+// /////////////////////////////////////// //
+// GPU FREE LIST ALLOCATOR PRIVATE METHODS //
+// /////////////////////////////////////// //
+
+// -----------------------------------------------------------------------------
+// Block pool
+// -----------------------------------------------------------------------------
+
+uint32 GPUFreeListAllocator::create_block(
+    const uint64 offset, const uint64 size, const uint32 prev_physical
 ) {
-    // Iterate list and return the first free block with a size >= than given
-    // size
-    previous_node = _free_list.before_begin();
-    for (found_node = _free_list.begin(); found_node != _free_list.end();
-         found_node++) {
-        padding = calculate_padding(found_node->offset, alignment);
-        const auto required_space = size + padding;
-        if (found_node->block_size >= required_space) return;
-        previous_node = found_node;
+    if (_unused_head == invalid_index) grow_block_pool();
+
+    const uint32 block = _unused_head;
+    _unused_head       = _blocks[block].next_free;
+
+    _blocks[block] = { offset,        size,          prev_physical,
+                       invalid_index, invalid_index, invalid_index,
+                       true };
+    return block;
+}
+
+void GPUFreeListAllocator::destroy_block(const uint32 block) {
+    _blocks[block].next_free = _unused_head;
+    _unused_head             = block;
+}
+
+void GPUFreeListAllocator::grow_block_pool() {
+    // Blocks are referenced by index, so they can be freely moved
+    const uint32 new_capacity = 2 * _block_capacity;
+    Block* const new_blocks   = new Block[new_capacity];
+    memcpy(new_blocks, _blocks, _block_capacity * sizeof(Block));
+    delete[] _blocks;
+
+    for (uint32 i = _block_capacity; i < new_capacity; i++)
+        new_blocks[i].next_free = i + 1;
+    new_blocks[new_capacity - 1].next_free = _unused_head;
+    _unused_head                           = _block_capacity;
+
+    _blocks         = new_blocks;
+    _block_capacity = new_capacity;
+}
+
+// -----------------------------------------------------------------------------
+// Segregated lists
+// -----------------------------------------------------------------------------
+
+void GPUFreeListAllocator::mapping_insert(
+    const uint64 size, uint32& fl, uint32& sl
+) const {
+    if (size < small_block_size) {
+        fl = 0;
+        sl = size / (small_block_size / sl_index_count);
+        return;
     }
+    const uint32 msb = 63 - __builtin_clzll(size);
+    sl = (size >> (msb - sl_index_log2)) ^ sl_index_count;
+    fl = msb - fl_index_shift + 1;
 }
 
-void GPUFreeListAllocator::find_best(
-    const uint64 size,
-    const uint64 alignment,
-    uint64&      padding,
-    Node&        previous_node,
-    Node&        found_node
-) {
-    return;
-    // TODO: IMPLEMENT
-    // // Iterate WHOLE list keeping a pointer to the best fit
-    // uint64 smallest_diff = uint64_max;
-    // Node*  best_block    = nullptr;
-
-    // Node *it = _free_list.head, *it_prev = nullptr;
-    // while (it != nullptr) {
-    //     padding = calculate_padding_with_header(
-    //         (uint64) it, alignment, sizeof(AllocationHeader)
-    //     );
-    //     const uint64 required_space = size + padding;
-    //     if (it->data.block_size >= required_space &&
-    //         (it->data.block_size - required_space < smallest_diff)) {
-    //         best_block = it;
-    //     }
-    //     it_prev = it;
-    //     it      = it->next;
-    // }
-    // previous_node = it_prev;
-    // found_node    = best_block;
-}
-
-void GPUFreeListAllocator::coalescence(Node previous_node, Node free_node) {
-    Node next_node = std::next(free_node);
-    if (next_node != _free_list.end() &&
-        free_node->offset + free_node->block_size == next_node->offset) {
-        free_node->block_size += next_node->block_size;
-        _free_list.erase_after(free_node);
+void GPUFreeListAllocator::mapping_search(
+    const uint64 size, uint32& fl, uint32& sl
+) const {
+    // Round up to the next sub-class, so that any block found there fits
+    uint64 rounded_size = size;
+    if (size >= small_block_size) {
+        const uint32 msb = 63 - __builtin_clzll(size);
+        rounded_size += ((uint64) 1 << (msb - sl_index_log2)) - 1;
     }
-    if (previous_node != _free_list.before_begin() &&
-        previous_node->offset + previous_node->block_size ==
-            free_node->offset) {
-        previous_node->block_size += free_node->block_size;
-        _free_list.erase_after(previous_node);
+    mapping_insert(rounded_size, fl, sl);
+}
+
+uint32 GPUFreeListAllocator::find_suitable(uint32& fl, uint32& sl) const {
+    // Search given first level list for a large enough second level list
+    uint32 sl_map = _sl_bitmap[fl] & (~0U << sl);
+    if (sl_map == 0) {
+        // Search for any larger first level list
+        const uint64 fl_map =
+            (fl + 1 < 64) ? _fl_bitmap & (~(uint64) 0 << (fl + 1)) : 0;
+        if (fl_map == 0) return invalid_index;
+
+        fl     = __builtin_ctzll(fl_map);
+        sl_map = _sl_bitmap[fl];
     }
+    sl = __builtin_ctz(sl_map);
+    return _heads[fl][sl];
+}
+
+void GPUFreeListAllocator::insert_free_block(const uint32 block) {
+    uint32 fl, sl;
+    mapping_insert(_blocks[block].size, fl, sl);
+
+    auto& head               = _heads[fl][sl];
+    _blocks[block].next_free = head;
+    _blocks[block].prev_free = invalid_index;
+    if (head != invalid_index) _blocks[head].prev_free = block;
+    head = block;
+
+    _fl_bitmap |= (uint64) 1 << fl;
+    _sl_bitmap[fl] |= 1U << sl;
+}
+
+void GPUFreeListAllocator::remove_free_block(const uint32 block) {
+    uint32 fl, sl;
+    mapping_insert(_blocks[block].size, fl, sl);
+
+    const auto next     = _blocks[block].next_free;
+    const auto previous = _blocks[block].prev_free;
+    if (next != invalid_index) _blocks[next].prev_free = previous;
+    if (previous != invalid_index) _blocks[previous].next_free = next;
+    else {
+        // Block was the head of its list
+        auto& head = _heads[fl][sl];
+        head       = next;
+        if (head == invalid_index) {
+            _sl_bitmap[fl] &= ~(1U << sl);
+            if (_sl_bitmap[fl] == 0) _fl_bitmap &= ~((uint64) 1 << fl);
+        }
+    }
+}
+
+uint32 GPUFreeListAllocator::split(const uint32 block, const uint64 size) {
+    // Right part keeps the state of the original block. Creation may move
+    // the block pool, so blocks are only accessed after it
+    const uint32 remainder = create_block(
+        _blocks[block].offset + size,
+        _blocks[block].size - size,
+        block
+    );
+    _blocks[remainder].is_free       = _blocks[block].is_free;
+    _blocks[remainder].next_physical = _blocks[block].next_physical;
+
+    const auto next = _blocks[remainder].next_physical;
+    if (next != invalid_index) _blocks[next].prev_physical = remainder;
+
+    _blocks[block].size          = size;
+    _blocks[block].next_physical = remainder;
+    if (block == _last_block) _last_block = remainder;
+    return remainder;
+}
+
+uint32 GPUFreeListAllocator::merge(const uint32 left, const uint32 right) {
+    _blocks[left].size += _blocks[right].size;
+    _blocks[left].next_physical = _blocks[right].next_physical;
+    if (right == _last_block) _last_block = left;
+
+    const auto next = _blocks[left].next_physical;
+    if (next != invalid_index) _blocks[next].prev_physical = left;
+
+    destroy_block(right);
+    return left;
+}
+
+// -----------------------------------------------------------------------------
+// Allocation table
+// -----------------------------------------------------------------------------
+
+#define ALLOCATION_HASH(offset)                                                \
+    (uint32) (((offset) * 0x9E3779B97F4A7C15ULL) >> 32)
+
+uint32 GPUFreeListAllocator::find_allocation(const uint64 offset) const {
+    for (uint32 i = ALLOCATION_HASH(offset) & _allocation_mask;;
+         i        = (i + 1) & _allocation_mask) {
+        if (_allocations[i].block == invalid_index) return invalid_index;
+        if (_allocations[i].offset == offset) return _allocations[i].block;
+    }
+}
+
+void GPUFreeListAllocator::insert_allocation(
+    const uint64 offset, const uint32 block
+) {
+    // Keep load factor at most one half
+    if (2 * (_allocation_count + 1) > _allocation_mask + 1)
+        rehash_allocations(2 * (_allocation_mask + 1));
+
+    uint32 i = ALLOCATION_HASH(offset) & _allocation_mask;
+    while (_allocations[i].block != invalid_index)
+        i = (i + 1) & _allocation_mask;
+    _allocations[i] = { offset, block };
+    _allocation_count++;
+}
+
+void GPUFreeListAllocator::remove_allocation(const uint64 offset) {
+    uint32 i = ALLOCATION_HASH(offset) & _allocation_mask;
+    while (_allocations[i].offset != offset)
+        i = (i + 1) & _allocation_mask;
+
+    // Shift following entries back, so no probe sequence gets broken
+    for (uint32 j = (i + 1) & _allocation_mask;
+         _allocations[j].block != invalid_index;
+         j = (j + 1) & _allocation_mask) {
+        const uint32 home =
+            ALLOCATION_HASH(_allocations[j].offset) & _allocation_mask;
+        // Entry can move to i only if i lies on its probe path [home, j)
+        if (((j - home) & _allocation_mask) >= ((j - i) & _allocation_mask)) {
+            _allocations[i] = _allocations[j];
+            i               = j;
+        }
+    }
+    _allocations[i].block = invalid_index;
+    _allocation_count--;
+}
+
+void GPUFreeListAllocator::rehash_allocations(const uint32 table_size) {
+    AllocationEntry* const old_allocations = _allocations;
+    const uint32           old_size        = _allocation_mask + 1;
+
+    _allocations     = new AllocationEntry[table_size];
+    _allocation_mask = table_size - 1;
+    for (uint32 i = 0; i < table_size; i++)
+        _allocations[i].block = invalid_index;
+    if (old_allocations == nullptr) return;
+
+    _allocation_count = 0;
+    for (uint32 i = 0; i < old_size; i++)
+        if (old_allocations[i].block != invalid_index)
+            insert_allocation(
+                old_allocations[i].offset, old_allocations[i].block
+            );
+    delete[] old_allocations;
 }
 
 } // namespace ENGINE_NAMESPACE
\ No newline at end of file
@@ -23,15 +23,15 @@ void* LinearAllocator::allocate(const uint64 size, const uint64 alignment) {
     if (alignment != 0 && _offset % alignment != 0)
         padding = calculate_padding(current_address, alignment);
 
-    if (_offset + padding + size > _total_size)
+    if (_offset + padding + size > _total_size &&
+        !grow(_offset + padding + size - _total_size))
         Logger::fatal(ALLOCATOR_LOG, "Linear allocator out of memory error.");
 
     _offset += padding + size; // Apply padding & Move by size
     const uint64 next_address = current_address + padding;
 
     // Debug data
-    _used = _offset;
-    _peak = std::max(_peak, _used);
+    set_used(_offset);
 
     return (void*) next_address;
 }
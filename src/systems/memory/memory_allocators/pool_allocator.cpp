@@ -36,30 +36,44 @@ void* PoolAllocator::allocate(
             "Allocation size for pool allocator must be equal to chunk size."
         );
 
-    Node* free_position = _free_list.pop();
-
-    if (free_position == nullptr)
+    if (_free_list.head == nullptr && !grow(_chunk_size))
         Logger::fatal(ALLOCATOR_LOG, "The pool allocator is full");
 
+    Node* free_position = _free_list.pop();
+
     // Debug info
-    _used += _chunk_size;
-    _peak = std::max(_peak, _used);
+    increase_used(_chunk_size);
 
     return (void*) free_position;
 }
 
 void PoolAllocator::free(void* ptr) {
-    _used -= _chunk_size;
+    decrease_used(_chunk_size);
     _free_list.push((Node*) ptr);
 }
 
 void PoolAllocator::reset() {
-    _used = 0;
-    _peak = 0;
+    _used           = 0;
+    _peak           = 0;
+    _free_list.head = nullptr;
 
     // Create a linked-list with all free positions
-    const int chunk_count = _total_size / _chunk_size;
-    for (int i = 0; i < chunk_count; ++i) {
+    push_chunks(0, _total_size / _chunk_size);
+}
+
+uint64 PoolAllocator::allocation_size(void* ptr) { return _chunk_size; }
+
+// ////////////////////////////// //
+// POOL ALLOCATOR PRIVATE METHODS //
+// ////////////////////////////// //
+
+void PoolAllocator::on_grow(const uint64 old_size) {
+    // Partial chunk at the old end (if any) becomes whole only now
+    push_chunks(old_size / _chunk_size, _total_size / _chunk_size);
+}
+
+void PoolAllocator::push_chunks(const uint64 first, const uint64 last) {
+    for (uint64 i = first; i < last; ++i) {
         uint64 address = (uint64) _start_ptr + i * _chunk_size;
         _free_list.push((Node*) address);
     }
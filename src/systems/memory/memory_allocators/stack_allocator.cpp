@@ -21,7 +21,8 @@ void* StackAllocator::allocate(const uint64 size, const uint64 alignment) {
         current_address, alignment, sizeof(AllocationHeader)
     );
 
-    if (_offset + padding + size > _total_size)
+    if (_offset + padding + size > _total_size &&
+        !grow(_offset + padding + size - _total_size))
         Logger::fatal(ALLOCATOR_LOG, "Stack allocator out of memory error.");
 
     _offset += padding;
@@ -35,8 +36,7 @@ void* StackAllocator::allocate(const uint64 size, const uint64 alignment) {
     _offset += size;
 
     // Debug variables
-    _used = _offset;
-    _peak = std::max(_peak, _used);
+    set_used(_offset);
 
     return (void*) next_address;
 }
@@ -59,7 +59,7 @@ void StackAllocator::free(void* ptr) {
     }
 
     _offset = object_offset - allocation_header->padding;
-    _used   = _offset;
+    _used.store(_offset, std::memory_order_relaxed);
 }
 
 void StackAllocator::reset() {
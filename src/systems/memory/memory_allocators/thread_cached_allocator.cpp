@@ -0,0 +1,271 @@
+#include "systems/memory/memory_allocators/thread_cached_allocator.hpp"
+
+#include "logger.hpp"
+
+#include <algorithm> // std::min
+#include <stdlib.h>  /* calloc, free */
+
+namespace ENGINE_NAMESPACE {
+
+ThreadCachedAllocator* ThreadCachedAllocator::_instances[max_instances] {};
+std::atomic<uint32>    ThreadCachedAllocator::_instance_count { 0 };
+
+// Thread local cache storage. Cache itself is allocated on first use, while the
+// guard returns it to the backing allocators once the thread exits. Both the
+// pointer and the flag are trivially destructible, so they stay usable even
+// after the guard is gone (e.g. for frees from static destructors). Thread can
+// exit while holding a lock only if a backing allocator terminated the process
+// (e.g. out of memory), in which case caches aren't flushed.
+namespace {
+struct ThreadCacheGuard {
+    bool active = false;
+    ~ThreadCacheGuard();
+};
+thread_local void*            thread_cache           = nullptr;
+thread_local bool             thread_cache_destroyed = false;
+thread_local bool             thread_holds_lock      = false;
+thread_local ThreadCacheGuard thread_cache_guard {};
+} // namespace
+
+// Constructor & Destructor
+ThreadCachedAllocator::ThreadCachedAllocator(
+    Allocator* const backing, const CachePolicy policy, const uint64 block_size
+)
+    : Allocator(backing->total_size()), _backing(backing), _policy(policy),
+      _block_size(block_size) {
+    _start_ptr      = (void*) backing->start();
+    _reserved_size  = backing->reserved_size();
+    _instance_index = _instance_count++;
+    if (_instance_index >= max_instances)
+        Logger::fatal(
+            ALLOCATOR_LOG,
+            "Too many thread cached allocators. At most ",
+            max_instances,
+            " are supported."
+        );
+    _instances[_instance_index] = this;
+    synchronize_usage();
+}
+
+// ////////////////////////////////////// //
+// THREAD CACHED ALLOCATOR PUBLIC METHODS //
+// ////////////////////////////////////// //
+
+void ThreadCachedAllocator::init() {
+    // Backing allocator is already initialized
+    synchronize_usage();
+}
+
+void* ThreadCachedAllocator::allocate(
+    const uint64 size, const uint64 alignment
+) {
+    if (_policy == CachePolicy::Disabled || alignment > cache_alignment)
+        return allocate_shared(size, alignment);
+
+    // Compute size class
+    uint32 size_class = 0;
+    if (_policy == CachePolicy::FixedSize) {
+        if (size > _block_size) return allocate_shared(size, alignment);
+    } else {
+        if (size > max_cached_size) return allocate_shared(size, alignment);
+        if (size > min_class_size)
+            size_class = 64 - __builtin_clzll(size - 1) - min_class_shift;
+    }
+
+    // Take from thread local magazine
+    const auto magazine = get_magazine(size_class);
+    if (magazine == nullptr) return allocate_shared(size, alignment);
+    if (magazine->count == 0) refill(magazine, size_class);
+    return magazine->blocks[--magazine->count];
+}
+
+void ThreadCachedAllocator::free(void* ptr) {
+    if (_policy == CachePolicy::Disabled) return free_shared(ptr);
+
+    // Compute size class. Blocks are cached by the largest class they can
+    // satisfy. Blocks allocated past the cache (with a smaller alignment) are
+    // cached only if they meet cache alignment, as any cached request may
+    // require it
+    uint32 size_class = 0;
+    if (_policy == CachePolicy::SizeClasses) {
+        if (((uint64) ptr & (cache_alignment - 1)) != 0)
+            return free_shared(ptr);
+        const auto size = _backing->allocation_size(ptr);
+        if (size < min_class_size || size >= (max_cached_size << 1))
+            return free_shared(ptr);
+        size_class = 63 - __builtin_clzll(size) - min_class_shift;
+    }
+
+    // Return to thread local magazine
+    const auto magazine = get_magazine(size_class);
+    if (magazine == nullptr) return free_shared(ptr);
+    if (magazine->count == magazine_size) flush(magazine, magazine_size / 2);
+    magazine->blocks[magazine->count++] = ptr;
+}
+
+void ThreadCachedAllocator::reset() {
+    lock();
+    _backing->reset();
+    // Invalidates all blocks cached by other threads
+    _epoch++;
+    synchronize_usage();
+    unlock();
+}
+
+bool ThreadCachedAllocator::owns(void* ptr) { return _backing->owns(ptr); }
+
+uint64 ThreadCachedAllocator::allocation_size(void* ptr) {
+    return _backing->allocation_size(ptr);
+}
+
+uint64 ThreadCachedAllocator::largest_free_block() {
+    lock();
+    const auto size = _backing->largest_free_block();
+    unlock();
+    return size;
+}
+
+void ThreadCachedAllocator::set_growth(
+    const uint64 growth_step, const uint64 size_limit
+) {
+    lock();
+    _backing->set_growth(growth_step, size_limit);
+    unlock();
+}
+
+bool ThreadCachedAllocator::compact(
+    Relocator& relocator, const uint64 max_bytes
+) {
+    lock();
+    const auto work_left = _backing->compact(relocator, max_bytes);
+    unlock();
+    return work_left;
+}
+
+bool ThreadCachedAllocator::supports_compaction() {
+    return _backing->supports_compaction();
+}
+
+void ThreadCachedAllocator::flush_thread_caches() {
+    if (thread_cache == nullptr) return;
+    const auto   cache = (ThreadCache*) thread_cache;
+    const uint32 count = std::min(_instance_count.load(), max_instances);
+    for (uint32 i = 0; i < count; i++) {
+        const auto instance = _instances[i];
+        // Blocks cached before a reset are already gone
+        if (cache->epoch[i] != instance->_epoch.load()) continue;
+        instance->flush_all(cache->magazines[i]);
+    }
+}
+
+// /////////////////////////////////////// //
+// THREAD CACHED ALLOCATOR PRIVATE METHODS //
+// /////////////////////////////////////// //
+
+ThreadCachedAllocator::ThreadCache* ThreadCachedAllocator::get_thread_cache() {
+    if (thread_cache != nullptr) return (ThreadCache*) thread_cache;
+
+    // Thread is exiting, everything goes directly to backing allocators
+    if (thread_cache_destroyed) return nullptr;
+
+    // Allocated outside of custom allocators, as they are the ones being
+    // cached
+    thread_cache              = calloc(1, sizeof(ThreadCache));
+    thread_cache_guard.active = true;
+    return (ThreadCache*) thread_cache;
+}
+
+ThreadCachedAllocator::Magazine* ThreadCachedAllocator::get_magazine(
+    const uint32 size_class
+) {
+    const auto cache = get_thread_cache();
+    if (cache == nullptr) return nullptr;
+
+    // Drop cached blocks if backing allocator was reset in the meantime
+    const auto epoch = _epoch.load(std::memory_order_relaxed);
+    if (cache->epoch[_instance_index] != epoch) {
+        for (auto& magazine : cache->magazines[_instance_index])
+            magazine.count = 0;
+        cache->epoch[_instance_index] = epoch;
+    }
+
+    return &cache->magazines[_instance_index][size_class];
+}
+
+void* ThreadCachedAllocator::allocate_shared(
+    const uint64 size, const uint64 alignment
+) {
+    lock();
+    const auto ptr = _backing->allocate(size, alignment);
+    synchronize_usage();
+    unlock();
+    return ptr;
+}
+
+void ThreadCachedAllocator::free_shared(void* const ptr) {
+    lock();
+    _backing->free(ptr);
+    synchronize_usage();
+    unlock();
+}
+
+void ThreadCachedAllocator::refill(
+    Magazine* const magazine, const uint32 size_class
+) {
+    const uint64 block_size = (_policy == CachePolicy::FixedSize)
+                                  ? _block_size
+                                  : min_class_size << size_class;
+
+    lock();
+    while (magazine->count < magazine_size / 2)
+        magazine->blocks[magazine->count++] =
+            _backing->allocate(block_size, cache_alignment);
+    synchronize_usage();
+    unlock();
+}
+
+void ThreadCachedAllocator::flush(
+    Magazine* const magazine, const uint32 count
+) {
+    lock();
+    for (uint32 i = 0; i < count; i++)
+        _backing->free(magazine->blocks[--magazine->count]);
+    synchronize_usage();
+    unlock();
+}
+
+void ThreadCachedAllocator::flush_all(Magazine* const magazines) {
+    lock();
+    for (uint32 i = 0; i < size_class_count; i++)
+        while (magazines[i].count > 0)
+            _backing->free(magazines[i].blocks[--magazines[i].count]);
+    synchronize_usage();
+    unlock();
+}
+
+void ThreadCachedAllocator::lock() {
+    _lock.lock();
+    thread_holds_lock = true;
+}
+
+void ThreadCachedAllocator::unlock() {
+    thread_holds_lock = false;
+    _lock.unlock();
+}
+
+void ThreadCachedAllocator::synchronize_usage() {
+    _total_size = _backing->total_size();
+    _peak       = _backing->peak();
+    _used.store(_backing->used(), std::memory_order_relaxed);
+}
+
+// Thread cache guard
+ThreadCacheGuard::~ThreadCacheGuard() {
+    if (thread_cache == nullptr) return;
+    if (!thread_holds_lock) ThreadCachedAllocator::flush_thread_caches();
+    free(thread_cache);
+    thread_cache           = nullptr;
+    thread_cache_destroyed = true;
+}
+
+} // namespace ENGINE_NAMESPACE
\ No newline at end of file
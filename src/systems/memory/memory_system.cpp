@@ -3,9 +3,21 @@
 #include "component/transform.hpp"
 #include "resources/material.hpp"
 #include "systems/input/control.hpp"
+#include "multithreading/job_system.hpp"
+#include "platform/platform.hpp"
 
 // TODO: Temp solution
 #include "renderer/vulkan/vulkan_texture.hpp"
+#include "renderer/vulkan/vulkan_settings.hpp"
+
+#include <algorithm> // min, max, sort
+#include <cstring>   // memcmp
+#include <nlohmann/json.hpp>
+#include <stdlib.h> /* calloc, free */
+#include <tbb/spin_mutex.h>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 namespace ENGINE_NAMESPACE {
 
@@ -22,9 +34,350 @@ static_assert(
     "representation are used to recognize custom allocation)"
 );
 
-MemorySystem::MemoryMap MemorySystem::_memory_map = {};
-Allocator**             MemorySystem::_allocator_array =
-    MemorySystem::initialize_allocator_array(MemorySystem::_memory_map);
+MemorySystem::AddressSpace MemorySystem::_address_space = {};
+MemorySystem::Budget
+    MemorySystem::_budgets[(MemoryTagType) MemoryTag::MAX_TAGS] = {};
+Allocator** MemorySystem::_allocator_array =
+    MemorySystem::initialize_allocator_array(MemorySystem::_address_space);
+
+// Tag names, as used in telemetry output
+static const char* const tag_names[] = {
+    "Unknown",
+    "Temp",
+    "Frame",
+    "Array",
+    "List",
+    "Map",
+    "Set",
+    "String",
+    "Callback",
+    "Application",
+    "Surface",
+    "System",
+    "Renderer",
+    "GPUTexture",
+    "GPUBuffer",
+    "Resource",
+    "Texture",
+    "TextureMap",
+    "MaterialInstance",
+    "Geometry",
+    "Shader",
+    "RenderView",
+    "RenderModule",
+    "Game",
+    "Control",
+    "Job",
+    "Transform",
+    "Entity",
+    "EntityNode",
+    "Scene",
+};
+static_assert(
+    sizeof(tag_names) / sizeof(tag_names[0]) ==
+        (uint64) MemoryTag::MAX_TAGS,
+    "Each memory tag must have a name."
+);
+
+#if MEMORY_TELEMETRY == 1
+// Telemetry counters. Each thread records its allocations into its own set of
+// counters. Set is written only by its thread, so recording needs no atomic
+// read-modify-write operations. All sets are linked together and summed up on
+// query. Once a thread exits its counts are moved to the retired set. Same as
+// for thread caches, guard takes care of that on thread exit.
+namespace {
+struct TagCounters {
+    std::atomic<uint64> allocation_count;
+    std::atomic<uint64> allocated_bytes;
+    std::atomic<uint64> deallocation_count;
+    std::atomic<uint64> size_histogram[MemorySystem::histogram_size];
+};
+struct TagSum {
+    uint64 allocation_count;
+    uint64 allocated_bytes;
+    uint64 deallocation_count;
+    uint64 size_histogram[MemorySystem::histogram_size];
+};
+// Per tag values computed at frame boundaries or on allocator reset
+struct TagTotals {
+    uint64 frame_start_count;
+    uint64 last_frame_count;
+    uint64 cleared_count;
+};
+struct ThreadCounters {
+    TagCounters     tags[(MemoryTagType) MemoryTag::MAX_TAGS];
+    ThreadCounters* next;
+};
+struct ThreadCountersGuard {
+    bool active = false;
+    ~ThreadCountersGuard();
+};
+
+// Accessed only under lock
+tbb::spin_mutex counters_lock {};
+ThreadCounters  retired_counters {};
+ThreadCounters* counters_list = nullptr;
+TagTotals       tag_totals[(MemoryTagType) MemoryTag::MAX_TAGS] {};
+
+thread_local ThreadCounters*     thread_counters           = nullptr;
+thread_local bool                thread_counters_destroyed = false;
+thread_local ThreadCountersGuard thread_counters_guard {};
+
+// Add to a counter written only by the calling thread
+inline void increment(std::atomic<uint64>& counter, const uint64 value) {
+    counter.store(
+        counter.load(std::memory_order_relaxed) + value,
+        std::memory_order_relaxed
+    );
+}
+
+ThreadCounters* get_thread_counters() {
+    if (thread_counters != nullptr) return thread_counters;
+
+    // Thread is exiting, its allocations are no longer recorded
+    if (thread_counters_destroyed) return nullptr;
+
+    // Allocated outside of custom allocators, as they are the ones being
+    // recorded
+    const auto counters = (ThreadCounters*) calloc(1, sizeof(ThreadCounters));
+    counters_lock.lock();
+    counters->next = counters_list;
+    counters_list  = counters;
+    counters_lock.unlock();
+
+    thread_counters              = counters;
+    thread_counters_guard.active = true;
+    return counters;
+}
+
+// Sum counters of all threads. Must be called under lock
+TagSum sum_counters(const MemoryTagType tag) {
+    TagSum sum {};
+    for (auto counters = counters_list; counters != nullptr;
+         counters      = counters->next) {
+        const auto& tag_counters = counters->tags[tag];
+        sum.allocation_count += tag_counters.allocation_count;
+        sum.allocated_bytes += tag_counters.allocated_bytes;
+        sum.deallocation_count += tag_counters.deallocation_count;
+        for (uint32 i = 0; i < MemorySystem::histogram_size; i++)
+            sum.size_histogram[i] += tag_counters.size_histogram[i];
+    }
+    const auto& retired = retired_counters.tags[tag];
+    sum.allocation_count += retired.allocation_count;
+    sum.allocated_bytes += retired.allocated_bytes;
+    sum.deallocation_count += retired.deallocation_count;
+    for (uint32 i = 0; i < MemorySystem::histogram_size; i++)
+        sum.size_histogram[i] += retired.size_histogram[i];
+    return sum;
+}
+
+ThreadCountersGuard::~ThreadCountersGuard() {
+    if (thread_counters == nullptr) return;
+
+    counters_lock.lock();
+    // Retire counts of this thread
+    for (MemoryTagType i = 0; i < (MemoryTagType) MemoryTag::MAX_TAGS; i++) {
+        auto&       retired = retired_counters.tags[i];
+        const auto& counts  = thread_counters->tags[i];
+        increment(retired.allocation_count, counts.allocation_count);
+        increment(retired.allocated_bytes, counts.allocated_bytes);
+        increment(retired.deallocation_count, counts.deallocation_count);
+        for (uint32 j = 0; j < MemorySystem::histogram_size; j++)
+            increment(retired.size_histogram[j], counts.size_histogram[j]);
+    }
+    // Unlink
+    auto link = &counters_list;
+    while (*link != thread_counters)
+        link = &(*link)->next;
+    *link = thread_counters->next;
+    counters_lock.unlock();
+
+    free(thread_counters);
+    thread_counters           = nullptr;
+    thread_counters_destroyed = true;
+}
+} // namespace
+#endif
+
+#if MEMORY_TRACKING == 1
+// Allocation tracking. Each live allocation is recorded with the frame and the
+// call stack it was made in. Records are stored with malloc, outside of custom
+// allocators, so tracking never tracks itself.
+namespace {
+constexpr uint32 callstack_depth = 16;
+
+struct AllocationRecord {
+    uint64    size;
+    MemoryTag tag;
+    uint64    frame;
+    uint32    callstack_size;
+    void*     callstack[callstack_depth];
+};
+
+template<typename T>
+struct UntrackedAllocator {
+    typedef T value_type;
+
+    UntrackedAllocator() noexcept {}
+    template<class U>
+    UntrackedAllocator(const UntrackedAllocator<U>&) noexcept {}
+    template<class U>
+    bool operator==(const UntrackedAllocator<U>&) const noexcept {
+        return true;
+    }
+    template<class U>
+    bool operator!=(const UntrackedAllocator<U>&) const noexcept {
+        return false;
+    }
+    T* allocate(const std::size_t n) const {
+        return (T*) malloc(n * sizeof(T));
+    }
+    void deallocate(T* const p, std::size_t n) const noexcept { free(p); }
+};
+
+typedef std::unordered_map<
+    void*,
+    AllocationRecord,
+    std::hash<void*>,
+    std::equal_to<void*>,
+    UntrackedAllocator<std::pair<void* const, AllocationRecord>>>
+    AllocationRecords;
+typedef std::vector<AllocationRecord, UntrackedAllocator<AllocationRecord>>
+    AllocationRecordList;
+
+// Accessed only under lock. Nothing that can deallocate may be called under
+// this lock, as deallocation takes it too
+tbb::spin_mutex     tracking_lock {};
+std::atomic<uint64> tracked_frame { 0 };
+
+// Created on first use, since other translation units can allocate during
+// their static initialization. Never destroyed, for the same reason
+AllocationRecords& allocation_records() {
+    static const auto records = new AllocationRecords();
+    return *records;
+}
+
+void track_allocation(void* const ptr, const uint64 size, const MemoryTag tag) {
+    AllocationRecord record {};
+    record.size  = size;
+    record.tag   = tag;
+    record.frame = tracked_frame.load(std::memory_order_relaxed);
+    // Memory system frames aren't skipped, as inlining makes their count vary
+    record.callstack_size =
+        Platform::capture_callstack(record.callstack, callstack_depth);
+
+    tracking_lock.lock();
+    allocation_records()[ptr] = record;
+    tracking_lock.unlock();
+}
+
+void untrack_allocation(void* const ptr) {
+    tracking_lock.lock();
+    allocation_records().erase(ptr);
+    tracking_lock.unlock();
+}
+
+// Orders records by tag first and call stack second
+bool record_order(const AllocationRecord& a, const AllocationRecord& b) {
+    if (a.tag != b.tag) return a.tag < b.tag;
+    if (a.callstack_size != b.callstack_size)
+        return a.callstack_size < b.callstack_size;
+    return memcmp(
+               a.callstack, b.callstack, a.callstack_size * sizeof(void*)
+           ) < 0;
+}
+bool same_origin(const AllocationRecord& a, const AllocationRecord& b) {
+    return !record_order(a, b) && !record_order(b, a);
+}
+} // namespace
+#endif
+
+// Eviction callbacks of all tags. Accessed only under lock, but called outside
+// of it, so that callbacks are free to (un)register other callbacks
+namespace {
+struct EvictionEntry {
+    uint64                         id;
+    MemoryTag                      tag;
+    MemorySystem::EvictionCallback callback;
+};
+
+tbb::spin_mutex            eviction_lock {};
+std::vector<EvictionEntry> eviction_callbacks {};
+uint64                     next_eviction_id = 1;
+
+// Set while the thread runs eviction callbacks
+thread_local bool thread_evicting = false;
+
+// Callbacks use their systems without synchronization (and may release GPU
+// resources), so they are called only on the main thread. Static
+// initialization runs there. Hard budgets exceeded elsewhere are marked and
+// evicted at the start of the next frame
+const std::thread::id main_thread_id = std::this_thread::get_id();
+std::atomic<bool> deferred_evictions[(MemoryTagType) MemoryTag::MAX_TAGS] {};
+} // namespace
+
+// Relocatable allocations, by address. Accessed only under lock, but their
+// callbacks are called outside of it
+namespace {
+struct RelocationEntry {
+    MemoryTag                        tag;
+    MemorySystem::RelocationCallback callback;
+};
+typedef std::unordered_map<void*, RelocationEntry> RelocationEntries;
+
+tbb::spin_mutex relocation_lock {};
+// Number of relocatable allocations per tag, so that deallocations of other
+// tags never take the lock
+std::atomic<uint64>
+    relocatable_counts[(MemoryTagType) MemoryTag::MAX_TAGS] {};
+// Whether compaction pass of the tag is in progress
+bool compaction_active[(MemoryTagType) MemoryTag::MAX_TAGS] {};
+
+// Created on first use and never destroyed, since allocations can be freed
+// during static destruction
+RelocationEntries& relocation_entries() {
+    static const auto entries = new RelocationEntries();
+    return *entries;
+}
+
+void unregister_relocatable(void* const ptr, const MemoryTag tag) {
+    relocation_lock.lock();
+    if (relocation_entries().erase(ptr) != 0)
+        relocatable_counts[(MemoryTagType) tag].fetch_sub(1);
+    relocation_lock.unlock();
+}
+
+class CompactionRelocator : public Allocator::Relocator {
+  public:
+    virtual bool can_relocate(void* const ptr) override {
+        relocation_lock.lock();
+        const bool relocatable = relocation_entries().count(ptr) != 0;
+        relocation_lock.unlock();
+        return relocatable;
+    }
+    virtual void relocated(void* const old_ptr, void* const new_ptr) override {
+        // Entry is re-keyed by the new address
+        relocation_lock.lock();
+        auto& entries = relocation_entries();
+        auto  node    = entries.extract(old_ptr);
+        node.key()    = new_ptr;
+        const auto callback = node.mapped().callback;
+        entries.insert(std::move(node));
+        relocation_lock.unlock();
+#if MEMORY_TRACKING == 1
+        tracking_lock.lock();
+        auto& records = allocation_records();
+        auto  record  = records.extract(old_ptr);
+        if (!record.empty()) {
+            record.key() = new_ptr;
+            records.insert(std::move(record));
+        }
+        tracking_lock.unlock();
+#endif
+        callback(new_ptr);
+    }
+};
+} // namespace
 
 // //////////////////////////// //
 // MEMORY SYSTEM PUBLIC METHODS //
@@ -32,7 +385,26 @@ Allocator**             MemorySystem::_allocator_array =
 
 void* MemorySystem::allocate(uint64 size, const MemoryTag tag) {
     auto allocator = _allocator_array[(MemoryTagType) tag];
+
+    // Make room if the allocation would exceed the hard budget
+    const uint64 hard_limit = _budgets[(MemoryTagType) tag].hard_limit;
+    if (hard_limit != 0 && allocator->used() + size > hard_limit &&
+        !evict(tag, hard_limit - std::min(size, hard_limit))) {
+        std::cout << MEMORY_SYS_LOG << "Memory budget of tag \""
+                  << tag_names[(MemoryTagType) tag] << "\" exceeded."
+                  << std::endl;
+        exit(EXIT_FAILURE);
+    }
+#if MEMORY_TELEMETRY == 1
+    record_allocation(tag, size);
+#endif
+#if MEMORY_TRACKING == 1
+    const auto ptr = allocator->allocate(size, MEMORY_PADDING);
+    track_allocation(ptr, size, tag);
+    return ptr;
+#else
     return allocator->allocate(size, MEMORY_PADDING);
+#endif
 }
 void MemorySystem::deallocate(void* ptr, const MemoryTag tag) {
     auto allocator = _allocator_array[(MemoryTagType) tag];
@@ -40,12 +412,151 @@ void MemorySystem::deallocate(void* ptr, const MemoryTag tag) {
         std::cout << MEMORY_SYS_LOG << "Wrong memory tag." << std::endl;
         exit(EXIT_FAILURE);
     }
+#if MEMORY_TRACKING == 1
+    // Before the free, as the address can be reused right after it
+    untrack_allocation(ptr);
+#endif
+    // Registration ends with the allocation
+    const auto& relocatable_count = relocatable_counts[(MemoryTagType) tag];
+    if (relocatable_count.load(std::memory_order_relaxed) != 0)
+        unregister_relocatable(ptr, tag);
     allocator->free(ptr);
+#if MEMORY_TELEMETRY == 1
+    record_deallocation(tag);
+#endif
 }
 
 void MemorySystem::reset_memory(const MemoryTag tag) {
     auto allocator = _allocator_array[(MemoryTagType) tag];
     allocator->reset();
+#if MEMORY_TELEMETRY == 1
+    clear_live_allocations(allocator);
+#endif
+#if MEMORY_TRACKING == 1
+    clear_tracked_allocations(allocator);
+#endif
+    clear_relocatable_allocations(allocator);
+}
+
+void MemorySystem::begin_frame(const uint32 frame_index) {
+    const auto allocator = static_cast<FrameAllocator*>(
+        _allocator_array[(MemoryTagType) MemoryTag::Frame]
+    );
+    allocator->begin_frame(frame_index);
+
+#if MEMORY_TELEMETRY == 1
+    // Only allocations of the current frame are considered live
+    clear_live_allocations(allocator);
+    record_frame();
+#endif
+#if MEMORY_TRACKING == 1
+    // Frame memory is never freed, so none of it is tracked past its frame
+    clear_tracked_allocations(allocator);
+    tracked_frame.fetch_add(1, std::memory_order_relaxed);
+#endif
+
+    // Release cached memory of tags over their soft budget, or over their
+    // hard budget if it was exceeded off the main thread
+    for (MemoryTagType i = 0; i < (MemoryTagType) MemoryTag::MAX_TAGS; i++) {
+        uint64 limit = _budgets[i].soft_limit;
+        if (deferred_evictions[i].exchange(false, std::memory_order_relaxed) &&
+            limit == 0)
+            limit = _budgets[i].hard_limit;
+        if (limit != 0 && _allocator_array[i]->used() > limit)
+            evict((MemoryTag) i, limit);
+    }
+}
+
+void MemorySystem::set_growth(
+    const MemoryTag tag, const uint64 growth_step, const uint64 size_limit
+) {
+    auto allocator = _allocator_array[(MemoryTagType) tag];
+    allocator->set_growth(growth_step, size_limit);
+}
+
+void MemorySystem::set_budget(
+    const MemoryTag tag, const uint64 soft_limit, const uint64 hard_limit
+) {
+    auto  allocator   = _allocator_array[(MemoryTagType) tag];
+    auto& budget      = _budgets[(MemoryTagType) tag];
+    budget.soft_limit = soft_limit;
+    budget.hard_limit =
+        (hard_limit != 0) ? hard_limit : allocator->reserved_size();
+}
+
+uint64 MemorySystem::add_eviction_callback(
+    const MemoryTag tag, const EvictionCallback& callback
+) {
+    eviction_lock.lock();
+    const uint64 id = next_eviction_id++;
+    eviction_callbacks.push_back({ id, tag, callback });
+    eviction_lock.unlock();
+    return id;
+}
+
+void MemorySystem::remove_eviction_callback(const uint64 callback_id) {
+    eviction_lock.lock();
+    for (auto it = eviction_callbacks.begin(); it != eviction_callbacks.end();
+         it++) {
+        if (it->id != callback_id) continue;
+        eviction_callbacks.erase(it);
+        break;
+    }
+    eviction_lock.unlock();
+}
+
+void MemorySystem::set_relocatable(
+    void* const ptr, const RelocationCallback& callback
+) {
+    const auto tag = get_owner(ptr);
+    if (tag == MemoryTag::MAX_TAGS) {
+        std::cout << MEMORY_SYS_LOG
+                  << "Only memory system allocations can be relocatable."
+                  << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    // Registration would never be used, yet would slow down every free
+    if (!_allocator_array[(MemoryTagType) tag]->supports_compaction()) {
+        std::cout << MEMORY_SYS_LOG << "Allocations of tag \""
+                  << tag_names[(MemoryTagType) tag]
+                  << "\" can't be relocatable, their allocator can't compact."
+                  << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    relocation_lock.lock();
+    auto& entries  = relocation_entries();
+    auto  inserted = entries.insert({ ptr, { tag, callback } }).second;
+    if (inserted) relocatable_counts[(MemoryTagType) tag].fetch_add(1);
+    else entries[ptr].callback = callback;
+    relocation_lock.unlock();
+}
+
+bool MemorySystem::compact(const MemoryTag tag, const float64 time_slice) {
+    const auto allocator = _allocator_array[(MemoryTagType) tag];
+    bool&      active    = compaction_active[(MemoryTagType) tag];
+
+    // Start a new pass only once free memory is fragmented enough
+    if (!active) {
+        const uint64 used_bytes    = allocator->used();
+        const uint64 free_bytes    = allocator->total_size() - used_bytes;
+        const uint64 largest_block = allocator->largest_free_block();
+        if (free_bytes == 0 || largest_block == 0 ||
+            1.0f - (float32) std::min(largest_block, free_bytes) / free_bytes <
+                compaction_threshold)
+            return true;
+    }
+
+    // Blocks cached by this thread would stop allocations behind them
+    ThreadCachedAllocator::flush_thread_caches();
+
+    CompactionRelocator relocator {};
+    const float64       end_time = Platform::get_absolute_time() + time_slice;
+    do {
+        active = allocator->compact(relocator, compaction_step);
+    } while (active && Platform::get_absolute_time() < end_time);
+
+    return !active;
 }
 
 #define convert_to_unit(u)                                                     \
@@ -80,73 +591,357 @@ void MemorySystem::print_usage(const MemoryTag tag) {
     std::cout << "========================" << std::endl;
 }
 
+void MemorySystem::report_leaks(const MemoryTag tag) {
+#if MEMORY_TRACKING == 1
+    // Copy matching records. Reporting allocates, so it can't hold the lock
+    AllocationRecordList records {};
+    tracking_lock.lock();
+    records.reserve(allocation_records().size());
+    for (const auto& entry : allocation_records())
+        if (tag == MemoryTag::MAX_TAGS || entry.second.tag == tag)
+            records.push_back(entry.second);
+    tracking_lock.unlock();
+
+    uint64 total_size = 0;
+    for (const auto& record : records)
+        total_size += record.size;
+    std::cout << MEMORY_SYS_LOG << records.size()
+              << " live allocations found (" << total_size << " bytes)."
+              << std::endl;
+
+    // Group allocations made from the same place
+    std::sort(records.begin(), records.end(), record_order);
+    for (uint64 first = 0, last = 0; first < records.size(); first = last) {
+        const auto& origin      = records[first];
+        uint64      group_size  = 0;
+        uint64      first_frame = origin.frame;
+        uint64      last_frame  = origin.frame;
+        for (last = first; last < records.size(); last++) {
+            const auto& record = records[last];
+            if (!same_origin(origin, record)) break;
+            group_size += record.size;
+            first_frame = std::min(first_frame, record.frame);
+            last_frame  = std::max(last_frame, record.frame);
+        }
+
+        const auto tag_name = tag_names[(MemoryTagType) origin.tag];
+        std::cout << MEMORY_SYS_LOG << "[" << tag_name << "] " << last - first
+                  << " allocations (" << group_size
+                  << " bytes) made during frames " << first_frame << " - "
+                  << last_frame << ", at:" << std::endl;
+        std::cout << Platform::callstack_to_string(
+            origin.callstack, origin.callstack_size
+        );
+    }
+#endif
+}
+
 MemoryTag MemorySystem::get_owner(void* p) {
-    const auto address = (uint64) p;
+    // Addresses outside of the reserved space (nullptr included) wrap around
+    // to an offset larger then its size
+    const uint64 offset = (uint64) p - _address_space.start;
+    if (offset >= _address_space.size) return MemoryTag::MAX_TAGS;
+    return _address_space.owner[offset >> AddressSpace::region_shift];
+}
+
+MemorySystem::Telemetry MemorySystem::get_telemetry(const MemoryTag tag) {
+    const auto allocator = _allocator_array[(MemoryTagType) tag];
+
+    Telemetry telemetry {};
+#if MEMORY_TELEMETRY == 1
+    counters_lock.lock();
+    const auto counters = sum_counters((MemoryTagType) tag);
+    telemetry.allocation_count = counters.allocation_count;
+    telemetry.allocated_bytes  = counters.allocated_bytes;
+    telemetry.frame_allocation_count =
+        tag_totals[(MemoryTagType) tag].last_frame_count;
+    for (uint32 i = 0; i < histogram_size; i++)
+        telemetry.size_histogram[i] = counters.size_histogram[i];
+
+    // Live allocations are counted per tag, but deallocations are attributed
+    // to the owning tag. Only the sum over all tags of an allocator is exact
+    for (MemoryTagType i = 0; i < (MemoryTagType) MemoryTag::MAX_TAGS; i++) {
+        if (_allocator_array[i] != allocator) continue;
+        const auto tag_counters = sum_counters(i);
+        telemetry.live_allocation_count += tag_counters.allocation_count -
+                                           tag_counters.deallocation_count -
+                                           tag_totals[i].cleared_count;
+    }
+    counters_lock.unlock();
+#endif
+
+    // C allocator owns no memory and isn't informed of deallocations
+    if (allocator->total_size() == 0) {
+        telemetry.live_allocation_count = 0;
+        return telemetry;
+    }
 
-    // Get tag
-    const auto tag = _memory_map.get_first_before(address);
-    if (tag == MemoryTag::MAX_TAGS) return tag;
+    telemetry.used_bytes  = allocator->used();
+    telemetry.peak_bytes  = allocator->peak();
+    telemetry.total_bytes = allocator->total_size();
 
-    // Check if tag owns this memory
-    if (!_allocator_array[(MemoryTagType) tag]->owns(p))
-        return MemoryTag::MAX_TAGS;
+    const uint64 free_bytes    = telemetry.total_bytes - telemetry.used_bytes;
+    const uint64 largest_block = allocator->largest_free_block();
+    if (free_bytes > 0 && largest_block > 0)
+        telemetry.fragmentation =
+            1.0f - (float32) std::min(largest_block, free_bytes) / free_bytes;
 
-    return tag;
+    return telemetry;
+}
+
+nlohmann::json MemorySystem::get_telemetry_json() {
+    nlohmann::json tags = nlohmann::json::object();
+    for (MemoryTagType i = 0; i < (MemoryTagType) MemoryTag::MAX_TAGS; i++) {
+        const auto telemetry = get_telemetry((MemoryTag) i);
+        tags[tag_names[i]]   = {
+            { "allocation_count", telemetry.allocation_count },
+            { "allocated_bytes", telemetry.allocated_bytes },
+            { "frame_allocation_count", telemetry.frame_allocation_count },
+            { "size_histogram", telemetry.size_histogram },
+            { "live_allocation_count", telemetry.live_allocation_count },
+            { "used_bytes", telemetry.used_bytes },
+            { "peak_bytes", telemetry.peak_bytes },
+            { "total_bytes", telemetry.total_bytes },
+            { "fragmentation", telemetry.fragmentation }
+        };
+    }
+    return { { "tags", tags } };
 }
 
 // ///////////////////////////// //
 // MEMORY SYSTEM PRIVATE METHODS //
 // ///////////////////////////// //
 
+bool MemorySystem::evict(const MemoryTag tag, const uint64 target_usage) {
+    // Memory released by callbacks can't start another eviction. The one
+    // already running keeps making room
+    if (thread_evicting) return true;
+
+    // Off the main thread, allocation proceeds and eviction waits for the
+    // next frame
+    if (std::this_thread::get_id() != main_thread_id) {
+        deferred_evictions[(MemoryTagType) tag].store(
+            true, std::memory_order_relaxed
+        );
+        return true;
+    }
+
+    // Usage is shared by all tags of an allocator, so are their callbacks
+    const auto allocator = _allocator_array[(MemoryTagType) tag];
+    std::vector<EvictionCallback> callbacks {};
+    eviction_lock.lock();
+    for (const auto& entry : eviction_callbacks)
+        if (_allocator_array[(MemoryTagType) entry.tag] == allocator)
+            callbacks.push_back(entry.callback);
+    eviction_lock.unlock();
+
+    // Call callbacks in turns, until enough is released or nothing is left
+    thread_evicting = true;
+    bool evicted    = true;
+    while (evicted && allocator->used() > target_usage) {
+        evicted = false;
+        for (const auto& callback : callbacks)
+            evicted |= callback();
+        // Released blocks may be held by thread caches
+        ThreadCachedAllocator::flush_thread_caches();
+    }
+    thread_evicting = false;
+
+    return allocator->used() <= target_usage;
+}
+
+#if MEMORY_TELEMETRY == 1
+
+void MemorySystem::record_allocation(const MemoryTag tag, const uint64 size) {
+    const auto thread_counters = get_thread_counters();
+    if (thread_counters == nullptr) return;
+    auto& counters = thread_counters->tags[(MemoryTagType) tag];
+
+    // Size bucket is the smallest power of two (>= 16) that fits given size
+    const uint32 bucket =
+        (size <= 16) ? 0
+                     : std::min<uint32>(
+                           histogram_size - 1, 60 - __builtin_clzll(size - 1)
+                       );
+
+    increment(counters.allocation_count, 1);
+    increment(counters.allocated_bytes, size);
+    increment(counters.size_histogram[bucket], 1);
+}
+
+void MemorySystem::record_deallocation(const MemoryTag tag) {
+    const auto thread_counters = get_thread_counters();
+    if (thread_counters == nullptr) return;
+    increment(thread_counters->tags[(MemoryTagType) tag].deallocation_count, 1);
+}
+
+void MemorySystem::record_frame() {
+    counters_lock.lock();
+    for (MemoryTagType i = 0; i < (MemoryTagType) MemoryTag::MAX_TAGS; i++) {
+        auto&        totals = tag_totals[i];
+        const uint64 count  = sum_counters(i).allocation_count;
+
+        totals.last_frame_count  = count - totals.frame_start_count;
+        totals.frame_start_count = count;
+    }
+    counters_lock.unlock();
+}
+
+void MemorySystem::clear_live_allocations(const Allocator* const allocator) {
+    counters_lock.lock();
+    for (MemoryTagType i = 0; i < (MemoryTagType) MemoryTag::MAX_TAGS; i++) {
+        if (_allocator_array[i] != allocator) continue;
+        const auto counters = sum_counters(i);
+        tag_totals[i].cleared_count =
+            counters.allocation_count - counters.deallocation_count;
+    }
+    counters_lock.unlock();
+}
+
+#endif
+
+#if MEMORY_TRACKING == 1
+
+void MemorySystem::clear_tracked_allocations(const Allocator* const allocator
+) {
+    tracking_lock.lock();
+    auto& records = allocation_records();
+    for (auto it = records.begin(); it != records.end();) {
+        if (_allocator_array[(MemoryTagType) it->second.tag] == allocator)
+            it = records.erase(it);
+        else it++;
+    }
+    tracking_lock.unlock();
+}
+
+#endif
+
+void MemorySystem::clear_relocatable_allocations(
+    const Allocator* const allocator
+) {
+    relocation_lock.lock();
+    auto& entries = relocation_entries();
+    for (auto it = entries.begin(); it != entries.end();) {
+        const auto tag = (MemoryTagType) it->second.tag;
+        if (_allocator_array[tag] == allocator) {
+            relocatable_counts[tag].fetch_sub(1);
+            it = entries.erase(it);
+        } else it++;
+    }
+    relocation_lock.unlock();
+}
+
 // Allocator initializations
 #define cal(name)                                                              \
     auto name = new CAllocator();                                              \
     name->init();
-#define sal(name, size)                                                        \
-    auto name = new StackAllocator(size);                                      \
-    name->init();
-#define fal(name, size)                                                        \
-    auto name = new FreeListAllocator(                                         \
-        size, FreeListAllocator::PlacementPolicy::FindFirst                    \
+// Allocators are shared between threads. Each is put behind a thread cached
+// front, which synchronizes access and caches small blocks per thread
+#define thread_cached(name, backing, policy, ...)                              \
+    auto name = new ThreadCachedAllocator(                                     \
+        backing, ThreadCachedAllocator::CachePolicy::policy, ##__VA_ARGS__     \
+    );
+
+// Each allocator starts at given size and grows by given step until it reaches
+// its size limit. Address range for the whole limit is reserved up front
+#define growable(name, size, step, limit)                                      \
+    name->init_at(address_space.reserve_region(size, limit), limit);           \
+    name->set_growth(step, limit);
+
+// Large allocators, touched all over their range, are backed by huge pages
+// to reduce TLB misses. Memory is still commited and faulted in lazily
+#if MEMORY_HUGE_PAGES == 1
+#    define huge_pages(name)                                                   \
+        Platform::VirtualMemory::use_huge_pages(                               \
+            (void*) name##_backing->start(), name##_backing->reserved_size()   \
+        );
+#else
+#    define huge_pages(name)
+#endif
+
+#define sal(name, size, step, limit)                                           \
+    auto name##_backing = new StackAllocator(size);                            \
+    growable(name##_backing, size, step, limit)                                \
+    thread_cached(name, name##_backing, Disabled)
+#define fal(name, size, step, limit)                                           \
+    auto name##_backing = new FreeListAllocator(                               \
+        size, FreeListAllocator::PlacementPolicy::SegregatedFit                \
     );                                                                         \
-    name->init();
-#define lal(name, size)                                                        \
-    auto name = new LinearAllocator(size);                                     \
-    name->init();
+    growable(name##_backing, size, step, limit)                                \
+    thread_cached(name, name##_backing, SizeClasses)
+// Frame allocator is lock free, so it isn't put behind a thread cached front
+#define frame_al(name, size, frame_count)                                      \
+    auto name = new FrameAllocator(size * frame_count, frame_count);           \
+    name->init_at(address_space.reserve_region(                                \
+        size * frame_count, size * frame_count                                 \
+    ));
+#define lal(name, size, step, limit)                                           \
+    auto name##_backing = new LinearAllocator(size);                           \
+    growable(name##_backing, size, step, limit)                                \
+    thread_cached(name, name##_backing, Disabled)
 
-#define pal(name, type, count)                                                 \
-    uint64 name##_size = get_aligned(sizeof(type), MEMORY_PADDING);            \
-    auto   name        = new PoolAllocator(count * name##_size, name##_size);  \
-    name->init();
+// Pools grow by their initial chunk count
+#define pal(name, type, count, max_count)                                      \
+    uint64 name##_size    = get_aligned(sizeof(type), MEMORY_PADDING);         \
+    auto   name##_backing = new PoolAllocator(                                 \
+        count * name##_size, name##_size                                       \
+    );                                                                         \
+    growable(                                                                  \
+        name##_backing,                                                        \
+        count * name##_size,                                                   \
+        count * name##_size,                                                   \
+        max_count * name##_size                                                \
+    )                                                                          \
+    thread_cached(name, name##_backing, FixedSize, name##_size)
 
 #define assign_allocator(tag, allocator)                                       \
     allocator_array[(MemoryTagType) MemoryTag::tag] = allocator;               \
-    memory_map[allocator->start()]                  = MemoryTag::tag
+    _budgets[(MemoryTagType) MemoryTag::tag].hard_limit =                      \
+        allocator->reserved_size();                                            \
+    address_space.set_owner(                                                   \
+        allocator->start(), allocator->reserved_size(), MemoryTag::tag         \
+    )
+// Resources cached by their systems can fill memory commited up front. Once
+// the allocator grows past it, they are evicted at frame start
+#define cache_budget(tag, allocator)                                           \
+    _budgets[(MemoryTagType) MemoryTag::tag].soft_limit =                      \
+        allocator->total_size();
 
-Allocator** MemorySystem::initialize_allocator_array(MemoryMap& memory_map) {
+Allocator** MemorySystem::initialize_allocator_array(
+    AddressSpace& address_space
+) {
     const auto allocator_array =
         new Allocator*[(MemoryTagType) MemoryTag::MAX_TAGS]();
 
+    // Reserve address space for all custom allocators
+    address_space.initialize();
+
     // Define used allocators
     cal(unknown_allocator);
-    sal(temp_allocator, MB);
-    fal(general_allocator, 128 * MB);
-    fal(gpu_data_allocator, MB);
-    fal(resource_allocator, MB);
-    fal(geom_allocator, 128 * MB);
-    lal(init_allocator, MB);
-    lal(permanent_allocator, MB);
+    sal(temp_allocator, MB, MB, 64 * MB);
+    frame_al(frame_allocator, MB, VulkanSettings::max_frames_in_flight);
+    fal(general_allocator, 128 * MB, 64 * MB, GB);
+    fal(gpu_data_allocator, MB, MB, 256 * MB);
+    fal(resource_allocator, MB, MB, 256 * MB);
+    fal(geom_allocator, 128 * MB, 128 * MB, 2 * (uint64) GB);
+    lal(init_allocator, MB, MB, 64 * MB);
+    lal(permanent_allocator, MB, MB, 64 * MB);
+
+    huge_pages(general_allocator);
+    huge_pages(geom_allocator);
 
     // Pools
-    pal(texture_pool, VulkanTexture, 1024);
-    pal(texture_map_pool, VulkanTexture::Map, 1024);
-    pal(material_pool, Material, 1024);
-    pal(control_pool, Control, 256);
-    pal(transform_pool, Transform, 256);
+    pal(texture_pool, VulkanTexture, 1024, 16 * 1024);
+    pal(texture_map_pool, VulkanTexture::Map, 1024, 16 * 1024);
+    pal(material_pool, Material, 1024, 16 * 1024);
+    pal(control_pool, Control, 256, 4 * 1024);
+    pal(transform_pool, Transform, 256, 64 * 1024);
+    pal(job_pool, JobSystem::Job, 4 * 1024, 256 * 1024);
 
     // Assign allocators
     assign_allocator(Unknown, unknown_allocator);
     assign_allocator(Temp, temp_allocator);
+    assign_allocator(Frame, frame_allocator);
 
     assign_allocator(Array, general_allocator);
     assign_allocator(List, general_allocator);
@@ -174,37 +969,88 @@ Allocator** MemorySystem::initialize_allocator_array(MemoryMap& memory_map) {
     // Game
     assign_allocator(Game, init_allocator);
     assign_allocator(Control, control_pool);
-    assign_allocator(Job, unknown_allocator);
+    assign_allocator(Job, job_pool);
     assign_allocator(Transform, transform_pool);
     assign_allocator(Entity, unknown_allocator);
     assign_allocator(EntityNode, unknown_allocator);
     assign_allocator(Scene, unknown_allocator);
 
+    // Budgets
+    cache_budget(Resource, resource_allocator);
+    cache_budget(Geometry, geom_allocator);
+    cache_budget(Texture, texture_pool);
+    cache_budget(MaterialInstance, material_pool);
+
     return allocator_array;
 }
 
 // -----------------------------------------------------------------------------
-// Memory map
+// Address space
 // -----------------------------------------------------------------------------
 
-MemoryTag MemorySystem::MemoryMap::get_first_before(const uint64 address) {
-    // Check for nullptr
-    if (address == 0) return MemoryTag::MAX_TAGS;
+void MemorySystem::AddressSpace::initialize() {
+    const uint64 total_size = max_regions * region_size;
 
-    // Check if alive
-    if (_dying) return MemoryTag::MAX_TAGS;
+    // Over reserve, so that start can be huge page aligned
+    const uint64 alignment = std::max(
+        Platform::VirtualMemory::huge_page_size(),
+        Platform::VirtualMemory::page_size()
+    );
+    const auto address =
+        Platform::VirtualMemory::reserve(total_size + alignment);
+    if (address == nullptr) {
+        std::cout << MEMORY_SYS_LOG << "Address space reservation failed."
+                  << std::endl;
+        exit(EXIT_FAILURE);
+    }
 
-    // Find adequate memory tag
-    auto it = lower_bound(address);
-    if (it == end()) it--;
-    else if (it->first != address) {
-        // This is before begin?
-        if (it == begin()) return MemoryTag::MAX_TAGS;
-        it--;
+    for (auto& tag : owner)
+        tag = MemoryTag::MAX_TAGS;
+    start = get_aligned((uint64) address, alignment);
+    size  = total_size;
+    used  = 0;
+}
+
+void* MemorySystem::AddressSpace::reserve_region(
+    const uint64 allocator_size, const uint64 reserved_size
+) {
+    if (allocator_size > reserved_size) {
+        std::cout << MEMORY_SYS_LOG << "Allocator of size " << allocator_size
+                  << " exceeds its reserved size." << std::endl;
+        exit(EXIT_FAILURE);
     }
-    const auto tag = it->second;
 
-    return tag;
+    // Chain as many regions as needed for the whole reserved size
+    const uint64 region_count =
+        (reserved_size + region_size - 1) >> region_shift;
+    if (used + region_count > max_regions) {
+        std::cout << MEMORY_SYS_LOG << "Out of memory regions." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    const auto region = (void*) (start + (used << region_shift));
+    used += region_count;
+    if (!Platform::VirtualMemory::commit(region, allocator_size)) {
+        std::cout << MEMORY_SYS_LOG << "Memory region commit failed."
+                  << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    return region;
+}
+
+void MemorySystem::AddressSpace::set_owner(
+    const uint64 address, const uint64 range_size, const MemoryTag tag
+) {
+    // Allocators without reserved memory (e.g. CAllocator) own no region
+    const uint64 offset = address - start;
+    if (offset >= size) return;
+
+    // Allocators without growth still own the region they start in
+    const uint64 first = offset >> region_shift;
+    const uint64 last  = (offset + std::max(range_size, (uint64) 1) - 1) >>
+                        region_shift;
+    for (uint64 i = first; i <= last && i < max_regions; i++)
+        owner[i] = tag;
 }
 
 } // namespace ENGINE_NAMESPACE
@@ -223,6 +1069,12 @@ void* operator new[](std::size_t size, const MemoryTag tag) {
 void operator delete(void* p) noexcept {
     const auto tag = MemorySystem::get_owner(p);
     if (tag != MemoryTag::MAX_TAGS) MemorySystem::deallocate(p, tag);
-    else free(p);
+    else {
+#if MEMORY_TRACKING == 1
+        // C allocator memory is freed here, outside of the memory system
+        untrack_allocation(p);
+#endif
+        free(p);
+    }
 }
 void operator delete[](void* p) noexcept { ::operator delete(p); }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "systems/texture_system.hpp"
 
 #include "resources/image.hpp"
+#include "multithreading/job_system.hpp"
 
 namespace ENGINE_NAMESPACE {
 
@@ -18,12 +19,20 @@ TextureSystem::TextureSystem(
 
     create_default_textures();
 
+    // Shed unused textures under memory pressure
+    _eviction_callback_id = MemorySystem::add_eviction_callback(
+        MemoryTag::Texture, [this]() { return evict_texture(); }
+    );
+
     Logger::trace(TEXTURE_SYS_LOG, "Texture system created.");
 }
 TextureSystem::~TextureSystem() {
+    MemorySystem::remove_eviction_callback(_eviction_callback_id);
     for (auto& texture : _registered_textures)
-        _renderer->destroy_texture(texture.second.handle);
+        _renderer->destroy_texture(texture.handle);
     _registered_textures.clear();
+    _texture_lookup.clear();
+    _unused_textures.clear();
     destroy_default_textures();
 
     Logger::trace(TEXTURE_SYS_LOG, "Texture system destroyed.");
@@ -44,13 +53,13 @@ Texture* TextureSystem::acquire(
 
     // If texture already exists, find it
     const auto key = name.lower_c();
-    const auto ref = _registered_textures.find(key);
+    const auto ref = find_texture(key);
 
-    if (ref != _registered_textures.end()) {
-        ref->second.reference_count++;
+    if (ref != nullptr) {
+        reference_texture(ref);
 
         Logger::trace(TEXTURE_SYS_LOG, "Texture \"", name, "\" acquired.");
-        return ref->second.handle;
+        return ref->handle;
     }
 
     // Texture wasn't found, load from asset folder
@@ -77,13 +86,12 @@ Texture* TextureSystem::acquire(
           .is_mip_mapped    = true },
         image->pixels
     );
-    texture->id = (uint64) texture;
 
     // Release resources
     _resource_system->unload(image);
 
     // Create its reference
-    _registered_textures[key] = { texture, 1, auto_release };
+    register_texture(key, texture, auto_release);
 
     Logger::trace(TEXTURE_SYS_LOG, "Texture \"", name, "\" acquired.");
     return texture;
@@ -100,13 +108,13 @@ Texture* TextureSystem::acquire_cube(
 
     // If texture already exists, find it
     const auto key = name.lower_c();
-    const auto ref = _registered_textures.find(key);
+    const auto ref = find_texture(key);
 
-    if (ref != _registered_textures.end()) {
-        ref->second.reference_count++;
+    if (ref != nullptr) {
+        reference_texture(ref);
 
         Logger::trace(TEXTURE_SYS_LOG, "Texture \"", name, "\" acquired.");
-        return ref->second.handle;
+        return ref->handle;
     }
 
     // Texture cube wasn't found, load from asset folder
@@ -118,27 +126,45 @@ Texture* TextureSystem::acquire_cube(
     uint32 texture_channel_count = -1;
     uint32 image_size            = -1;
 
-    Vector<byte> pixels {};
+    // Sides are loaded (decoded and oriented) by their own jobs
+    std::array<Image*, 6> images {};
+    JobSystem::Counter    counter {};
+    for (uint64 i = 0; i < cube_sides.size(); i++)
+        JobSystem::run(
+            [this, &name, &images, i] {
+                const auto& side = cube_sides[i];
+                auto        load_res =
+                    _resource_system->load(name + side, ResourceType::Image);
+                if (load_res.has_error()) return;
+
+                auto image = (Image*) load_res.value();
+                if (side == "_f" || side == "_b" || side == "_u")
+                    image->transpose();
+                if (side == "_r" || side == "_b") image->flip_y();
+                if (side == "_l" || side == "_b") image->flip_x();
+                images[i] = image;
+            },
+            &counter
+        );
+    JobSystem::wait(counter);
 
-    for (const auto& side : cube_sides) {
-        const auto side_name = name + side;
-
-        // Load image
-        auto load_res = _resource_system->load(side_name, ResourceType::Image);
-        if (load_res.has_error()) {
-            Logger::error(
-                TEXTURE_SYS_LOG,
-                "Texture \"",
-                side_name,
-                "\" could be loaded. Returning default texture."
-            );
-            return _default_texture;
-        }
-        auto image = (Image*) load_res.value();
-        if (side == "_f" || side == "_b" || side == "_u") image->transpose();
-        if (side == "_r" || side == "_b") image->flip_y();
-        if (side == "_l" || side == "_b") image->flip_x();
+    // Check whether all sides were loaded
+    for (uint64 i = 0; i < cube_sides.size(); i++) {
+        if (images[i] != nullptr) continue;
+        Logger::error(
+            TEXTURE_SYS_LOG,
+            "Texture \"",
+            name + cube_sides[i],
+            "\" could be loaded. Returning default texture."
+        );
+        for (const auto image : images)
+            _resource_system->unload(image);
+        return _default_texture;
+    }
+
+    Vector<byte> pixels {};
 
+    for (const auto image : images) {
         // Save / Check image data
         if (texture_width == -1) {
             // Save
@@ -176,10 +202,9 @@ Texture* TextureSystem::acquire_cube(
           .type          = Texture::Type::TCube },
         pixels.data()
     );
-    texture->id = (uint64) texture;
 
     // Create its reference
-    _registered_textures[key] = { texture, 1, auto_release };
+    register_texture(key, texture, auto_release);
 
     Logger::trace(TEXTURE_SYS_LOG, "Texture \"", name, "\" (cube) acquired.");
     return texture;
@@ -200,13 +225,12 @@ Texture* TextureSystem::create(
 
     // Create texture
     const auto texture = _renderer->create_texture(config, data);
-    texture->id        = (uint64) texture;
 
     // If texture already exists, find it
     const auto key = config.name.lower_c();
-    auto       ref = _registered_textures.find(key);
+    auto       ref = find_texture(key);
 
-    if (ref != _registered_textures.end()) {
+    if (ref != nullptr) {
         // Reference already exists
         Logger::trace(
             TEXTURE_SYS_LOG,
@@ -217,12 +241,13 @@ Texture* TextureSystem::create(
 
         // Update it
         // TODO: Proper inplace update
-        ref->second.handle = texture;
-        ref->second.reference_count++;
+        texture->id = ref->handle->id;
+        ref->handle = texture;
+        reference_texture(ref);
 
     } else
         // Create its reference
-        _registered_textures[key] = { texture, 1, auto_release };
+        register_texture(key, texture, auto_release);
 
     Logger::trace(TEXTURE_SYS_LOG, "Texture \"", config.name, "\" acquired.");
     return texture;
@@ -243,28 +268,37 @@ void TextureSystem::release(const String name) {
     }
 
     // Find requested texture
-    const auto key = name.lower_c();
-    const auto ref = _registered_textures.find(key);
+    const auto handle = _texture_lookup.find(name.lower_c());
 
     // If not found warn about improper use of this function
-    if (ref == _registered_textures.end()) {
+    if (handle == _texture_lookup.end()) {
         Logger::warning(
             TEXTURE_SYS_LOG, "Tried to release a non-existent texture: ", name
         );
         return;
     }
-    // If ref count is 0 this usually means that release is not managed by
-    // automatically
-    if (ref->second.reference_count == 0) return;
+    release_texture(handle->second);
 
-    // Reduce ref count
-    ref->second.reference_count--;
+    Logger::trace(TEXTURE_SYS_LOG, "Texture \"", name, "\" released.");
+}
+
+void TextureSystem::release(const Texture* const texture) {
+    if (texture == nullptr || texture == _default_texture ||
+        texture == _default_diffuse_texture ||
+        texture == _default_specular_texture ||
+        texture == _default_normal_texture)
+        return;
 
-    // Release resource if needed
-    if (ref->second.reference_count == 0 && ref->second.auto_release == true) {
-        _renderer->destroy_texture(ref->second.handle);
-        _registered_textures.erase(key);
+    // Handle is stale if texture was already destroyed
+    const TextureHandle handle { texture->id.value_or(0) };
+    if (!_registered_textures.contains(handle)) {
+        Logger::warning(
+            TEXTURE_SYS_LOG, "Tried to release a non-existent texture."
+        );
+        return;
     }
+    const String name = texture->name;
+    release_texture(handle);
 
     Logger::trace(TEXTURE_SYS_LOG, "Texture \"", name, "\" released.");
 }
@@ -371,6 +405,60 @@ void TextureSystem::destroy_default_textures() {
     }
 }
 
+TextureSystem::TextureRef* TextureSystem::find_texture(const String& key) {
+    const auto handle = _texture_lookup.find(key);
+    if (handle == _texture_lookup.end()) return nullptr;
+    return _registered_textures.get(handle->second);
+}
+
+void TextureSystem::register_texture(
+    const String& key, Texture* const texture, const bool auto_release
+) {
+    const auto handle =
+        _registered_textures.insert({ texture, 1, auto_release });
+    texture->id          = handle.packed();
+    _texture_lookup[key] = handle;
+}
+
+void TextureSystem::release_texture(const TextureHandle handle) {
+    const auto ref = _registered_textures.get(handle);
+
+    // If ref count is 0 this usually means that release is not managed by
+    // automatically
+    if (ref->reference_count == 0) return;
+
+    // Reduce ref count
+    ref->reference_count--;
+
+    // Cache resource until it needs to be evicted
+    if (ref->reference_count == 0 && ref->auto_release == true)
+        ref->unused_entry =
+            _unused_textures.insert(_unused_textures.end(), handle);
+}
+
+void TextureSystem::reference_texture(TextureRef* const ref) {
+    // Texture is used again, so it can't be evicted
+    if (ref->reference_count == 0 && ref->auto_release == true)
+        _unused_textures.erase(ref->unused_entry);
+    ref->reference_count++;
+}
+
+bool TextureSystem::evict_texture() {
+    if (_unused_textures.empty()) return false;
+
+    const auto handle  = _unused_textures.front();
+    const auto texture = _registered_textures.get(handle)->handle;
+    Logger::trace(
+        TEXTURE_SYS_LOG, "Texture \"", texture->name(), "\" evicted."
+    );
+
+    _unused_textures.pop_front();
+    _texture_lookup.erase(texture->name().lower_c());
+    _registered_textures.remove(handle);
+    _renderer->destroy_texture(texture);
+    return true;
+}
+
 Result<void, Texture*> TextureSystem::name_is_valid(
     const String& texture_name, Texture* const default_fallback
 ) {